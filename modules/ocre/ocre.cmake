@@ -146,6 +146,11 @@ else()
     set(WAMR_BUILD_LIB_PTHREAD 1)
 endif()
 
+# Shared memory regions are mapped into apps as WAMR shared heaps
+if(CONFIG_AKIRA_SHMEM_WASM)
+    set(WAMR_BUILD_SHARED_HEAP 1)
+endif()
+
 if(NOT DEFINED WAMR_BUILD_GLOBAL_HEAP_POOL)
     set(WAMR_BUILD_GLOBAL_HEAP_POOL 1)
 endif()
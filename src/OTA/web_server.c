@@ -73,9 +73,15 @@ LOG_MODULE_REGISTER(web_server, AKIRA_LOG_LEVEL);
 
 /* Optimized constants */
 #define HTTP_BUFFER_SIZE 768
-#define HTTP_RESPONSE_BUFFER_SIZE 1536
+#define API_RESPONSE_SIZE 512
 #undef UPLOAD_CHUNK_SIZE
 #define UPLOAD_CHUNK_SIZE 512
+#define UPLOAD_HEADER_BUFFER_SIZE 2048
+#define UPLOAD_BUFFER_SIZE 1024
+
+/* Request buffers live in an arena that is reset after every request,
+ * instead of on the 6KB server stack or in static storage. */
+#define REQUEST_ARENA_SIZE 4096
 /* Backwards compatible fallback for MAX_CONNECTIONS: if CONFIG_AKIRA_HTTP_MAX_CONNECTIONS
  * isn't defined at build time, fall back to a sane default. This prevents
  * passing an invalid backlog to listen() which can lead to odd errno values
@@ -107,6 +113,7 @@ static struct
 
 static struct web_server_callbacks callbacks = {0};
 static K_MUTEX_DEFINE(server_mutex);
+static akira_arena_t request_arena;
 
 /* Message queue - reduced size */
 #define SERVER_MSG_QUEUE_SIZE 6
@@ -341,7 +348,6 @@ static int find_multipart_boundary(const char *request_data, char *boundary, siz
 static int send_http_response(int client_fd, int status_code, const char *content_type,
                               const char *body, size_t body_len)
 {
-    char response[HTTP_RESPONSE_BUFFER_SIZE];
     int header_len;
 
     if (body_len == 0 && body)
@@ -351,25 +357,29 @@ static int send_http_response(int client_fd, int status_code, const char *conten
 
     LOG_DBG("Sending response: status=%d, len=%zu", status_code, body_len);
 
-    header_len = snprintf(response, sizeof(response),
-                          "HTTP/1.1 %d %s\r\n"
-                          "Content-Type: %s\r\n"
-                          "Content-Length: %zu\r\n"
-                          "Connection: close\r\n"
-                          "\r\n",
-                          status_code,
-                          (status_code == 200) ? "OK" : "Error",
-                          content_type,
-                          body_len);
-
-    if (header_len >= sizeof(response))
+    /* The header is only needed until it is sent */
+    akira_arena_mark_t mark = akira_arena_mark(&request_arena);
+    char *header = akira_arena_sprintf(&request_arena,
+                                       "HTTP/1.1 %d %s\r\n"
+                                       "Content-Type: %s\r\n"
+                                       "Content-Length: %zu\r\n"
+                                       "Connection: close\r\n"
+                                       "\r\n",
+                                       status_code,
+                                       (status_code == 200) ? "OK" : "Error",
+                                       content_type,
+                                       body_len);
+
+    if (!header)
     {
-        LOG_ERR("Header too large");
+        LOG_ERR("No memory for response header");
         return -1;
     }
 
     /* Send header */
-    ssize_t sent = send(client_fd, response, header_len, 0);
+    header_len = strlen(header);
+    ssize_t sent = send(client_fd, header, header_len, 0);
+    akira_arena_restore(&request_arena, mark);
     if (sent != header_len)
     {
         LOG_ERR("Header send failed: sent=%zd, errno=%d", sent, errno);
@@ -504,13 +514,21 @@ static int handle_firmware_upload(int client_fd, const char *request_headers, si
 
     /* Buffer to accumulate data until we find the multipart header end.
      * The initial_body contains the start of the multipart data. */
-    static char header_buffer[2048];
+    char *header_buffer = akira_arena_alloc(&request_arena, UPLOAD_HEADER_BUFFER_SIZE);
+    char *upload_buffer = akira_arena_alloc(&request_arena, UPLOAD_BUFFER_SIZE);
     size_t header_buffered = 0;
 
+    if (!header_buffer || !upload_buffer)
+    {
+        send_http_response(client_fd, 500, "text/plain", "Out of memory", 0);
+        return -1;
+    }
+    header_buffer[0] = '\0';
+
     /* Copy initial body data to our header buffer */
     if (initial_body_len > 0)
     {
-        size_t copy_len = MIN(initial_body_len, sizeof(header_buffer) - 1);
+        size_t copy_len = MIN(initial_body_len, UPLOAD_HEADER_BUFFER_SIZE - 1);
         memcpy(header_buffer, initial_body, copy_len);
         header_buffered = copy_len;
         header_buffer[header_buffered] = '\0';
@@ -520,10 +538,10 @@ static int handle_firmware_upload(int client_fd, const char *request_headers, si
     char *data_start = strstr(header_buffer, "\r\n\r\n");
 
     /* If not found, keep receiving until we find it */
-    while (!data_start && header_buffered < sizeof(header_buffer) - 1)
+    while (!data_start && header_buffered < UPLOAD_HEADER_BUFFER_SIZE - 1)
     {
         ssize_t received = recv(client_fd, header_buffer + header_buffered,
-                                sizeof(header_buffer) - 1 - header_buffered, 0);
+                                UPLOAD_HEADER_BUFFER_SIZE - 1 - header_buffered, 0);
         if (received <= 0)
         {
             LOG_ERR("Failed to receive multipart header (got %u bytes)", header_buffered);
@@ -590,7 +608,6 @@ static int handle_firmware_upload(int client_fd, const char *request_headers, si
     }
 
     /* Now receive and write the rest of the file */
-    static char upload_buffer[1024];
     /* total_received tracks how many body bytes we've received so far:
      * - initial_body_len was received during HTTP header parsing
      * - any extra we received while finding the multipart header end */
@@ -606,7 +623,7 @@ static int handle_firmware_upload(int client_fd, const char *request_headers, si
 
     while (total_received < content_length)
     {
-        size_t chunk_size = MIN(1024, content_length - total_received);
+        size_t chunk_size = MIN(UPLOAD_BUFFER_SIZE, content_length - total_received);
         LOG_DBG("Calling recv for %u bytes...", chunk_size);
         ssize_t received = recv(client_fd, upload_buffer, chunk_size, 0);
         LOG_DBG("recv returned: %d", received);
@@ -728,12 +745,17 @@ static int handle_firmware_upload(int client_fd, const char *request_headers, si
 /* Handle API requests */
 static int handle_api_request(int client_fd, const char *path)
 {
-    char response[512];
+    char *response = akira_arena_alloc(&request_arena, API_RESPONSE_SIZE);
+
+    if (!response)
+    {
+        return send_http_response(client_fd, 503, "text/plain", "Out of memory", 0);
+    }
 
     if (strcmp(path, "/api/ota/status") == 0)
     {
         const struct ota_progress *ota = ota_get_progress();
-        snprintf(response, sizeof(response),
+        snprintf(response, API_RESPONSE_SIZE,
                  "{\"state\":\"%s\",\"progress\":%d,\"message\":\"%s\"}",
                  ota_state_to_string(ota->state), ota->percentage, ota->status_message);
         return send_http_response(client_fd, 200, "application/json", response, 0);
@@ -756,13 +778,18 @@ static int handle_api_request(int client_fd, const char *path)
     if (strcmp(path, "/api/logs") == 0)
     {
         /* Return logs with HTML formatting for colors */
+        char *formatted_logs = akira_arena_alloc(&request_arena, LOG_BUFFER_SIZE + 512);
+        if (!formatted_logs)
+        {
+            return send_http_response(client_fd, 503, "text/plain", "Out of memory", 0);
+        }
+
         k_mutex_lock(&log_mutex, K_FOREVER);
 
         /* Format logs with color coding */
-        static char formatted_logs[LOG_BUFFER_SIZE + 512];
         char *src = log_buffer;
         char *dst = formatted_logs;
-        char *dst_end = formatted_logs + sizeof(formatted_logs) - 100;
+        char *dst_end = formatted_logs + LOG_BUFFER_SIZE + 512 - 100;
 
         while (*src && dst < dst_end)
         {
@@ -834,7 +861,7 @@ static int handle_api_request(int client_fd, const char *path)
         uint32_t mins = (uptime_ms % 3600000) / 60000;
         uint32_t secs = (uptime_ms % 60000) / 1000;
 
-        snprintf(response, sizeof(response),
+        snprintf(response, API_RESPONSE_SIZE,
                  "{\"ip\":\"%s\",\"uptime\":\"%02u:%02u:%02u\",\"mem\":\"99%% used\"}",
                  server_state.server_ip[0] ? server_state.server_ip : "0.0.0.0",
                  hours, mins, secs);
@@ -897,9 +924,29 @@ static int handle_api_request(int client_fd, const char *path)
         return send_http_response(client_fd, 200, "text/plain", "OK", 0);
     }
 
+#ifdef CONFIG_AKIRA_EVENT_TRACE
+    if (strcmp(path, "/api/trace") == 0)
+    {
+        /* Binary dump for tools/akira_trace.py */
+        size_t len = akira_trace_dump_size();
+        uint8_t *dump = akira_malloc(len);
+        if (!dump)
+        {
+            return send_http_response(client_fd, 503, "text/plain", "Out of memory", 0);
+        }
+
+        int n = akira_trace_dump(dump, len);
+        int ret = n > 0 ? send_http_response(client_fd, 200, "application/octet-stream",
+                                             (const char *)dump, n)
+                        : send_http_response(client_fd, 500, "text/plain", "Dump failed", 0);
+        akira_free(dump);
+        return ret;
+    }
+#endif
+
     if (strcmp(path, "/api/system") == 0)
     {
-        snprintf(response, sizeof(response),
+        snprintf(response, API_RESPONSE_SIZE,
                  "{\"uptime\":\"%.1f hours\",\"memory\":\"Available\",\"wifi\":\"Connected\",\"cpu\":\"ESP32\"}",
                  (double)k_uptime_get() / 3600000.0);
         return send_http_response(client_fd, 200, "application/json", response, 0);
@@ -917,7 +964,7 @@ static int handle_api_request(int client_fd, const char *path)
         }
         /* Build JSON object with apps array */
         char *p = response;
-        char *end = response + sizeof(response) - 2;
+        char *end = response + API_RESPONSE_SIZE - 2;
         p += snprintf(p, end - p, "{\"apps\":[");
         for (int i = 0; i < count && p < end; i++)
         {
@@ -946,10 +993,10 @@ static int handle_api_request(int client_fd, const char *path)
         int ret = app_manager_start(app_name);
         if (ret < 0)
         {
-            snprintf(response, sizeof(response), "{\"error\":\"Failed to start app: %d\"}", ret);
+            snprintf(response, API_RESPONSE_SIZE, "{\"error\":\"Failed to start app: %d\"}", ret);
             return send_http_response(client_fd, 500, "application/json", response, 0);
         }
-        snprintf(response, sizeof(response), "{\"status\":\"started\",\"name\":\"%s\"}", app_name);
+        snprintf(response, API_RESPONSE_SIZE, "{\"status\":\"started\",\"name\":\"%s\"}", app_name);
         return send_http_response(client_fd, 200, "application/json", response, 0);
     }
 
@@ -970,10 +1017,10 @@ static int handle_api_request(int client_fd, const char *path)
         int ret = app_manager_stop(app_name);
         if (ret < 0)
         {
-            snprintf(response, sizeof(response), "{\"error\":\"Failed to stop app: %d\"}", ret);
+            snprintf(response, API_RESPONSE_SIZE, "{\"error\":\"Failed to stop app: %d\"}", ret);
             return send_http_response(client_fd, 500, "application/json", response, 0);
         }
-        snprintf(response, sizeof(response), "{\"status\":\"stopped\",\"name\":\"%s\"}", app_name);
+        snprintf(response, API_RESPONSE_SIZE, "{\"status\":\"stopped\",\"name\":\"%s\"}", app_name);
         return send_http_response(client_fd, 200, "application/json", response, 0);
     }
 
@@ -994,10 +1041,10 @@ static int handle_api_request(int client_fd, const char *path)
         int ret = app_manager_uninstall(app_name);
         if (ret < 0)
         {
-            snprintf(response, sizeof(response), "{\"error\":\"Failed to uninstall app: %d\"}", ret);
+            snprintf(response, API_RESPONSE_SIZE, "{\"error\":\"Failed to uninstall app: %d\"}", ret);
             return send_http_response(client_fd, 500, "application/json", response, 0);
         }
-        snprintf(response, sizeof(response), "{\"status\":\"uninstalled\",\"name\":\"%s\"}", app_name);
+        snprintf(response, API_RESPONSE_SIZE, "{\"status\":\"uninstalled\",\"name\":\"%s\"}", app_name);
         return send_http_response(client_fd, 200, "application/json", response, 0);
     }
 #endif /* CONFIG_AKIRA_APP_MANAGER */
@@ -1008,10 +1055,16 @@ static int handle_api_request(int client_fd, const char *path)
 /* Main HTTP request handler */
 static int handle_http_request(int client_fd)
 {
-    char buffer[HTTP_BUFFER_SIZE];
+    char *buffer = akira_arena_alloc(&request_arena, HTTP_BUFFER_SIZE);
     char method[16], path[128];
     ssize_t received;
 
+    if (!buffer)
+    {
+        LOG_ERR("No memory for request buffer");
+        return -1;
+    }
+
     /* Set socket timeouts */
     struct timeval timeout = {.tv_sec = 10, .tv_usec = 0};
     setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
@@ -1022,7 +1075,7 @@ static int handle_http_request(int client_fd)
     setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
 
     /* Receive request with timeout */
-    received = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    received = recv(client_fd, buffer, HTTP_BUFFER_SIZE - 1, 0);
     if (received <= 0)
     {
         LOG_WRN("Request receive failed or timeout: %d", errno);
@@ -1144,10 +1197,15 @@ static int handle_http_request(int client_fd)
 
             /* Receive remaining data */
             size_t total_received = body_already_read;
-            static char app_upload_buf[512];
+            char *app_upload_buf = akira_arena_alloc(&request_arena, UPLOAD_CHUNK_SIZE);
+            if (!app_upload_buf)
+            {
+                app_manager_install_abort(session);
+                return send_http_response(client_fd, 500, "text/plain", "Out of memory", 0);
+            }
             while (total_received < content_length)
             {
-                size_t chunk_size = MIN(sizeof(app_upload_buf), content_length - total_received);
+                size_t chunk_size = MIN(UPLOAD_CHUNK_SIZE, content_length - total_received);
                 ssize_t recvd = recv(client_fd, app_upload_buf, chunk_size, 0);
                 if (recvd <= 0)
                 {
@@ -1287,6 +1345,8 @@ static int run_web_server(void)
         }
     }
 
+    akira_arena_init(&request_arena, REQUEST_ARENA_SIZE);
+
     while (server_state.state == WEB_SERVER_RUNNING)
     {
         client_len = sizeof(client_addr);
@@ -1320,8 +1380,10 @@ static int run_web_server(void)
         }
 
         close(client_fd);
+        akira_arena_reset(&request_arena);
     }
 
+    akira_arena_destroy(&request_arena);
     close(server_fd);
     return 0;
 }
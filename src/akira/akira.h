@@ -87,7 +87,9 @@ extern "C"
 #include "kernel/event.h"
 #include "kernel/process.h"
 #include "kernel/memory.h"
+#include "kernel/arena.h"
 #include "kernel/timer.h"
+#include "kernel/trace.h"
 #include "hal/hal.h"
 
     /*===========================================================================*/
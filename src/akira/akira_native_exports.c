@@ -11,6 +11,10 @@
 #include <wasm_export.h>
 #include <stddef.h>
 #include "connectivity/hid/hid_manager.h"
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+#include "ipc/shared_memory.h"
+#include "ipc/shmem_ring.h"
+#endif
 
 /* OCRE registration API */
 extern int ocre_register_native_module(const char *module_name, NativeSymbol *symbols, int symbol_count);
@@ -187,6 +191,329 @@ static int akira_hid_keyboard_release_wasm(wasm_exec_env_t exec_env, int key)
     return hid_keyboard_release((hid_key_code_t)key);
 }
 
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+/*
+ * Regions and rings an app created or opened, one entry per reference,
+ * so whatever it did not close itself is closed when it stops.
+ */
+struct wasm_ipc_ref
+{
+    wasm_module_inst_t inst;
+    int handle;
+    bool ring;
+};
+
+#define WASM_IPC_MAX_REFS (SHMEM_MAX_REGIONS * SHMEM_MAX_WASM_MAPS)
+
+static struct wasm_ipc_ref wasm_ipc_refs[WASM_IPC_MAX_REFS];
+static K_MUTEX_DEFINE(wasm_ipc_lock);
+
+/* Call with wasm_ipc_lock held; a NULL inst finds a free entry */
+static struct wasm_ipc_ref *wasm_ipc_find(wasm_module_inst_t inst, int handle, bool ring)
+{
+    for (int i = 0; i < WASM_IPC_MAX_REFS; i++)
+    {
+        struct wasm_ipc_ref *ref = &wasm_ipc_refs[i];
+        if (ref->inst == inst && (!inst || (ref->handle == handle && ref->ring == ring)))
+            return ref;
+    }
+    return NULL;
+}
+
+static void wasm_ipc_close(int handle, bool ring)
+{
+    if (ring)
+        shmem_ring_close(handle);
+    else
+        shmem_close(handle);
+}
+
+/* Record a new reference; if there is no room it is closed again */
+static int wasm_ipc_track(wasm_module_inst_t module_inst, int handle, bool ring)
+{
+    k_mutex_lock(&wasm_ipc_lock, K_FOREVER);
+    struct wasm_ipc_ref *ref = wasm_ipc_find(NULL, 0, false);
+    if (ref)
+    {
+        ref->inst = module_inst;
+        ref->handle = handle;
+        ref->ring = ring;
+    }
+    k_mutex_unlock(&wasm_ipc_lock);
+
+    if (!ref)
+    {
+        shmem_unmap_wasm(handle, module_inst);
+        wasm_ipc_close(handle, ring);
+        return -ENOMEM;
+    }
+    return handle;
+}
+
+/* Close one of the caller's own references and forget it */
+static int wasm_ipc_untrack(wasm_module_inst_t module_inst, int handle, bool ring)
+{
+    k_mutex_lock(&wasm_ipc_lock, K_FOREVER);
+    struct wasm_ipc_ref *ref = wasm_ipc_find(module_inst, handle, ring);
+    if (!ref)
+    {
+        k_mutex_unlock(&wasm_ipc_lock);
+        return -ENOENT;
+    }
+
+    /* Only the caller's own mapping goes with its handle */
+    if (shmem_is_mapped_wasm(handle, module_inst))
+        shmem_unmap_wasm(handle, module_inst);
+
+    int ret = ring ? shmem_ring_close(handle) : shmem_close(handle);
+    if (ret == 0)
+        ref->inst = NULL;
+    k_mutex_unlock(&wasm_ipc_lock);
+    return ret;
+}
+
+/**
+ * Drop every shared memory mapping and handle a stopping app still holds.
+ * Called by the runtime before the instance is torn down.
+ *
+ * @return Number of mappings and handles released
+ */
+int akira_native_release_wasm_ipc(wasm_module_inst_t module_inst)
+{
+    if (!module_inst)
+        return 0;
+
+    int released = shmem_unmap_wasm_all(module_inst);
+
+    k_mutex_lock(&wasm_ipc_lock, K_FOREVER);
+    for (int i = 0; i < WASM_IPC_MAX_REFS; i++)
+    {
+        struct wasm_ipc_ref *ref = &wasm_ipc_refs[i];
+        if (ref->inst == module_inst)
+        {
+            wasm_ipc_close(ref->handle, ref->ring);
+            ref->inst = NULL;
+            released++;
+        }
+    }
+    k_mutex_unlock(&wasm_ipc_lock);
+
+    return released;
+}
+
+static int akira_shm_create_wasm(wasm_exec_env_t exec_env, uint32_t name_ptr, int size, int perm)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || size <= 0)
+        return -EINVAL;
+    const char *name = (const char *)wasm_runtime_addr_app_to_native(module_inst, name_ptr);
+    if (!name)
+        return -EINVAL;
+    /* Round up so the region can be mapped with akira_shm_map() */
+    size_t mapped = ((size_t)size + SHMEM_WASM_PAGE_SIZE - 1) & ~(size_t)(SHMEM_WASM_PAGE_SIZE - 1);
+    int handle = shmem_create(name, mapped, (shmem_perm_t)perm);
+    if (handle < 0)
+        return handle;
+    return wasm_ipc_track(module_inst, handle, false);
+}
+
+static int akira_shm_open_wasm(wasm_exec_env_t exec_env, uint32_t name_ptr, int perm)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    const char *name = (const char *)wasm_runtime_addr_app_to_native(module_inst, name_ptr);
+    if (!name)
+        return -EINVAL;
+    int handle = shmem_open(name, (shmem_perm_t)perm);
+    if (handle < 0)
+        return handle;
+    return wasm_ipc_track(module_inst, handle, false);
+}
+
+static int akira_shm_map_wasm(wasm_exec_env_t exec_env, int handle, int perm, uint32_t addr_ptr)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    if (!wasm_runtime_validate_app_addr(module_inst, addr_ptr, sizeof(uint32_t)))
+        return -EINVAL;
+    uint32_t *addr = (uint32_t *)wasm_runtime_addr_app_to_native(module_inst, addr_ptr);
+    return shmem_map_wasm(handle, module_inst, (shmem_perm_t)perm, addr);
+}
+
+static int akira_shm_unmap_wasm(wasm_exec_env_t exec_env, int handle)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    return shmem_unmap_wasm(handle, module_inst);
+}
+
+/* Copying access; on seqlock regions reads are consistent snapshots */
+static int akira_shm_read_wasm(wasm_exec_env_t exec_env, int handle, int offset, uint32_t buf_ptr, int len)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || offset < 0 || len < 0)
+        return -EINVAL;
+    if (!wasm_runtime_validate_app_addr(module_inst, buf_ptr, (uint32_t)len))
+        return -EINVAL;
+    void *buf = wasm_runtime_addr_app_to_native(module_inst, buf_ptr);
+    return (int)shmem_read(handle, (size_t)offset, buf, (size_t)len);
+}
+
+static int akira_shm_write_wasm(wasm_exec_env_t exec_env, int handle, int offset, uint32_t data_ptr, int len)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || offset < 0 || len < 0)
+        return -EINVAL;
+    if (!wasm_runtime_validate_app_addr(module_inst, data_ptr, (uint32_t)len))
+        return -EINVAL;
+    const void *data = wasm_runtime_addr_app_to_native(module_inst, data_ptr);
+    return (int)shmem_write(handle, (size_t)offset, data, (size_t)len);
+}
+
+static int akira_shm_close_wasm(wasm_exec_env_t exec_env, int handle)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    return wasm_ipc_untrack(module_inst, handle, false);
+}
+
+/* Ring batches are exchanged with apps as { records, count, index } */
+static uint32_t *ring_batch_from_wasm(wasm_module_inst_t module_inst, uint32_t batch_ptr)
+{
+    if (!wasm_runtime_validate_app_addr(module_inst, batch_ptr, 3 * sizeof(uint32_t)))
+        return NULL;
+    return (uint32_t *)wasm_runtime_addr_app_to_native(module_inst, batch_ptr);
+}
+
+static int akira_ring_attach_wasm(wasm_module_inst_t module_inst, int ring, int perm)
+{
+    uint32_t addr;
+    int ret = shmem_map_wasm(ring, module_inst, (shmem_perm_t)perm, &addr);
+    if (ret < 0)
+    {
+        shmem_ring_close(ring);
+        return ret;
+    }
+    return wasm_ipc_track(module_inst, ring, true);
+}
+
+static int akira_ring_create_wasm(wasm_exec_env_t exec_env, uint32_t name_ptr, int record_size,
+                                  int capacity, int mode)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || record_size <= 0 || capacity <= 0)
+        return -EINVAL;
+    const char *name = (const char *)wasm_runtime_addr_app_to_native(module_inst, name_ptr);
+    if (!name)
+        return -EINVAL;
+    int ring = shmem_ring_create(name, (size_t)record_size, (uint32_t)capacity,
+                                 (shmem_ring_mode_t)mode, SHMEM_PERM_RW);
+    if (ring < 0)
+        return ring;
+    return akira_ring_attach_wasm(module_inst, ring, SHMEM_PERM_RW);
+}
+
+static int akira_ring_open_wasm(wasm_exec_env_t exec_env, uint32_t name_ptr, int perm)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    const char *name = (const char *)wasm_runtime_addr_app_to_native(module_inst, name_ptr);
+    if (!name)
+        return -EINVAL;
+    int ring = shmem_ring_open(name, (shmem_perm_t)perm);
+    if (ring < 0)
+        return ring;
+    return akira_ring_attach_wasm(module_inst, ring, perm);
+}
+
+static int akira_ring_reserve_wasm(wasm_exec_env_t exec_env, int ring, int max, uint32_t batch_ptr)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || max <= 0)
+        return -EINVAL;
+    int ret = shmem_check_wasm_access(ring, module_inst, SHMEM_PERM_WRITE);
+    if (ret < 0)
+        return ret;
+    uint32_t *out = ring_batch_from_wasm(module_inst, batch_ptr);
+    if (!out)
+        return -EINVAL;
+    struct shmem_ring_batch batch;
+    int n = shmem_ring_reserve(ring, (uint32_t)max, &batch);
+    if (n < 0)
+        return n;
+    out[0] = shmem_ring_batch_app_addr(module_inst, &batch);
+    out[1] = batch.count;
+    out[2] = batch.index;
+    return n;
+}
+
+static int akira_ring_commit_wasm(wasm_exec_env_t exec_env, int ring, uint32_t batch_ptr)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    int ret = shmem_check_wasm_access(ring, module_inst, SHMEM_PERM_WRITE);
+    if (ret < 0)
+        return ret;
+    uint32_t *in = ring_batch_from_wasm(module_inst, batch_ptr);
+    struct shmem_ring_batch batch;
+    if (!in || shmem_ring_batch_from_app(ring, in[1], in[2], &batch) < 0)
+        return -EINVAL;
+    return shmem_ring_commit(ring, &batch);
+}
+
+static int akira_ring_peek_wasm(wasm_exec_env_t exec_env, int ring, int max, uint32_t batch_ptr,
+                                int timeout_ms)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst || max <= 0)
+        return -EINVAL;
+    int ret = shmem_check_wasm_access(ring, module_inst, SHMEM_PERM_READ);
+    if (ret < 0)
+        return ret;
+    uint32_t *out = ring_batch_from_wasm(module_inst, batch_ptr);
+    if (!out)
+        return -EINVAL;
+    struct shmem_ring_batch batch;
+    int n = shmem_ring_peek(ring, (uint32_t)max, &batch,
+                            timeout_ms < 0 ? K_FOREVER : K_MSEC(timeout_ms));
+    if (n < 0)
+        return n;
+    out[0] = shmem_ring_batch_app_addr(module_inst, &batch);
+    out[1] = batch.count;
+    out[2] = batch.index;
+    return n;
+}
+
+static int akira_ring_release_wasm(wasm_exec_env_t exec_env, int ring, uint32_t batch_ptr)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    int ret = shmem_check_wasm_access(ring, module_inst, SHMEM_PERM_READ);
+    if (ret < 0)
+        return ret;
+    uint32_t *in = ring_batch_from_wasm(module_inst, batch_ptr);
+    struct shmem_ring_batch batch;
+    if (!in || shmem_ring_batch_from_app(ring, in[1], in[2], &batch) < 0)
+        return -EINVAL;
+    return shmem_ring_release(ring, &batch);
+}
+
+static int akira_ring_close_wasm(wasm_exec_env_t exec_env, int ring)
+{
+    wasm_module_inst_t module_inst = wasm_runtime_get_module_inst(exec_env);
+    if (!module_inst)
+        return -EINVAL;
+    return wasm_ipc_untrack(module_inst, ring, true);
+}
+#endif
+
 int register_akira_native_module(void)
 {
     NativeSymbol akira_symbols[] = {
@@ -213,6 +540,25 @@ int register_akira_native_module(void)
         {"akira_hid_keyboard_press", akira_hid_keyboard_press_wasm, "(i)i", NULL},
         {"akira_hid_keyboard_release", akira_hid_keyboard_release_wasm, "(i)i", NULL},
 
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+        /* Shared memory, mapped into the app's address space */
+        {"akira_shm_create", akira_shm_create_wasm, "($ii)i", NULL},
+        {"akira_shm_open", akira_shm_open_wasm, "($i)i", NULL},
+        {"akira_shm_map", akira_shm_map_wasm, "(iii)i", NULL},
+        {"akira_shm_unmap", akira_shm_unmap_wasm, "(i)i", NULL},
+        {"akira_shm_read", akira_shm_read_wasm, "(iiii)i", NULL},
+        {"akira_shm_write", akira_shm_write_wasm, "(iiii)i", NULL},
+        {"akira_shm_close", akira_shm_close_wasm, "(i)i", NULL},
+
+        /* Lock-free record rings */
+        {"akira_ring_create", akira_ring_create_wasm, "($iii)i", NULL},
+        {"akira_ring_open", akira_ring_open_wasm, "($i)i", NULL},
+        {"akira_ring_reserve", akira_ring_reserve_wasm, "(iii)i", NULL},
+        {"akira_ring_commit", akira_ring_commit_wasm, "(ii)i", NULL},
+        {"akira_ring_peek", akira_ring_peek_wasm, "(iiii)i", NULL},
+        {"akira_ring_release", akira_ring_release_wasm, "(ii)i", NULL},
+        {"akira_ring_close", akira_ring_close_wasm, "(i)i", NULL},
+#endif
     };
 
     int count = (int)(sizeof(akira_symbols) / sizeof(akira_symbols[0]));
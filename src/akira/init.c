@@ -295,5 +295,11 @@ void akira_print_status(void)
     LOG_INF("Active processes: %d", akira_process_count());
     LOG_INF("Active timers: %d", akira_timer_count());
 
+    akira_event_stats_t ev;
+    akira_event_get_stats(&ev);
+    LOG_INF("Events: %d subscribers, %u posted, %u pending (peak %u), %u dropped",
+            ev.subscribers, ev.posted, ev.pending, ev.peak_depth, ev.overflows);
+    LOG_INF("        %u coalesced, %u rate limited", ev.coalesced, ev.rate_limited);
+
     akira_memory_dump();
 }
@@ -0,0 +1,251 @@
+/**
+ * @file arena.c
+ * @brief AkiraOS Scoped Arena Allocator Implementation
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+#include "memory.h"
+
+/*===========================================================================*/
+/* Internal Structures                                                       */
+/*===========================================================================*/
+
+struct akira_arena_chunk
+{
+    struct akira_arena_chunk *next; /* Older chunk */
+    size_t size;                    /* Usable bytes after the header */
+    size_t offset;                  /* Bytes handed out */
+    bool owned;                     /* Allocated by the arena */
+};
+
+#define CHUNK_HDR_SIZE ROUND_UP(sizeof(struct akira_arena_chunk), AKIRA_ARENA_ALIGN)
+
+/*===========================================================================*/
+/* Internal Functions                                                        */
+/*===========================================================================*/
+
+static inline uint8_t *chunk_data(struct akira_arena_chunk *chunk)
+{
+    return (uint8_t *)chunk + CHUNK_HDR_SIZE;
+}
+
+static void *chunk_take(akira_arena_t *arena, struct akira_arena_chunk *chunk,
+                        size_t size, size_t align)
+{
+    uintptr_t base = (uintptr_t)chunk_data(chunk);
+    size_t start = ROUND_UP(base + chunk->offset, align) - base;
+
+    if (start > chunk->size || size > chunk->size - start)
+    {
+        return NULL;
+    }
+
+    arena->used += start + size - chunk->offset;
+    arena->peak = MAX(arena->peak, arena->used);
+    chunk->offset = start + size;
+
+    return (void *)(base + start);
+}
+
+static struct akira_arena_chunk *chunk_push(akira_arena_t *arena, size_t size, size_t align)
+{
+    /* Oversized requests get a chunk of their own */
+    size_t need = size + align - 1;
+    size_t cap = MAX(arena->chunk_size, need);
+
+    if (need < size)
+    {
+        return NULL;
+    }
+
+    struct akira_arena_chunk *chunk = akira_malloc(CHUNK_HDR_SIZE + cap);
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->next = arena->head;
+    chunk->size = cap;
+    chunk->offset = 0;
+    chunk->owned = true;
+
+    if (arena->head)
+    {
+        arena->overflows++;
+    }
+    arena->head = chunk;
+
+    return chunk;
+}
+
+static void chunk_pop(akira_arena_t *arena)
+{
+    struct akira_arena_chunk *chunk = arena->head;
+
+    arena->head = chunk->next;
+    if (chunk->owned)
+    {
+        akira_free(chunk);
+    }
+}
+
+/*===========================================================================*/
+/* Arena API                                                                 */
+/*===========================================================================*/
+
+void akira_arena_init(akira_arena_t *arena, size_t chunk_size)
+{
+    memset(arena, 0, sizeof(*arena));
+    arena->chunk_size = chunk_size ? chunk_size : CONFIG_AKIRA_ARENA_CHUNK_SIZE;
+}
+
+int akira_arena_init_buffer(akira_arena_t *arena, void *buf, size_t size)
+{
+    uintptr_t start = ROUND_UP((uintptr_t)buf, AKIRA_ARENA_ALIGN);
+    size_t skip = start - (uintptr_t)buf;
+
+    if (!buf || size < skip + CHUNK_HDR_SIZE + AKIRA_ARENA_ALIGN)
+    {
+        return -EINVAL;
+    }
+
+    akira_arena_init(arena, size);
+
+    struct akira_arena_chunk *chunk = (struct akira_arena_chunk *)start;
+    chunk->next = NULL;
+    chunk->size = size - skip - CHUNK_HDR_SIZE;
+    chunk->offset = 0;
+    chunk->owned = false;
+    arena->head = chunk;
+
+    return 0;
+}
+
+void akira_arena_destroy(akira_arena_t *arena)
+{
+    while (arena->head)
+    {
+        chunk_pop(arena);
+    }
+    arena->used = 0;
+}
+
+void *akira_arena_alloc_aligned(akira_arena_t *arena, size_t size, size_t align)
+{
+    if (!arena || !IS_POWER_OF_TWO(align))
+    {
+        return NULL;
+    }
+
+    if (arena->head)
+    {
+        void *ptr = chunk_take(arena, arena->head, size, align);
+        if (ptr)
+        {
+            return ptr;
+        }
+    }
+
+    /* The tail of the current chunk is abandoned until the next reset */
+    struct akira_arena_chunk *chunk = chunk_push(arena, size, align);
+    return chunk ? chunk_take(arena, chunk, size, align) : NULL;
+}
+
+void *akira_arena_alloc(akira_arena_t *arena, size_t size)
+{
+    return akira_arena_alloc_aligned(arena, size, AKIRA_ARENA_ALIGN);
+}
+
+void *akira_arena_calloc(akira_arena_t *arena, size_t count, size_t size)
+{
+    if (size && count > SIZE_MAX / size)
+    {
+        return NULL;
+    }
+
+    void *ptr = akira_arena_alloc(arena, count * size);
+    if (ptr)
+    {
+        memset(ptr, 0, count * size);
+    }
+    return ptr;
+}
+
+char *akira_arena_strdup(akira_arena_t *arena, const char *str)
+{
+    size_t len = strlen(str) + 1;
+    char *copy = akira_arena_alloc_aligned(arena, len, 1);
+
+    if (copy)
+    {
+        memcpy(copy, str, len);
+    }
+    return copy;
+}
+
+char *akira_arena_sprintf(akira_arena_t *arena, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(NULL, 0, fmt, args);
+    va_end(args);
+
+    if (len < 0)
+    {
+        return NULL;
+    }
+
+    char *str = akira_arena_alloc_aligned(arena, len + 1, 1);
+    if (str)
+    {
+        va_start(args, fmt);
+        vsnprintf(str, len + 1, fmt, args);
+        va_end(args);
+    }
+    return str;
+}
+
+akira_arena_mark_t akira_arena_mark(const akira_arena_t *arena)
+{
+    akira_arena_mark_t mark = {
+        .chunk = arena->head,
+        .offset = arena->head ? arena->head->offset : 0,
+        .used = arena->used,
+    };
+
+    return mark;
+}
+
+void akira_arena_restore(akira_arena_t *arena, akira_arena_mark_t mark)
+{
+    /* Drop chunks added after the mark, but always keep the first one */
+    while (arena->head && arena->head != mark.chunk && arena->head->next)
+    {
+        chunk_pop(arena);
+    }
+
+    if (arena->head)
+    {
+        arena->head->offset = arena->head == mark.chunk ? mark.offset : 0;
+    }
+    arena->used = mark.used;
+}
+
+void akira_arena_reset(akira_arena_t *arena)
+{
+    akira_arena_mark_t start = {0};
+
+    akira_arena_restore(arena, start);
+
+    /* Don't keep a one-off oversized chunk around as the first one */
+    if (arena->head && arena->head->owned && arena->head->size > arena->chunk_size)
+    {
+        chunk_pop(arena);
+    }
+}
@@ -0,0 +1,153 @@
+/**
+ * @file arena.h
+ * @brief AkiraOS Scoped Arena Allocator
+ *
+ * Bump allocator for scratch memory with a bounded lifetime, such as
+ * everything an HTTP request needs while it is handled. Allocations are
+ * carved from a reusable chunk and released all at once with
+ * akira_arena_reset(), or back to a checkpoint taken with
+ * akira_arena_mark(). Requests that outgrow the chunk get overflow chunks
+ * from the Akira heap, which are returned on reset.
+ *
+ * An arena is not thread-safe; give each thread (or request) its own.
+ */
+
+#ifndef AKIRA_KERNEL_ARENA_H
+#define AKIRA_KERNEL_ARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/** Default chunk size when akira_arena_init() is given 0 */
+#ifndef CONFIG_AKIRA_ARENA_CHUNK_SIZE
+#define CONFIG_AKIRA_ARENA_CHUNK_SIZE 2048
+#endif
+
+/** Alignment of akira_arena_alloc() results */
+#define AKIRA_ARENA_ALIGN 8
+
+    /*===========================================================================*/
+    /* Types                                                                     */
+    /*===========================================================================*/
+
+    struct akira_arena_chunk;
+
+    /** Arena handle; treat as opaque */
+    typedef struct akira_arena
+    {
+        struct akira_arena_chunk *head; /**< Current chunk, older ones linked behind */
+        size_t chunk_size;              /**< Size of heap chunks */
+        size_t used;                    /**< Bytes handed out since the last reset */
+        size_t peak;                    /**< Highest used */
+        uint32_t overflows;             /**< Chunks added beyond the first */
+    } akira_arena_t;
+
+    /** Checkpoint returned by akira_arena_mark() */
+    typedef struct
+    {
+        struct akira_arena_chunk *chunk;
+        size_t offset;
+        size_t used;
+    } akira_arena_mark_t;
+
+    /*===========================================================================*/
+    /* Arena API                                                                 */
+    /*===========================================================================*/
+
+    /**
+     * @brief Initialize an arena backed by the heap
+     *
+     * The first chunk is allocated on first use and kept across resets.
+     *
+     * @param arena Arena to initialize
+     * @param chunk_size Chunk size in bytes (0 for CONFIG_AKIRA_ARENA_CHUNK_SIZE)
+     */
+    void akira_arena_init(akira_arena_t *arena, size_t chunk_size);
+
+    /**
+     * @brief Initialize an arena whose first chunk is a caller buffer
+     *
+     * The buffer is never freed by the arena. Overflow chunks come from
+     * the heap and are sized like the buffer.
+     *
+     * @param arena Arena to initialize
+     * @param buf Backing buffer (at least a few dozen bytes)
+     * @param size Buffer size in bytes
+     * @return 0 on success, -EINVAL if the buffer is too small
+     */
+    int akira_arena_init_buffer(akira_arena_t *arena, void *buf, size_t size);
+
+    /**
+     * @brief Release every chunk, including the first
+     * @param arena Arena to destroy
+     */
+    void akira_arena_destroy(akira_arena_t *arena);
+
+    /**
+     * @brief Allocate from an arena
+     * @param arena Arena
+     * @param size Bytes to allocate
+     * @return Pointer aligned to AKIRA_ARENA_ALIGN, or NULL if out of memory
+     */
+    void *akira_arena_alloc(akira_arena_t *arena, size_t size);
+
+    /**
+     * @brief Allocate aligned memory from an arena
+     * @param arena Arena
+     * @param size Bytes to allocate
+     * @param align Alignment (power of two)
+     * @return Aligned pointer, or NULL if out of memory
+     */
+    void *akira_arena_alloc_aligned(akira_arena_t *arena, size_t size, size_t align);
+
+    /**
+     * @brief Allocate zeroed memory from an arena
+     */
+    void *akira_arena_calloc(akira_arena_t *arena, size_t count, size_t size);
+
+    /**
+     * @brief Copy a string into an arena
+     */
+    char *akira_arena_strdup(akira_arena_t *arena, const char *str);
+
+    /**
+     * @brief Format a string into an arena
+     * @return Formatted string, or NULL if out of memory
+     */
+    char *akira_arena_sprintf(akira_arena_t *arena, const char *fmt, ...)
+        __attribute__((format(printf, 2, 3)));
+
+    /**
+     * @brief Take a checkpoint
+     *
+     * Checkpoints nest: restoring one also drops every checkpoint taken
+     * after it.
+     */
+    akira_arena_mark_t akira_arena_mark(const akira_arena_t *arena);
+
+    /**
+     * @brief Free everything allocated since a checkpoint
+     * @param arena Arena
+     * @param mark Checkpoint from akira_arena_mark()
+     */
+    void akira_arena_restore(akira_arena_t *arena, akira_arena_mark_t mark);
+
+    /**
+     * @brief Free everything, keeping the first chunk for reuse
+     */
+    void akira_arena_reset(akira_arena_t *arena);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_KERNEL_ARENA_H */
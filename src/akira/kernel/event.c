@@ -5,8 +5,11 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/dlist.h>
+#include <zephyr/sys/util.h>
 #include <string.h>
 #include "event.h"
+#include "trace.h"
 
 LOG_MODULE_REGISTER(akira_event, CONFIG_AKIRA_LOG_LEVEL);
 
@@ -14,27 +17,108 @@ LOG_MODULE_REGISTER(akira_event, CONFIG_AKIRA_LOG_LEVEL);
 /* Configuration                                                             */
 /*===========================================================================*/
 
+#ifndef CONFIG_AKIRA_EVENT_HANDLERS
+#define CONFIG_AKIRA_EVENT_HANDLERS 64
+#endif
+
 #ifndef AKIRA_MAX_EVENT_HANDLERS
-#define AKIRA_MAX_EVENT_HANDLERS 32
+#define AKIRA_MAX_EVENT_HANDLERS CONFIG_AKIRA_EVENT_HANDLERS
+#endif
+
+#ifndef CONFIG_AKIRA_EVENT_QUEUE_SIZE
+#define CONFIG_AKIRA_EVENT_QUEUE_SIZE 32
 #endif
 
 #ifndef AKIRA_EVENT_QUEUE_SIZE
-#define AKIRA_EVENT_QUEUE_SIZE 32
+#define AKIRA_EVENT_QUEUE_SIZE CONFIG_AKIRA_EVENT_QUEUE_SIZE
+#endif
+
+#define EVENT_QUEUE_MASK (AKIRA_EVENT_QUEUE_SIZE - 1)
+
+#ifndef CONFIG_AKIRA_EVENT_COALESCE_TYPES
+#define CONFIG_AKIRA_EVENT_COALESCE_TYPES 8
+#endif
+
+#ifndef CONFIG_AKIRA_EVENT_COALESCE_SLOTS
+#define CONFIG_AKIRA_EVENT_COALESCE_SLOTS 16
 #endif
 
+#ifdef CONFIG_AKIRA_EVENT_DISPATCH_THREAD
+#define DISPATCH_STACK_SIZE CONFIG_AKIRA_EVENT_DISPATCH_STACK_SIZE
+#define DISPATCH_PRIORITY CONFIG_AKIRA_EVENT_DISPATCH_PRIORITY
+#endif
+
+/* Single-type subscriptions are hashed on the type */
+#define EVENT_TYPE_BUCKETS 32
+
+/* Range subscriptions are indexed by the 100-wide category they fall in
+ * (system, service, ..., timer); everything from AKIRA_EVENT_CUSTOM up
+ * shares the last one.
+ */
+#define EVENT_CATEGORY_SIZE 100
+#define EVENT_CATEGORIES (AKIRA_EVENT_CUSTOM / EVENT_CATEGORY_SIZE + 1)
+
+BUILD_ASSERT(IS_POWER_OF_TWO(EVENT_TYPE_BUCKETS), "Type buckets must be a power of two");
+BUILD_ASSERT(IS_POWER_OF_TWO(AKIRA_EVENT_QUEUE_SIZE), "Event queue size must be a power of two");
+BUILD_ASSERT(CONFIG_AKIRA_EVENT_COALESCE_SLOTS <= INT8_MAX, "Coalesce slot index must fit in int8_t");
+
 /*===========================================================================*/
 /* Internal Structures                                                       */
 /*===========================================================================*/
 
 typedef struct
 {
+    sys_dnode_t node; /* Link in its index list, or in the free list */
     bool in_use;
+    uint32_t seq;     /* Subscription order, used to merge the lists */
     akira_event_type_t type_min;
     akira_event_type_t type_max;
     akira_event_handler_t handler;
     void *user_data;
 } event_subscription_t;
 
+/* Queue slot; seq says whose turn it is (bounded MPSC ring: a slot is
+ * free for the producer at position p when seq == p, and holds an event
+ * for the consumer at position p when seq == p + 1).
+ */
+typedef struct
+{
+    atomic_t seq;
+    int8_t coalesce; /* Coalesce slot to take the event from, or -1 */
+    akira_event_t event;
+} event_slot_t;
+
+/* Coalescing policy of one event type */
+typedef struct
+{
+    akira_event_type_t type; /* AKIRA_EVENT_NONE when unused */
+    akira_event_coalesce_t mode;
+    uint32_t interval_ms;    /* Rate limit, 0 for none */
+    akira_event_merge_t merge;
+} coalesce_policy_t;
+
+/* Pending event of one type/source. While queued, the ring holds a
+ * single reference to the slot and further posts are folded into it.
+ */
+typedef struct
+{
+    int8_t policy;     /* Index into coalesce_policies, -1 if unused */
+    bool pending;      /* event is waiting to be delivered */
+    bool queued;       /* Referenced from the ring or held by the rate limit */
+    bool deferred;     /* Held by the rate limit until next_due */
+    uint32_t source_id;
+    int64_t next_due;  /* Earliest next delivery (ms) */
+    akira_event_t event;
+} coalesce_slot_t;
+
+/* akira_event_wait() rendezvous */
+typedef struct
+{
+    akira_event_t *out;
+    atomic_t done;
+    struct k_sem sem;
+} event_waiter_t;
+
 /*===========================================================================*/
 /* Internal State                                                            */
 /*===========================================================================*/
@@ -46,66 +130,517 @@ static struct
     int subscription_count;
     akira_subscription_t next_id;
 
-    /* Event queue */
-    akira_event_t queue[AKIRA_EVENT_QUEUE_SIZE];
-    int queue_head;
-    int queue_tail;
-    int queue_count;
+    /* Subscriber index; each list is kept in subscription order */
+    sys_dlist_t by_type[EVENT_TYPE_BUCKETS];
+    sys_dlist_t by_category[EVENT_CATEGORIES];
+    sys_dlist_t wide; /* Ranges spanning several categories */
+    sys_dlist_t free_list;
+    uint32_t next_seq;
+
+    /* Handlers may unsubscribe while an event is being delivered */
+    int dispatch_depth;
+    int deferred_frees;
+
+    /* Event queue: lock-free for producers (threads and ISRs), drained
+     * by one consumer at a time under the mutex.
+     */
+    event_slot_t queue[AKIRA_EVENT_QUEUE_SIZE];
+    atomic_t queue_tail; /* Next position to reserve */
+    uint32_t queue_head; /* Next position to consume */
+    atomic_t posted;
+    atomic_t overflows;
+    uint32_t processed;
+    uint32_t peak_depth;
+
+    /* Coalescing; the lock is taken only for types with a policy */
+    coalesce_policy_t coalesce_policies[CONFIG_AKIRA_EVENT_COALESCE_TYPES];
+    coalesce_slot_t coalesce_slots[CONFIG_AKIRA_EVENT_COALESCE_SLOTS];
+    atomic_t coalesce_count;
+    struct k_spinlock coalesce_lock;
+    struct k_timer coalesce_timer;
+    atomic_t coalesced;
+    atomic_t rate_limited;
 
     struct k_mutex mutex;
-    struct k_sem queue_sem;
+    struct k_sem queue_sem; /* Consumer wakeup */
+
+#ifdef CONFIG_AKIRA_EVENT_DISPATCH_THREAD
+    struct k_thread dispatch_thread;
+#endif
 } event_sys;
 
+#ifdef CONFIG_AKIRA_EVENT_DISPATCH_THREAD
+static K_THREAD_STACK_DEFINE(dispatch_stack, DISPATCH_STACK_SIZE);
+#endif
+
 /*===========================================================================*/
 /* Internal Functions                                                        */
 /*===========================================================================*/
 
+static inline int event_category(akira_event_type_t type)
+{
+    return MIN((uint32_t)type / EVENT_CATEGORY_SIZE, EVENT_CATEGORIES - 1);
+}
+
+static sys_dlist_t *subscription_list(akira_event_type_t type_min, akira_event_type_t type_max)
+{
+    if (type_min == type_max)
+    {
+        return &event_sys.by_type[type_min & (EVENT_TYPE_BUCKETS - 1)];
+    }
+
+    int cat = event_category(type_min);
+    if (cat == event_category(type_max))
+    {
+        return &event_sys.by_category[cat];
+    }
+
+    return &event_sys.wide;
+}
+
 static event_subscription_t *find_subscription(akira_subscription_t id)
 {
+    if (id < 0 || id >= AKIRA_MAX_EVENT_HANDLERS || !event_sys.subscriptions[id].in_use)
+    {
+        return NULL;
+    }
+    return &event_sys.subscriptions[id];
+}
+
+static void release_deferred(void)
+{
+    /* Rare: only after a handler unsubscribed during delivery */
     for (int i = 0; i < AKIRA_MAX_EVENT_HANDLERS; i++)
     {
-        if (event_sys.subscriptions[i].in_use && i == id)
+        event_subscription_t *sub = &event_sys.subscriptions[i];
+        if (!sub->in_use && sys_dnode_is_linked(&sub->node) && sub->handler)
+        {
+            sys_dlist_remove(&sub->node);
+            sub->handler = NULL;
+            sys_dlist_append(&event_sys.free_list, &sub->node);
+        }
+    }
+    event_sys.deferred_frees = 0;
+}
+
+/* First live subscriber matching type, starting at node */
+static event_subscription_t *next_match(sys_dlist_t *list, sys_dnode_t *node,
+                                        akira_event_type_t type)
+{
+    for (; node; node = sys_dlist_peek_next(list, node))
+    {
+        event_subscription_t *sub = CONTAINER_OF(node, event_subscription_t, node);
+        if (sub->in_use && type >= sub->type_min && type <= sub->type_max)
         {
-            return &event_sys.subscriptions[i];
+            return sub;
         }
     }
     return NULL;
 }
 
-static int find_free_slot(void)
+/* queue_pos identifies the queue entry in the trace, ~0 for publish */
+static void deliver_event(const akira_event_t *event, uint32_t queue_pos)
 {
-    for (int i = 0; i < AKIRA_MAX_EVENT_HANDLERS; i++)
+    /* Only three lists can hold subscribers for a type; walk them merged
+     * by subscription order so propagation stops behave as before.
+     */
+    sys_dlist_t *lists[] = {
+        &event_sys.by_type[event->type & (EVENT_TYPE_BUCKETS - 1)],
+        &event_sys.by_category[event_category(event->type)],
+        &event_sys.wide,
+    };
+    event_subscription_t *cur[ARRAY_SIZE(lists)];
+
+    for (int l = 0; l < ARRAY_SIZE(lists); l++)
     {
-        if (!event_sys.subscriptions[i].in_use)
+        cur[l] = next_match(lists[l], sys_dlist_peek_head(lists[l]), event->type);
+    }
+
+    int handlers = 0;
+
+    event_sys.dispatch_depth++;
+    AKIRA_TRACE(AKIRA_TRACE_EVENT_DELIVER, event->type, event->source_id, queue_pos);
+
+    while (1)
+    {
+        int pick = -1;
+
+        for (int l = 0; l < ARRAY_SIZE(lists); l++)
         {
-            return i;
+            if (cur[l] && (pick < 0 || (int32_t)(cur[l]->seq - cur[pick]->seq) < 0))
+            {
+                pick = l;
+            }
         }
+
+        if (pick < 0)
+        {
+            break;
+        }
+
+        event_subscription_t *sub = cur[pick];
+
+        /* Skip subscribers removed by an earlier handler of this event */
+        if (sub->in_use)
+        {
+            handlers++;
+            if (sub->handler(event, sub->user_data) != 0)
+            {
+                /* Handler requested stop propagation */
+                break;
+            }
+        }
+
+        /* Advance only after the handler ran: unsubscribing defers the
+         * unlink while dispatching, so sub is still on the list
+         */
+        cur[pick] = next_match(lists[pick], sys_dlist_peek_next(lists[pick], &sub->node),
+                               event->type);
+    }
+
+    AKIRA_TRACE(AKIRA_TRACE_EVENT_DONE, event->type, event->source_id, handlers);
+
+    if (--event_sys.dispatch_depth == 0 && event_sys.deferred_frees > 0)
+    {
+        release_deferred();
     }
-    return -1;
 }
 
-static void deliver_event(const akira_event_t *event)
+static inline uint32_t queue_depth(void)
 {
-    for (int i = 0; i < AKIRA_MAX_EVENT_HANDLERS; i++)
+    return (uint32_t)atomic_get(&event_sys.queue_tail) - event_sys.queue_head;
+}
+
+/* Reserve a slot and copy the event (or a coalesce slot reference) in;
+ * safe from any context
+ */
+static int queue_push(const akira_event_t *event, int coalesce)
+{
+    uint32_t pos = (uint32_t)atomic_get(&event_sys.queue_tail);
+
+    while (1)
     {
-        event_subscription_t *sub = &event_sys.subscriptions[i];
-        if (sub->in_use &&
-            event->type >= sub->type_min &&
-            event->type <= sub->type_max)
+        event_slot_t *slot = &event_sys.queue[pos & EVENT_QUEUE_MASK];
+        int32_t diff = (int32_t)((uint32_t)atomic_get(&slot->seq) - pos);
+
+        if (diff == 0)
         {
-            if (sub->handler)
+            if (atomic_cas(&event_sys.queue_tail, (atomic_val_t)pos, (atomic_val_t)(pos + 1)))
             {
-                int ret = sub->handler(event, sub->user_data);
-                if (ret != 0)
+                slot->coalesce = coalesce;
+                if (event)
                 {
-                    /* Handler requested stop propagation */
-                    break;
+                    slot->event = *event;
                 }
+                atomic_set(&slot->seq, (atomic_val_t)(pos + 1));
+
+#ifdef CONFIG_AKIRA_EVENT_TRACE
+                const akira_event_t *ev = event ? event : &event_sys.coalesce_slots[coalesce].event;
+                AKIRA_TRACE(AKIRA_TRACE_EVENT_POST, ev->type, ev->source_id, pos);
+#endif
+                return 0;
+            }
+        }
+        else if (diff < 0)
+        {
+            /* Slot still holds an event from the previous lap: full */
+            return -ENOBUFS;
+        }
+
+        /* Another producer won the slot; retry at the new tail */
+        pos = (uint32_t)atomic_get(&event_sys.queue_tail);
+    }
+}
+
+/* Take the oldest entry; caller holds the mutex */
+static bool queue_pop(akira_event_t *event, int *coalesce)
+{
+    uint32_t pos = event_sys.queue_head;
+    event_slot_t *slot = &event_sys.queue[pos & EVENT_QUEUE_MASK];
+
+    /* Empty, or the producer of this slot has not finished copying */
+    if ((int32_t)((uint32_t)atomic_get(&slot->seq) - (pos + 1)) < 0)
+    {
+        return false;
+    }
+
+    *coalesce = slot->coalesce;
+    if (event && slot->coalesce < 0)
+    {
+        *event = slot->event;
+    }
+    atomic_set(&slot->seq, (atomic_val_t)(pos + AKIRA_EVENT_QUEUE_SIZE));
+    event_sys.queue_head = pos + 1;
+
+    return true;
+}
+
+/* Caller holds coalesce_lock */
+static int coalesce_policy_find(akira_event_type_t type)
+{
+    if (type == AKIRA_EVENT_NONE)
+    {
+        return -1;
+    }
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_TYPES; i++)
+    {
+        if (event_sys.coalesce_policies[i].type == type)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* Slot of a type/source, allocated on first use; caller holds coalesce_lock */
+static int coalesce_slot_get(int policy, uint32_t source_id)
+{
+    int64_t now = k_uptime_get();
+    int free_slot = -1;
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
+    {
+        coalesce_slot_t *slot = &event_sys.coalesce_slots[i];
+
+        if (slot->policy == policy && slot->source_id == source_id)
+        {
+            return i;
+        }
+
+        /* Idle slots are reusable once their rate limit has passed; one
+         * still holding an undelivered event never is.
+         */
+        if (free_slot < 0 &&
+            (slot->policy < 0 ||
+             (!slot->pending && !slot->queued && now >= slot->next_due)))
+        {
+            free_slot = i;
+        }
+    }
+
+    if (free_slot >= 0)
+    {
+        coalesce_slot_t *slot = &event_sys.coalesce_slots[free_slot];
+
+        slot->policy = policy;
+        slot->source_id = source_id;
+        slot->pending = false;
+        slot->queued = false;
+        slot->deferred = false;
+        slot->next_due = 0;
+    }
+
+    return free_slot;
+}
+
+static void coalesce_merge(const coalesce_policy_t *policy, akira_event_t *pending,
+                           const akira_event_t *event)
+{
+    if (policy->mode != AKIRA_EVENT_COALESCE_ACCUMULATE)
+    {
+        *pending = *event;
+    }
+    else if (policy->merge)
+    {
+        policy->merge(pending, event);
+    }
+    else
+    {
+        int32_t v0 = pending->value[0] + event->value[0];
+        int32_t v1 = pending->value[1] + event->value[1];
+
+        *pending = *event;
+        pending->value[0] = v0;
+        pending->value[1] = v1;
+    }
+}
+
+/* Arm the timer for the earliest rate-limited slot; caller holds coalesce_lock */
+static void coalesce_arm_timer(int64_t now)
+{
+    int64_t due = INT64_MAX;
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
+    {
+        if (event_sys.coalesce_slots[i].deferred)
+        {
+            due = MIN(due, event_sys.coalesce_slots[i].next_due);
+        }
+    }
+
+    if (due != INT64_MAX)
+    {
+        k_timer_start(&event_sys.coalesce_timer, K_MSEC(MAX(due - now, 1)), K_NO_WAIT);
+    }
+}
+
+static void coalesce_timer_expiry(struct k_timer *timer)
+{
+    ARG_UNUSED(timer);
+
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+    int64_t now = k_uptime_get();
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
+    {
+        coalesce_slot_t *slot = &event_sys.coalesce_slots[i];
+
+        if (slot->deferred && now >= slot->next_due)
+        {
+            slot->deferred = false;
+            if (queue_push(NULL, i) < 0)
+            {
+                /* Stays pending; queued again once the ring drains */
+                slot->queued = false;
+            }
+        }
+    }
+
+    coalesce_arm_timer(now);
+
+    k_spin_unlock(&event_sys.coalesce_lock, key);
+    k_sem_give(&event_sys.queue_sem);
+}
+
+/* Returns 1 if the event was coalesced, queued or held in its slot, 0 if
+ * it has no policy and must be queued as is, -ENOBUFS if all slots hold
+ * undelivered events.
+ */
+static int coalesce_post(const akira_event_t *event)
+{
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+
+    int policy = coalesce_policy_find(event->type);
+
+    if (policy < 0)
+    {
+        k_spin_unlock(&event_sys.coalesce_lock, key);
+        return 0;
+    }
+
+    int idx = coalesce_slot_get(policy, event->source_id);
+
+    if (idx < 0)
+    {
+        k_spin_unlock(&event_sys.coalesce_lock, key);
+        return -ENOBUFS;
+    }
+
+    coalesce_slot_t *slot = &event_sys.coalesce_slots[idx];
+
+    if (slot->pending)
+    {
+        coalesce_merge(&event_sys.coalesce_policies[policy], &slot->event, event);
+        atomic_inc(&event_sys.coalesced);
+        AKIRA_TRACE(AKIRA_TRACE_EVENT_COALESCE, event->type, event->source_id, idx);
+    }
+    else
+    {
+        slot->event = *event;
+        slot->pending = true;
+    }
+
+    bool push = !slot->queued;
+    slot->queued = true;
+
+    if (push && queue_push(NULL, idx) < 0)
+    {
+        /* Held in the slot; queued again once the ring drains */
+        slot->queued = false;
+    }
+
+    k_spin_unlock(&event_sys.coalesce_lock, key);
+    return 1;
+}
+
+/* Queue the slots left pending by a full ring; returns how many were queued */
+static int coalesce_requeue(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+    int queued = 0;
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
+    {
+        coalesce_slot_t *slot = &event_sys.coalesce_slots[i];
+
+        if (slot->pending && !slot->queued)
+        {
+            if (queue_push(NULL, i) < 0)
+            {
+                break;
             }
+            slot->queued = true;
+            queued++;
+        }
+    }
+
+    k_spin_unlock(&event_sys.coalesce_lock, key);
+    return queued;
+}
+
+/* Take the pending event of a slot the ring referred to */
+static bool coalesce_take(int idx, akira_event_t *event)
+{
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+    coalesce_slot_t *slot = &event_sys.coalesce_slots[idx];
+    int64_t now = k_uptime_get();
+    bool ready = false;
+
+    if (!slot->pending)
+    {
+        slot->queued = false;
+    }
+    else if (now < slot->next_due)
+    {
+        /* Too soon; keep folding posts in until the timer requeues it */
+        slot->deferred = true;
+        atomic_inc(&event_sys.rate_limited);
+        coalesce_arm_timer(now);
+    }
+    else
+    {
+        *event = slot->event;
+        slot->pending = false;
+        slot->queued = false;
+        slot->next_due = now + event_sys.coalesce_policies[slot->policy].interval_ms;
+        ready = true;
+    }
+
+    k_spin_unlock(&event_sys.coalesce_lock, key);
+    return ready;
+}
+
+static int wait_handler(const akira_event_t *event, void *user_data)
+{
+    event_waiter_t *waiter = user_data;
+
+    if (atomic_cas(&waiter->done, 0, 1))
+    {
+        if (waiter->out)
+        {
+            *waiter->out = *event;
         }
+        k_sem_give(&waiter->sem);
     }
+    return 0;
 }
 
+#ifdef CONFIG_AKIRA_EVENT_DISPATCH_THREAD
+static void dispatch_entry(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    while (1)
+    {
+        k_sem_take(&event_sys.queue_sem, K_FOREVER);
+        akira_event_process();
+    }
+}
+#endif
+
 /*===========================================================================*/
 /* Public API                                                                */
 /*===========================================================================*/
@@ -126,12 +661,58 @@ int akira_event_init(void)
     event_sys.subscription_count = 0;
     event_sys.next_id = 0;
 
+    for (int i = 0; i < EVENT_TYPE_BUCKETS; i++)
+    {
+        sys_dlist_init(&event_sys.by_type[i]);
+    }
+    for (int i = 0; i < EVENT_CATEGORIES; i++)
+    {
+        sys_dlist_init(&event_sys.by_category[i]);
+    }
+    sys_dlist_init(&event_sys.wide);
+    sys_dlist_init(&event_sys.free_list);
+
+    for (int i = 0; i < AKIRA_MAX_EVENT_HANDLERS; i++)
+    {
+        sys_dlist_append(&event_sys.free_list, &event_sys.subscriptions[i].node);
+    }
+    event_sys.next_seq = 0;
+    event_sys.dispatch_depth = 0;
+    event_sys.deferred_frees = 0;
+
+    for (int i = 0; i < AKIRA_EVENT_QUEUE_SIZE; i++)
+    {
+        atomic_set(&event_sys.queue[i].seq, i);
+    }
+    atomic_set(&event_sys.queue_tail, 0);
     event_sys.queue_head = 0;
-    event_sys.queue_tail = 0;
-    event_sys.queue_count = 0;
+    atomic_set(&event_sys.posted, 0);
+    atomic_set(&event_sys.overflows, 0);
+    event_sys.processed = 0;
+    event_sys.peak_depth = 0;
+
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_TYPES; i++)
+    {
+        event_sys.coalesce_policies[i].type = AKIRA_EVENT_NONE;
+    }
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
+    {
+        event_sys.coalesce_slots[i].policy = -1;
+    }
+    atomic_set(&event_sys.coalesce_count, 0);
+    atomic_set(&event_sys.coalesced, 0);
+    atomic_set(&event_sys.rate_limited, 0);
+    k_timer_init(&event_sys.coalesce_timer, coalesce_timer_expiry, NULL);
 
     event_sys.initialized = true;
 
+#ifdef CONFIG_AKIRA_EVENT_DISPATCH_THREAD
+    k_thread_create(&event_sys.dispatch_thread, dispatch_stack,
+                    K_THREAD_STACK_SIZEOF(dispatch_stack), dispatch_entry,
+                    NULL, NULL, NULL, DISPATCH_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&event_sys.dispatch_thread, "akira_event");
+#endif
+
     LOG_INF("Event system initialized (handlers=%d, queue=%d)",
             AKIRA_MAX_EVENT_HANDLERS, AKIRA_EVENT_QUEUE_SIZE);
 
@@ -150,27 +731,32 @@ akira_subscription_t akira_event_subscribe_range(akira_event_type_t type_min,
                                                  akira_event_handler_t handler,
                                                  void *user_data)
 {
-    if (!event_sys.initialized || !handler)
+    if (!event_sys.initialized || !handler || type_min > type_max)
     {
         return AKIRA_INVALID_HANDLE;
     }
 
     k_mutex_lock(&event_sys.mutex, K_FOREVER);
 
-    int slot = find_free_slot();
-    if (slot < 0)
+    /* Freed slots go to the tail, so stale handles are reused last */
+    sys_dnode_t *node = sys_dlist_get(&event_sys.free_list);
+    if (!node)
     {
         k_mutex_unlock(&event_sys.mutex);
         LOG_ERR("No free subscription slots");
         return AKIRA_INVALID_HANDLE;
     }
 
-    event_subscription_t *sub = &event_sys.subscriptions[slot];
+    event_subscription_t *sub = CONTAINER_OF(node, event_subscription_t, node);
+    int slot = sub - event_sys.subscriptions;
+
     sub->in_use = true;
+    sub->seq = event_sys.next_seq++;
     sub->type_min = type_min;
     sub->type_max = type_max;
     sub->handler = handler;
     sub->user_data = user_data;
+    sys_dlist_append(subscription_list(type_min, type_max), &sub->node);
 
     event_sys.subscription_count++;
 
@@ -190,16 +776,28 @@ int akira_event_unsubscribe(akira_subscription_t subscription)
 
     k_mutex_lock(&event_sys.mutex, K_FOREVER);
 
-    if (subscription >= AKIRA_MAX_EVENT_HANDLERS ||
-        !event_sys.subscriptions[subscription].in_use)
+    event_subscription_t *sub = find_subscription(subscription);
+    if (!sub)
     {
         k_mutex_unlock(&event_sys.mutex);
         return -1;
     }
 
-    event_sys.subscriptions[subscription].in_use = false;
+    sub->in_use = false;
     event_sys.subscription_count--;
 
+    if (event_sys.dispatch_depth > 0)
+    {
+        /* A handler unsubscribed; deliver_event() may still point at it */
+        event_sys.deferred_frees++;
+    }
+    else
+    {
+        sys_dlist_remove(&sub->node);
+        sub->handler = NULL;
+        sys_dlist_append(&event_sys.free_list, &sub->node);
+    }
+
     k_mutex_unlock(&event_sys.mutex);
 
     LOG_DBG("Unsubscribed slot %d", subscription);
@@ -214,8 +812,10 @@ int akira_event_publish(const akira_event_t *event)
         return -1;
     }
 
+    AKIRA_TRACE(AKIRA_TRACE_EVENT_PUBLISH, event->type, event->source_id, 0);
+
     k_mutex_lock(&event_sys.mutex, K_FOREVER);
-    deliver_event(event);
+    deliver_event(event, UINT32_MAX);
     k_mutex_unlock(&event_sys.mutex);
 
     return 0;
@@ -228,21 +828,29 @@ int akira_event_post(const akira_event_t *event)
         return -1;
     }
 
-    k_mutex_lock(&event_sys.mutex, K_FOREVER);
+    int ret = 0;
 
-    if (event_sys.queue_count >= AKIRA_EVENT_QUEUE_SIZE)
+    if (atomic_get(&event_sys.coalesce_count) > 0)
     {
-        k_mutex_unlock(&event_sys.mutex);
-        LOG_WRN("Event queue full, dropping event type %d", event->type);
-        return -1;
+        ret = coalesce_post(event);
     }
 
-    /* Copy event to queue */
-    event_sys.queue[event_sys.queue_tail] = *event;
-    event_sys.queue_tail = (event_sys.queue_tail + 1) % AKIRA_EVENT_QUEUE_SIZE;
-    event_sys.queue_count++;
+    if (ret == 0)
+    {
+        ret = queue_push(event, -1);
+    }
 
-    k_mutex_unlock(&event_sys.mutex);
+    if (ret < 0)
+    {
+        AKIRA_TRACE(AKIRA_TRACE_EVENT_DROP, event->type, event->source_id, 0);
+        if (atomic_inc(&event_sys.overflows) == 0)
+        {
+            LOG_WRN("Event queue full, dropping event type %d", event->type);
+        }
+        return -1;
+    }
+
+    atomic_inc(&event_sys.posted);
     k_sem_give(&event_sys.queue_sem);
 
     return 0;
@@ -262,24 +870,38 @@ int akira_event_process(void)
     }
 
     int processed = 0;
+    akira_event_t event;
+    int coalesce;
+    uint32_t pos;
 
     while (1)
     {
         k_mutex_lock(&event_sys.mutex, K_FOREVER);
 
-        if (event_sys.queue_count == 0)
+        event_sys.peak_depth = MAX(event_sys.peak_depth, queue_depth());
+
+        pos = event_sys.queue_head;
+        if (!queue_pop(&event, &coalesce))
         {
             k_mutex_unlock(&event_sys.mutex);
+
+            if (atomic_get(&event_sys.coalesce_count) > 0 && coalesce_requeue() > 0)
+            {
+                continue;
+            }
             break;
         }
 
-        /* Dequeue event */
-        akira_event_t event = event_sys.queue[event_sys.queue_head];
-        event_sys.queue_head = (event_sys.queue_head + 1) % AKIRA_EVENT_QUEUE_SIZE;
-        event_sys.queue_count--;
+        if (coalesce >= 0 && !coalesce_take(coalesce, &event))
+        {
+            /* Rate limited; the timer queues it again */
+            k_mutex_unlock(&event_sys.mutex);
+            continue;
+        }
 
         /* Deliver while holding lock (prevents subscription changes) */
-        deliver_event(&event);
+        deliver_event(&event, pos);
+        event_sys.processed++;
 
         k_mutex_unlock(&event_sys.mutex);
         processed++;
@@ -291,80 +913,155 @@ int akira_event_process(void)
 int akira_event_wait(akira_event_type_t type, akira_event_t *event,
                      akira_duration_t timeout_ms)
 {
-    if (!event_sys.initialized)
+    if (!event_sys.initialized || k_is_in_isr())
+    {
+        return -1;
+    }
+
+    event_waiter_t waiter = {.out = event};
+
+    k_sem_init(&waiter.sem, 0, 1);
+
+    akira_subscription_t sub = akira_event_subscribe(type, wait_handler, &waiter);
+    if (!AKIRA_HANDLE_VALID(sub))
     {
         return -1;
     }
 
     k_timeout_t timeout = (timeout_ms == AKIRA_WAIT_FOREVER) ? K_FOREVER : K_MSEC(timeout_ms);
+    int ret = k_sem_take(&waiter.sem, timeout);
 
-    uint64_t start = k_uptime_get();
+    akira_event_unsubscribe(sub);
 
-    while (1)
+    /* The event may have arrived between the timeout and unsubscribing */
+    return (ret == 0 || atomic_get(&waiter.done)) ? 0 : -1;
+}
+
+int akira_event_pending_count(void)
+{
+    return (int)queue_depth();
+}
+
+void akira_event_clear_queue(void)
+{
+    k_mutex_lock(&event_sys.mutex, K_FOREVER);
+
+    int coalesce;
+
+    while (queue_pop(NULL, &coalesce))
+    {
+    }
+    k_sem_reset(&event_sys.queue_sem);
+
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+    k_timer_stop(&event_sys.coalesce_timer);
+    for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; i++)
     {
-        /* Wait for event in queue */
-        if (k_sem_take(&event_sys.queue_sem, timeout) != 0)
+        event_sys.coalesce_slots[i].pending = false;
+        event_sys.coalesce_slots[i].queued = false;
+        event_sys.coalesce_slots[i].deferred = false;
+    }
+    k_spin_unlock(&event_sys.coalesce_lock, key);
+
+    k_mutex_unlock(&event_sys.mutex);
+
+    LOG_DBG("Cleared event queue");
+}
+
+int akira_event_set_coalesce(akira_event_type_t type, akira_event_coalesce_t mode,
+                             uint32_t max_rate_hz, akira_event_merge_t merge)
+{
+    if (!event_sys.initialized || type == AKIRA_EVENT_NONE ||
+        mode > AKIRA_EVENT_COALESCE_ACCUMULATE)
+    {
+        return -EINVAL;
+    }
+
+    /* A rate limit needs somewhere to hold the newest event */
+    if (max_rate_hz > 0 && mode == AKIRA_EVENT_COALESCE_NONE)
+    {
+        mode = AKIRA_EVENT_COALESCE_REPLACE;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&event_sys.coalesce_lock);
+
+    int idx = coalesce_policy_find(type);
+
+    if (mode == AKIRA_EVENT_COALESCE_NONE)
+    {
+        if (idx >= 0)
         {
-            return -1; /* Timeout */
+            /* Keep the rest of the policy for slots still draining */
+            event_sys.coalesce_policies[idx].type = AKIRA_EVENT_NONE;
+            atomic_dec(&event_sys.coalesce_count);
         }
+        k_spin_unlock(&event_sys.coalesce_lock, key);
+        return 0;
+    }
 
-        k_mutex_lock(&event_sys.mutex, K_FOREVER);
-
-        /* Search queue for matching event */
-        for (int i = 0; i < event_sys.queue_count; i++)
+    if (idx < 0)
+    {
+        /* Reuse an entry no slot refers to any more */
+        for (int i = 0; i < CONFIG_AKIRA_EVENT_COALESCE_TYPES && idx < 0; i++)
         {
-            int idx = (event_sys.queue_head + i) % AKIRA_EVENT_QUEUE_SIZE;
-            if (event_sys.queue[idx].type == type)
+            if (event_sys.coalesce_policies[i].type != AKIRA_EVENT_NONE)
             {
-                if (event)
-                {
-                    *event = event_sys.queue[idx];
-                }
+                continue;
+            }
+
+            idx = i;
+            for (int j = 0; j < CONFIG_AKIRA_EVENT_COALESCE_SLOTS; j++)
+            {
+                coalesce_slot_t *slot = &event_sys.coalesce_slots[j];
 
-                /* Remove from queue (shift remaining) */
-                for (int j = i; j < event_sys.queue_count - 1; j++)
+                if (slot->policy == i)
                 {
-                    int curr = (event_sys.queue_head + j) % AKIRA_EVENT_QUEUE_SIZE;
-                    int next = (event_sys.queue_head + j + 1) % AKIRA_EVENT_QUEUE_SIZE;
-                    event_sys.queue[curr] = event_sys.queue[next];
+                    if (slot->queued)
+                    {
+                        idx = -1;
+                        break;
+                    }
+                    slot->policy = -1;
                 }
-                event_sys.queue_count--;
-
-                k_mutex_unlock(&event_sys.mutex);
-                return 0;
             }
         }
 
-        k_mutex_unlock(&event_sys.mutex);
-
-        /* Update timeout */
-        if (timeout_ms != AKIRA_WAIT_FOREVER)
+        if (idx < 0)
         {
-            uint64_t elapsed = k_uptime_get() - start;
-            if (elapsed >= timeout_ms)
-            {
-                return -1;
-            }
-            timeout = K_MSEC(timeout_ms - elapsed);
+            k_spin_unlock(&event_sys.coalesce_lock, key);
+            LOG_ERR("No free coalescing policy for event type %d", type);
+            return -ENOMEM;
         }
+
+        atomic_inc(&event_sys.coalesce_count);
     }
-}
 
-int akira_event_pending_count(void)
-{
-    return event_sys.queue_count;
-}
+    coalesce_policy_t *policy = &event_sys.coalesce_policies[idx];
+    policy->type = type;
+    policy->mode = mode;
+    policy->interval_ms = max_rate_hz > 0 ? MAX(1000 / max_rate_hz, 1) : 0;
+    policy->merge = merge;
 
-void akira_event_clear_queue(void)
-{
-    k_mutex_lock(&event_sys.mutex, K_FOREVER);
+    k_spin_unlock(&event_sys.coalesce_lock, key);
 
-    event_sys.queue_head = 0;
-    event_sys.queue_tail = 0;
-    event_sys.queue_count = 0;
-    k_sem_reset(&event_sys.queue_sem);
+    LOG_DBG("Event type %d: coalesce mode %d, max %u Hz", type, mode, max_rate_hz);
 
-    k_mutex_unlock(&event_sys.mutex);
+    return 0;
+}
 
-    LOG_DBG("Cleared event queue");
+void akira_event_get_stats(akira_event_stats_t *stats)
+{
+    if (!stats)
+    {
+        return;
+    }
+
+    stats->posted = atomic_get(&event_sys.posted);
+    stats->overflows = atomic_get(&event_sys.overflows);
+    stats->processed = event_sys.processed;
+    stats->pending = queue_depth();
+    stats->peak_depth = event_sys.peak_depth;
+    stats->coalesced = atomic_get(&event_sys.coalesced);
+    stats->rate_limited = atomic_get(&event_sys.rate_limited);
+    stats->subscribers = event_sys.subscription_count;
 }
@@ -117,6 +117,7 @@ extern "C"
         uint32_t source_id;              /**< Source service/process ID */
         size_t data_size;                /**< Size of event data */
         void *data;                      /**< Event-specific data (may be NULL) */
+        int32_t value[2];                /**< Inline values (coordinates, deltas) */
     } akira_event_t;
 
     /*===========================================================================*/
@@ -125,12 +126,57 @@ extern "C"
 
     /**
      * @brief Event handler callback
+     *
+     * Handlers interested in an event run in the order they subscribed.
+     *
      * @param event Event data
      * @param user_data User context passed during subscription
      * @return 0 to continue propagation, non-zero to stop
      */
     typedef int (*akira_event_handler_t)(const akira_event_t *event, void *user_data);
 
+    /*===========================================================================*/
+    /* Event Coalescing                                                          */
+    /*===========================================================================*/
+
+    /**
+     * @brief How posted events of one type are folded together
+     *
+     * Coalesced types keep at most one pending event per type and
+     * source_id in the queue.
+     */
+    typedef enum
+    {
+        AKIRA_EVENT_COALESCE_NONE = 0,   /**< Queue every event */
+        AKIRA_EVENT_COALESCE_REPLACE,    /**< Newest event replaces the pending one */
+        AKIRA_EVENT_COALESCE_ACCUMULATE  /**< Sum value[] into the pending event */
+    } akira_event_coalesce_t;
+
+    /**
+     * @brief Custom accumulation for AKIRA_EVENT_COALESCE_ACCUMULATE
+     *
+     * Runs in the poster's context, possibly an ISR, with a spinlock held.
+     *
+     * @param pending Pending event to update
+     * @param incoming Newly posted event
+     */
+    typedef void (*akira_event_merge_t)(akira_event_t *pending, const akira_event_t *incoming);
+
+    /**
+     * @brief Event system statistics
+     */
+    typedef struct
+    {
+        uint32_t posted;       /**< Events accepted by akira_event_post() */
+        uint32_t overflows;    /**< Events dropped because the queue was full */
+        uint32_t processed;    /**< Queued events delivered */
+        uint32_t pending;      /**< Events waiting in the queue */
+        uint32_t peak_depth;   /**< Deepest queue seen by the consumer */
+        uint32_t coalesced;    /**< Posts folded into a pending event */
+        uint32_t rate_limited; /**< Deliveries postponed by a rate limit */
+        int subscribers;       /**< Active subscriptions */
+    } akira_event_stats_t;
+
     /*===========================================================================*/
     /* Event System API                                                          */
     /*===========================================================================*/
@@ -185,13 +231,31 @@ extern "C"
     /**
      * @brief Queue event for async delivery
      *
-     * Queues event for delivery by the event processing thread.
+     * Queues event for delivery by the event processing thread. Lock-free
+     * and safe to call from interrupt context; the event is copied, but
+     * event->data must stay valid until it is delivered.
      *
      * @param event Event to queue
      * @return 0 on success, -1 if queue full
      */
     int akira_event_post(const akira_event_t *event);
 
+    /**
+     * @brief Set the coalescing policy of a posted event type
+     *
+     * Applies to akira_event_post() only; akira_event_publish() always
+     * delivers immediately.
+     *
+     * @param type Event type
+     * @param mode Coalescing mode; NONE with no rate limit removes the policy
+     * @param max_rate_hz Deliver at most this often per source (0 = no limit);
+     *                    implies REPLACE if mode is NONE
+     * @param merge Custom accumulation, or NULL to sum value[]
+     * @return 0 on success, -EINVAL or -ENOMEM
+     */
+    int akira_event_set_coalesce(akira_event_type_t type, akira_event_coalesce_t mode,
+                                 uint32_t max_rate_hz, akira_event_merge_t merge);
+
     /**
      * @brief Publish simple event (no data)
      * @param type Event type
@@ -202,7 +266,8 @@ extern "C"
     /**
      * @brief Process queued events
      *
-     * Called from main loop to process async events.
+     * Run by the event dispatch thread; call it from a main loop when
+     * CONFIG_AKIRA_EVENT_DISPATCH_THREAD is disabled.
      *
      * @return Number of events processed
      */
@@ -210,6 +275,10 @@ extern "C"
 
     /**
      * @brief Wait for specific event
+     *
+     * Returns the next event of this type that is published or delivered
+     * from the queue; other subscribers still receive it. Not for ISRs.
+     *
      * @param type Event type to wait for
      * @param event Output for received event
      * @param timeout_ms Timeout in milliseconds
@@ -229,6 +298,12 @@ extern "C"
      */
     void akira_event_clear_queue(void);
 
+    /**
+     * @brief Get event system statistics
+     * @param stats Output statistics
+     */
+    void akira_event_get_stats(akira_event_stats_t *stats);
+
 /*===========================================================================*/
 /* Convenience Macros                                                        */
 /*===========================================================================*/
@@ -236,9 +311,9 @@ extern "C"
 /**
  * @brief Create a simple event
  */
-#define AKIRA_EVENT(type)                        \
+#define AKIRA_EVENT(event_type)                  \
     ((akira_event_t){                            \
-        .type = (type),                          \
+        .type = (event_type),                    \
         .priority = AKIRA_EVENT_PRIORITY_NORMAL, \
         .timestamp = k_uptime_get_32(),          \
         .source_id = 0,                          \
@@ -248,13 +323,13 @@ extern "C"
 /**
  * @brief Create an event with data
  */
-#define AKIRA_EVENT_WITH_DATA(type, ptr, size)   \
-    ((akira_event_t){                            \
-        .type = (type),                          \
-        .priority = AKIRA_EVENT_PRIORITY_NORMAL, \
-        .timestamp = k_uptime_get_32(),          \
-        .source_id = 0,                          \
-        .data_size = (size),                     \
+#define AKIRA_EVENT_WITH_DATA(event_type, ptr, size) \
+    ((akira_event_t){                                \
+        .type = (event_type),                        \
+        .priority = AKIRA_EVENT_PRIORITY_NORMAL,     \
+        .timestamp = k_uptime_get_32(),              \
+        .source_id = 0,                              \
+        .data_size = (size),                         \
         .data = (ptr)})
 
 #ifdef __cplusplus
@@ -0,0 +1,25 @@
+/**
+ * @file host_file.c
+ * @brief Host file output for native_sim debug dumps
+ *
+ * Built into the native_sim runner, so it can use host stdio.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include "host_file.h"
+
+int akira_host_write_file(const char *path, const void *buf, size_t len)
+{
+    FILE *f = fopen(path, "wb");
+    if (!f)
+    {
+        return -errno;
+    }
+
+    size_t written = fwrite(buf, 1, len, f);
+    fclose(f);
+
+    return written == len ? 0 : -EIO;
+}
@@ -0,0 +1,33 @@
+/**
+ * @file host_file.h
+ * @brief Host file output for native_sim debug dumps
+ *
+ * Implemented in host_file.c, which is built into the native_sim runner
+ * so it can use host stdio. Used by the memory profiler and the event
+ * trace to save dumps for the decoders in tools/.
+ */
+
+#ifndef AKIRA_KERNEL_HOST_FILE_H
+#define AKIRA_KERNEL_HOST_FILE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Write a buffer to a file on the host, replacing it
+     * @param path Host file path
+     * @param buf Data to write
+     * @param len Number of bytes
+     * @return 0 on success, negative errno on error
+     */
+    int akira_host_write_file(const char *path, const void *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_KERNEL_HOST_FILE_H */
@@ -7,6 +7,9 @@
 #include <zephyr/logging/log.h>
 #include <string.h>
 #include "memory.h"
+#include "process.h"
+#include "memprof.h"
+#include "reclaim.h"
 
 LOG_MODULE_REGISTER(akira_memory, CONFIG_AKIRA_LOG_LEVEL);
 
@@ -14,6 +17,101 @@ LOG_MODULE_REGISTER(akira_memory, CONFIG_AKIRA_LOG_LEVEL);
 /* Internal Structures                                                       */
 /*===========================================================================*/
 
+#define AKIRA_MAGAZINE_SIZE CONFIG_AKIRA_POOL_MAGAZINE_SIZE
+
+#ifdef CONFIG_MP_MAX_NUM_CPUS
+#define AKIRA_MAGAZINE_CPUS CONFIG_MP_MAX_NUM_CPUS
+#else
+#define AKIRA_MAGAZINE_CPUS 1
+#endif
+
+/* Alignment of the class table and each class's block area */
+#define AKIRA_SLAB_ALIGN 8
+
+/* Return address of the public allocation call, for the profiler */
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+#define CALL_SITE() __builtin_return_address(0)
+#else
+#define CALL_SITE() NULL
+#endif
+
+#define AKIRA_ACCT_SLOTS CONFIG_AKIRA_MEM_ACCT_SLOTS
+#define AKIRA_ALLOC_MAGIC 0xA10C
+
+BUILD_ASSERT(IS_POWER_OF_TWO(AKIRA_ACCT_SLOTS) && AKIRA_ACCT_SLOTS <= 128,
+             "CONFIG_AKIRA_MEM_ACCT_SLOTS must be a power of two <= 128");
+
+/*
+ * Header in front of every heap allocation. The owner is an index into
+ * mem_accounts so freeing never has to search for the process.
+ */
+struct akira_alloc_hdr
+{
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    uint16_t site; /* Profiler site index */
+    uint16_t reserved[3];
+#endif
+    uint32_t size;
+    uint16_t magic;
+    uint8_t acct;
+    uint8_t align_log2; /* Aligned allocations: padding before the header */
+};
+
+BUILD_ASSERT(sizeof(struct akira_alloc_hdr) == AKIRA_ALLOC_HDR_SIZE);
+
+enum akira_acct_state
+{
+    ACCT_EMPTY,
+    ACCT_LIVE,
+    ACCT_DEAD, /* Process exited, allocations still outstanding */
+};
+
+struct akira_mem_account
+{
+    akira_pid_t pid;
+    uint8_t state;
+    atomic_t bytes;
+    atomic_t peak;
+    atomic_t allocs;
+    atomic_t frees;
+};
+
+/*
+ * Per-CPU cache of free blocks. Each magazine has its own lock, which in
+ * normal operation only its CPU takes, so the fast path never contends
+ * or bounces a cache line; class_drain() takes each one in turn.
+ */
+struct akira_magazine
+{
+    struct k_spinlock lock;
+    uint32_t count;
+    uint32_t alloc_count;
+    uint32_t free_count;
+#if AKIRA_MAGAZINE_SIZE > 0
+    void *rounds[AKIRA_MAGAZINE_SIZE];
+#endif
+};
+
+/*
+ * One block size backed by a k_mem_slab. Counters live in the per-CPU
+ * magazines and are only summed when statistics are requested.
+ */
+struct akira_slab_class
+{
+    struct k_mem_slab slab;
+    size_t block_size;
+    char *base; /* Block area, used to find the class of a freed block */
+    char *end;
+    atomic_t out_blocks;  /* Taken from the slab, including cached blocks */
+    atomic_t peak_blocks;
+    atomic_t failures;
+    uint8_t *owners; /* Account index of each block */
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    uint16_t *sites; /* Profiler site index of each block */
+#endif
+    struct akira_magazine mags[AKIRA_MAGAZINE_CPUS];
+};
+
 struct akira_pool
 {
     const char *name;
@@ -24,14 +122,15 @@ struct akira_pool
     bool owns_buffer;
     uint32_t flags;
 
-    /* Statistics */
+    /* Statistics (variable pools; slab pools aggregate on demand) */
     size_t used_bytes;
     size_t peak_usage;
     uint32_t alloc_count;
     uint32_t free_count;
     uint32_t alloc_failures;
+    uint8_t pressure; /* Last akira_mem_pressure_t seen by the watermarks */
 
-    /* Synchronization */
+    /* Synchronization (variable pools only) */
     struct k_mutex mutex;
 
     /* Type-specific data */
@@ -39,9 +138,14 @@ struct akira_pool
     {
         struct
         {
-            struct k_mem_slab slab;
+            struct akira_slab_class cls;
         } fixed;
         struct
+        {
+            struct akira_slab_class *classes; /* Carved from the pool buffer */
+            uint8_t num_classes;
+        } slab;
+        struct
         {
             struct k_heap heap;
         } variable;
@@ -63,6 +167,645 @@ static struct
     akira_mem_stats_t global_stats;
 } mem_mgr;
 
+/* Slot 0 is the kernel account for PID 0 and anything unattributed */
+static struct akira_mem_account mem_accounts[AKIRA_ACCT_SLOTS] = {
+    [0] = {.pid = 0, .state = ACCT_LIVE},
+};
+static struct k_spinlock acct_lock;
+
+/*===========================================================================*/
+/* Per-Process Accounting                                                    */
+/*===========================================================================*/
+
+static int acct_find(akira_pid_t pid)
+{
+    if (pid == 0)
+    {
+        return 0;
+    }
+
+    /* Open addressing over slots 1..N-1, starting at the PID's home slot */
+    for (int n = 0; n < AKIRA_ACCT_SLOTS - 1; n++)
+    {
+        int i = 1 + (pid + n) % (AKIRA_ACCT_SLOTS - 1);
+
+        if (mem_accounts[i].state == ACCT_EMPTY)
+        {
+            break;
+        }
+        if (mem_accounts[i].pid == pid)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+static int acct_claim(akira_pid_t pid)
+{
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int slot = acct_find(pid);
+
+    for (int n = 0; slot < 0 && n < AKIRA_ACCT_SLOTS - 1; n++)
+    {
+        int i = 1 + (pid + n) % (AKIRA_ACCT_SLOTS - 1);
+        struct akira_mem_account *a = &mem_accounts[i];
+
+        /* Retired accounts are recycled once their last byte is freed */
+        if (a->state == ACCT_EMPTY ||
+            (a->state == ACCT_DEAD && atomic_get(&a->bytes) == 0))
+        {
+            a->pid = pid;
+            atomic_set(&a->bytes, 0);
+            atomic_set(&a->peak, 0);
+            atomic_set(&a->allocs, 0);
+            atomic_set(&a->frees, 0);
+            a->state = ACCT_LIVE;
+            slot = i;
+        }
+    }
+
+    k_spin_unlock(&acct_lock, key);
+
+    if (slot < 0)
+    {
+        LOG_WRN("No accounting slot for PID %u, charging kernel", pid);
+        slot = 0;
+    }
+
+    return slot;
+}
+
+/** Account of the calling process, created on its first allocation */
+static uint8_t acct_current(void)
+{
+    akira_pid_t pid = akira_process_current();
+    int slot = acct_find(pid);
+
+    return (uint8_t)(slot >= 0 ? slot : acct_claim(pid));
+}
+
+static void acct_charge(uint8_t slot, size_t size)
+{
+    struct akira_mem_account *a = &mem_accounts[slot];
+    atomic_val_t bytes = atomic_add(&a->bytes, size) + size;
+    atomic_val_t peak = atomic_get(&a->peak);
+
+    atomic_inc(&a->allocs);
+    while (bytes > peak && !atomic_cas(&a->peak, peak, bytes))
+    {
+        peak = atomic_get(&a->peak);
+    }
+}
+
+static void acct_credit(uint8_t slot, size_t size)
+{
+    atomic_sub(&mem_accounts[slot].bytes, size);
+    atomic_inc(&mem_accounts[slot].frees);
+}
+
+static void *hdr_track(void *raw, size_t size, size_t align, const void *site, uint8_t tag)
+{
+    size_t pad = AKIRA_ALLOC_PAD(align);
+    struct akira_alloc_hdr *hdr = (struct akira_alloc_hdr *)((char *)raw + pad) - 1;
+
+    hdr->size = size;
+    hdr->magic = AKIRA_ALLOC_MAGIC;
+    hdr->acct = acct_current();
+    hdr->align_log2 = pad > AKIRA_ALLOC_HDR_SIZE ? find_lsb_set(pad) - 1 : 0;
+    acct_charge(hdr->acct, size);
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    hdr->site = akira_memprof_on_alloc(site, tag, size);
+#else
+    ARG_UNUSED(site);
+    ARG_UNUSED(tag);
+#endif
+
+    return hdr + 1;
+}
+
+void *akira_memory_track(void *raw, size_t size, size_t align, const void *site)
+{
+    return hdr_track(raw, size, align, site ? site : CALL_SITE(), AKIRA_MEMPROF_TAG_EXT);
+}
+
+void *akira_memory_untrack(void *ptr, size_t *size)
+{
+    struct akira_alloc_hdr *hdr = (struct akira_alloc_hdr *)ptr - 1;
+
+    if (hdr->magic != AKIRA_ALLOC_MAGIC || hdr->acct >= AKIRA_ACCT_SLOTS)
+    {
+        LOG_ERR("Free of untracked or corrupted block %p", ptr);
+        return NULL;
+    }
+
+    hdr->magic = 0; /* Catch double frees */
+    acct_credit(hdr->acct, hdr->size);
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    akira_memprof_on_free(hdr->site, hdr->size);
+#endif
+    if (size)
+    {
+        *size = hdr->size;
+    }
+
+    return (char *)(hdr + 1) - (hdr->align_log2 ? BIT(hdr->align_log2) : sizeof(*hdr));
+}
+
+/*===========================================================================*/
+/* Slab Classes & Magazines                                                  */
+/*===========================================================================*/
+
+static inline struct akira_magazine *local_magazine(struct akira_slab_class *cls)
+{
+#ifdef CONFIG_SMP
+    return &cls->mags[arch_curr_cpu()->id];
+#else
+    return &cls->mags[0];
+#endif
+}
+
+static void class_note_out(struct akira_slab_class *cls, int delta)
+{
+    atomic_val_t out = atomic_add(&cls->out_blocks, delta) + delta;
+    atomic_val_t peak = atomic_get(&cls->peak_blocks);
+
+    while (out > peak && !atomic_cas(&cls->peak_blocks, peak, out))
+    {
+        peak = atomic_get(&cls->peak_blocks);
+    }
+}
+
+static int class_init(struct akira_slab_class *cls, void *buffer,
+                      size_t block_size, uint32_t num_blocks)
+{
+    memset(cls, 0, sizeof(*cls));
+    cls->block_size = block_size;
+    cls->base = buffer;
+    cls->end = (char *)buffer + block_size * num_blocks;
+
+    cls->owners = k_malloc(num_blocks);
+    if (!cls->owners)
+    {
+        return -ENOMEM;
+    }
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    cls->sites = k_malloc(num_blocks * sizeof(uint16_t));
+    if (!cls->sites)
+    {
+        return -ENOMEM;
+    }
+#endif
+
+    return k_mem_slab_init(&cls->slab, buffer, block_size, num_blocks);
+}
+
+/** Charge a block handed out by class_alloc() to the calling process */
+static void *class_track(struct akira_slab_class *cls, void *ptr,
+                         const void *site, uint8_t tag)
+{
+    if (ptr)
+    {
+        size_t idx = ((char *)ptr - cls->base) / cls->block_size;
+        uint8_t acct = acct_current();
+
+        cls->owners[idx] = acct;
+        acct_charge(acct, cls->block_size);
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+        cls->sites[idx] = akira_memprof_on_alloc(site, tag, cls->block_size);
+#else
+        ARG_UNUSED(site);
+        ARG_UNUSED(tag);
+#endif
+    }
+    return ptr;
+}
+
+/** True if ptr is the start of one of the class's blocks */
+static bool class_owns(const struct akira_slab_class *cls, const void *ptr)
+{
+    const char *p = ptr;
+
+    return p >= cls->base && p < cls->end &&
+           (size_t)(p - cls->base) % cls->block_size == 0;
+}
+
+static void class_untrack(struct akira_slab_class *cls, void *ptr)
+{
+    size_t idx = ((char *)ptr - cls->base) / cls->block_size;
+
+    acct_credit(cls->owners[idx], cls->block_size);
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    akira_memprof_on_free(cls->sites[idx], cls->block_size);
+#endif
+}
+
+static void class_release(struct akira_slab_class *cls)
+{
+    k_free(cls->owners);
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    k_free(cls->sites);
+#endif
+}
+
+/**
+ * @brief Take a block, from the local magazine when it has one
+ * @param refilled Set when the shared slab had to be touched, which is
+ *                 when callers re-evaluate pool pressure
+ */
+static void *class_alloc(struct akira_slab_class *cls, bool *refilled)
+{
+    void *ptr;
+
+    *refilled = true;
+
+#if AKIRA_MAGAZINE_SIZE > 0
+    struct akira_magazine *mag = local_magazine(cls);
+    k_spinlock_key_t key = k_spin_lock(&mag->lock);
+
+    if (mag->count > 0)
+    {
+        ptr = mag->rounds[--mag->count];
+        mag->alloc_count++;
+        k_spin_unlock(&mag->lock, key);
+        *refilled = false;
+        return ptr;
+    }
+    k_spin_unlock(&mag->lock, key);
+
+    /* Magazine empty: refill half of it from the shared slab */
+    void *batch[(AKIRA_MAGAZINE_SIZE + 1) / 2];
+    int got = 0;
+
+    while (got < (int)ARRAY_SIZE(batch) &&
+           k_mem_slab_alloc(&cls->slab, &batch[got], K_NO_WAIT) == 0)
+    {
+        got++;
+    }
+
+    if (got == 0)
+    {
+        return NULL;
+    }
+    class_note_out(cls, got);
+
+    ptr = batch[--got];
+
+    mag = local_magazine(cls); /* May have migrated to another CPU */
+    key = k_spin_lock(&mag->lock);
+    mag->alloc_count++;
+    while (got > 0 && mag->count < AKIRA_MAGAZINE_SIZE)
+    {
+        mag->rounds[mag->count++] = batch[--got];
+    }
+    k_spin_unlock(&mag->lock, key);
+
+    /* Only if another thread filled the magazine meanwhile */
+    if (got > 0)
+    {
+        class_note_out(cls, -got);
+        while (got > 0)
+        {
+            k_mem_slab_free(&cls->slab, batch[--got]);
+        }
+    }
+#else
+    if (k_mem_slab_alloc(&cls->slab, &ptr, K_NO_WAIT) != 0)
+    {
+        return NULL;
+    }
+    class_note_out(cls, 1);
+
+    struct akira_magazine *mag = local_magazine(cls);
+    k_spinlock_key_t key = k_spin_lock(&mag->lock);
+    mag->alloc_count++;
+    k_spin_unlock(&mag->lock, key);
+#endif
+
+    return ptr;
+}
+
+static void class_free(struct akira_slab_class *cls, void *ptr)
+{
+    struct akira_magazine *mag = local_magazine(cls);
+
+#if AKIRA_MAGAZINE_SIZE > 0
+    void *flush[AKIRA_MAGAZINE_SIZE / 2 + 1];
+    int n = 0;
+    k_spinlock_key_t key = k_spin_lock(&mag->lock);
+
+    /* Full: hand half back to the shared slab to make room */
+    if (mag->count == AKIRA_MAGAZINE_SIZE)
+    {
+        while (n < AKIRA_MAGAZINE_SIZE / 2 || n == 0)
+        {
+            flush[n++] = mag->rounds[--mag->count];
+        }
+    }
+    mag->rounds[mag->count++] = ptr;
+    mag->free_count++;
+    k_spin_unlock(&mag->lock, key);
+
+    if (n > 0)
+    {
+        class_note_out(cls, -n);
+        while (n > 0)
+        {
+            k_mem_slab_free(&cls->slab, flush[--n]);
+        }
+    }
+#else
+    k_spinlock_key_t key = k_spin_lock(&mag->lock);
+    mag->free_count++;
+    k_spin_unlock(&mag->lock, key);
+
+    k_mem_slab_free(&cls->slab, ptr);
+    class_note_out(cls, -1);
+#endif
+}
+
+/**
+ * @brief Return every cached block of every CPU's magazine to the slab
+ *
+ * Each magazine is emptied under its own lock, so blocks cached on other
+ * CPUs are not stranded while memory is being reclaimed.
+ */
+static int class_drain(struct akira_slab_class *cls)
+{
+    int drained = 0;
+
+#if AKIRA_MAGAZINE_SIZE > 0
+    for (int i = 0; i < AKIRA_MAGAZINE_CPUS; i++)
+    {
+        struct akira_magazine *mag = &cls->mags[i];
+
+        for (;;)
+        {
+            void *ptr;
+            k_spinlock_key_t key = k_spin_lock(&mag->lock);
+
+            if (mag->count == 0)
+            {
+                k_spin_unlock(&mag->lock, key);
+                break;
+            }
+            ptr = mag->rounds[--mag->count];
+            k_spin_unlock(&mag->lock, key);
+
+            k_mem_slab_free(&cls->slab, ptr);
+            class_note_out(cls, -1);
+            drained++;
+        }
+    }
+#else
+    ARG_UNUSED(cls);
+#endif
+
+    return drained;
+}
+
+/** Lazily sum the per-CPU counters of a class */
+static void class_counts(struct akira_slab_class *cls, uint32_t *allocs,
+                         uint32_t *frees, uint32_t *cached)
+{
+    *allocs = 0;
+    *frees = 0;
+    *cached = 0;
+
+    for (int i = 0; i < AKIRA_MAGAZINE_CPUS; i++)
+    {
+        *allocs += cls->mags[i].alloc_count;
+        *frees += cls->mags[i].free_count;
+        *cached += cls->mags[i].count;
+    }
+}
+
+static struct akira_slab_class *pool_classes(akira_pool_t *pool, int *count)
+{
+    if (pool->type == AKIRA_POOL_SLAB)
+    {
+        *count = pool->slab.num_classes;
+        return pool->slab.classes;
+    }
+
+    *count = 1;
+    return &pool->fixed.cls;
+}
+
+static size_t pool_used_bytes(akira_pool_t *pool)
+{
+    if (pool->type == AKIRA_POOL_VARIABLE)
+    {
+        return pool->used_bytes;
+    }
+
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
+    size_t used = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t allocs, frees, cached;
+        class_counts(&classes[i], &allocs, &frees, &cached);
+        used += (size_t)(allocs - frees) * classes[i].block_size;
+    }
+
+    return used;
+}
+
+/*===========================================================================*/
+/* Slab Pools                                                                */
+/*===========================================================================*/
+
+static size_t slab_table_size(int num_classes)
+{
+    return ROUND_UP(num_classes * sizeof(struct akira_slab_class), AKIRA_SLAB_ALIGN);
+}
+
+/**
+ * @brief Work out the size classes of a slab pool
+ *
+ * Explicit classes are validated and rounded to pointer alignment; default
+ * classes are powers of two sharing the pool bytes equally. Classes left
+ * without a single block are dropped.
+ *
+ * @return Number of classes, negative on error; *needed gets the buffer size
+ */
+static int slab_layout(const akira_pool_config_t *config,
+                       akira_slab_class_config_t *out, size_t *needed)
+{
+    int n = 0;
+
+    if (config->classes)
+    {
+        if (config->num_classes == 0 ||
+            config->num_classes > CONFIG_AKIRA_SLAB_MAX_CLASSES)
+        {
+            return -EINVAL;
+        }
+
+        for (int i = 0; i < config->num_classes; i++)
+        {
+            size_t bs = ROUND_UP(MAX(config->classes[i].block_size, sizeof(void *)),
+                                 sizeof(void *));
+
+            if (n > 0 && bs <= out[n - 1].block_size)
+            {
+                return -EINVAL; /* Must be strictly ascending */
+            }
+            if (config->classes[i].num_blocks == 0)
+            {
+                continue;
+            }
+            out[n].block_size = bs;
+            out[n].num_blocks = config->classes[i].num_blocks;
+            n++;
+        }
+    }
+    else
+    {
+        size_t max = config->block_size > 0 ? config->block_size : AKIRA_SLAB_DEFAULT_MAX_CLASS;
+        int count = 0;
+
+        for (size_t bs = AKIRA_SLAB_MIN_CLASS;
+             count < CONFIG_AKIRA_SLAB_MAX_CLASSES; bs <<= 1)
+        {
+            out[count++].block_size = bs;
+            if (bs >= max)
+            {
+                break;
+            }
+        }
+
+        size_t table = slab_table_size(count);
+        if (config->total_size <= table)
+        {
+            return -ENOMEM;
+        }
+
+        size_t share = (config->total_size - table) / count;
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t blocks = share / out[i].block_size;
+            if (blocks > 0)
+            {
+                out[n].block_size = out[i].block_size;
+                out[n].num_blocks = blocks;
+                n++;
+            }
+        }
+    }
+
+    if (n == 0)
+    {
+        return -ENOMEM;
+    }
+
+    *needed = slab_table_size(n);
+    for (int i = 0; i < n; i++)
+    {
+        *needed += ROUND_UP(out[i].block_size * out[i].num_blocks, AKIRA_SLAB_ALIGN);
+    }
+
+    return n;
+}
+
+static int slab_pool_init(akira_pool_t *pool, const akira_slab_class_config_t *layout,
+                          int num_classes)
+{
+    char *area = (char *)pool->buffer + slab_table_size(num_classes);
+
+    pool->slab.classes = pool->buffer;
+    pool->slab.num_classes = 0;
+
+    for (int i = 0; i < num_classes; i++)
+    {
+        int ret = class_init(&pool->slab.classes[i], area, layout[i].block_size,
+                             layout[i].num_blocks);
+        if (ret < 0)
+        {
+            class_release(&pool->slab.classes[i]);
+            return ret;
+        }
+        pool->slab.num_classes++;
+        area += ROUND_UP(layout[i].block_size * layout[i].num_blocks, AKIRA_SLAB_ALIGN);
+    }
+
+    return 0;
+}
+
+/** Free the per-block owner tables of a fixed or slab pool */
+static void pool_release_classes(akira_pool_t *pool)
+{
+    if (pool->type == AKIRA_POOL_VARIABLE)
+    {
+        return;
+    }
+
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
+
+    for (int i = 0; i < count; i++)
+    {
+        class_release(&classes[i]);
+    }
+}
+
+static void *slab_pool_alloc(akira_pool_t *pool, size_t size, const void *site,
+                             bool *refilled)
+{
+    struct akira_slab_class *classes = pool->slab.classes;
+    int n = pool->slab.num_classes;
+    int first = 0;
+
+    while (first < n && classes[first].block_size < size)
+    {
+        first++;
+    }
+
+    if (first == n)
+    {
+        atomic_inc(&classes[n - 1].failures);
+        return NULL;
+    }
+
+    /* Round up to the best class, spill into larger ones when it is full */
+    for (int i = first; i < n; i++)
+    {
+        void *ptr = class_alloc(&classes[i], refilled);
+        if (ptr)
+        {
+            return class_track(&classes[i], ptr, site,
+                               AKIRA_MEMPROF_TAG_POOL(pool - mem_mgr.pools));
+        }
+    }
+
+    atomic_inc(&classes[first].failures);
+    return NULL;
+}
+
+static void slab_pool_free(akira_pool_t *pool, void *ptr)
+{
+    for (int i = 0; i < pool->slab.num_classes; i++)
+    {
+        struct akira_slab_class *cls = &pool->slab.classes[i];
+
+        if ((char *)ptr >= cls->base && (char *)ptr < cls->end)
+        {
+            if (!class_owns(cls, ptr))
+            {
+                break;
+            }
+            class_untrack(cls, ptr);
+            class_free(cls, ptr);
+            return;
+        }
+    }
+
+    LOG_ERR("Pool '%s': free of foreign pointer %p", pool->name, ptr);
+}
+
 /*===========================================================================*/
 /* Memory Pool Implementation                                                */
 /*===========================================================================*/
@@ -115,12 +858,39 @@ akira_pool_t *akira_pool_create(const akira_pool_config_t *config)
         return NULL;
     }
 
+    /* Slab pools derive their size from the class layout */
+    akira_slab_class_config_t layout[CONFIG_AKIRA_SLAB_MAX_CLASSES];
+    int num_classes = 0;
+    size_t total_size = config->total_size;
+
+    if (config->type == AKIRA_POOL_SLAB)
+    {
+        size_t needed = 0;
+
+        num_classes = slab_layout(config, layout, &needed);
+        if (num_classes < 0 || (total_size > 0 && needed > total_size))
+        {
+            k_mutex_unlock(&mem_mgr.mutex);
+            LOG_ERR("Invalid slab classes for pool '%s'",
+                    config->name ? config->name : "unnamed");
+            return NULL;
+        }
+        if (total_size == 0)
+        {
+            total_size = needed;
+        }
+    }
+
     /* Initialize pool */
     memset(pool, 0, sizeof(*pool));
     pool->name = config->name ? config->name : "unnamed";
     pool->type = config->type;
-    pool->total_size = config->total_size;
+    pool->total_size = total_size;
     pool->block_size = config->block_size > 0 ? config->block_size : AKIRA_POOL_DEFAULT_BLOCK;
+    if (config->type == AKIRA_POOL_SLAB)
+    {
+        pool->block_size = layout[num_classes - 1].block_size;
+    }
     pool->flags = config->flags;
 
     k_mutex_init(&pool->mutex);
@@ -133,7 +903,7 @@ akira_pool_t *akira_pool_create(const akira_pool_config_t *config)
     }
     else
     {
-        pool->buffer = k_malloc(config->total_size);
+        pool->buffer = k_malloc(total_size);
         if (!pool->buffer)
         {
             memset(pool, 0, sizeof(*pool));
@@ -149,9 +919,8 @@ akira_pool_t *akira_pool_create(const akira_pool_config_t *config)
     switch (config->type)
     {
     case AKIRA_POOL_FIXED:
-        ret = k_mem_slab_init(&pool->fixed.slab, pool->buffer,
-                              pool->block_size,
-                              pool->total_size / pool->block_size);
+        ret = class_init(&pool->fixed.cls, pool->buffer, pool->block_size,
+                         pool->total_size / pool->block_size);
         break;
 
     case AKIRA_POOL_VARIABLE:
@@ -159,15 +928,13 @@ akira_pool_t *akira_pool_create(const akira_pool_config_t *config)
         break;
 
     case AKIRA_POOL_SLAB:
-        /* Same as fixed for now */
-        ret = k_mem_slab_init(&pool->fixed.slab, pool->buffer,
-                              pool->block_size,
-                              pool->total_size / pool->block_size);
+        ret = slab_pool_init(pool, layout, num_classes);
         break;
     }
 
     if (ret < 0)
     {
+        pool_release_classes(pool);
         if (pool->owns_buffer)
         {
             k_free(pool->buffer);
@@ -179,8 +946,8 @@ akira_pool_t *akira_pool_create(const akira_pool_config_t *config)
     }
 
     mem_mgr.pool_count++;
-    mem_mgr.global_stats.total_bytes += config->total_size;
-    mem_mgr.global_stats.free_bytes += config->total_size;
+    mem_mgr.global_stats.total_bytes += total_size;
+    mem_mgr.global_stats.free_bytes += total_size;
 
     k_mutex_unlock(&mem_mgr.mutex);
 
@@ -201,10 +968,13 @@ void akira_pool_destroy(akira_pool_t *pool)
 
     LOG_INF("Destroying pool '%s'", pool->name);
 
+    size_t used = pool_used_bytes(pool);
+
     mem_mgr.global_stats.total_bytes -= pool->total_size;
-    mem_mgr.global_stats.free_bytes -= (pool->total_size - pool->used_bytes);
-    mem_mgr.global_stats.used_bytes -= pool->used_bytes;
+    mem_mgr.global_stats.free_bytes -= (pool->total_size - used);
+    mem_mgr.global_stats.used_bytes -= used;
 
+    pool_release_classes(pool);
     if (pool->owns_buffer && pool->buffer)
     {
         k_free(pool->buffer);
@@ -216,69 +986,136 @@ void akira_pool_destroy(akira_pool_t *pool)
     k_mutex_unlock(&mem_mgr.mutex);
 }
 
-void *akira_pool_alloc(akira_pool_t *pool, size_t size)
+/** Free bytes and capacity of a pool, for the pressure watermarks */
+static size_t pool_free_bytes(akira_pool_t *pool, size_t *total)
 {
-    if (!pool)
+    if (pool->type == AKIRA_POOL_VARIABLE)
     {
-        return NULL;
+        *total = pool->total_size;
+        return pool->total_size - MIN(pool->used_bytes, pool->total_size);
     }
 
-    void *ptr = NULL;
+    /* Blocks parked in magazines are free; they are only a drain away */
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
 
-    k_mutex_lock(&pool->mutex, K_FOREVER);
+    *total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        *total += (size_t)(classes[i].end - classes[i].base);
+    }
+
+    return *total - MIN(pool_used_bytes(pool), *total);
+}
 
+static bool pool_fits(akira_pool_t *pool, size_t size)
+{
     switch (pool->type)
     {
     case AKIRA_POOL_FIXED:
+        return size <= pool->block_size;
     case AKIRA_POOL_SLAB:
+        return size <= pool->slab.classes[pool->slab.num_classes - 1].block_size;
+    default:
+        return size <= pool->total_size;
+    }
+}
+
+/**
+ * @brief Allocate without reclaiming
+ * @param refilled Set unless the block came straight from a magazine
+ */
+static void *pool_try_alloc(akira_pool_t *pool, size_t size, const void *site,
+                            bool *refilled)
+{
+    *refilled = true;
+
+    /* Fixed and slab pools: per-CPU magazine fast path */
+    if (pool->type == AKIRA_POOL_SLAB)
+    {
+        return slab_pool_alloc(pool, size, site, refilled);
+    }
+
+    if (pool->type == AKIRA_POOL_FIXED)
+    {
         if (size > pool->block_size)
         {
-            pool->alloc_failures++;
-            k_mutex_unlock(&pool->mutex);
+            atomic_inc(&pool->fixed.cls.failures);
             return NULL;
         }
-        if (k_mem_slab_alloc(&pool->fixed.slab, &ptr, K_NO_WAIT) != 0)
+        void *ptr = class_alloc(&pool->fixed.cls, refilled);
+        if (!ptr)
         {
-            pool->alloc_failures++;
-            ptr = NULL;
+            atomic_inc(&pool->fixed.cls.failures);
         }
-        else
-        {
-            pool->used_bytes += pool->block_size;
-        }
-        break;
-
-    case AKIRA_POOL_VARIABLE:
-        ptr = k_heap_alloc(&pool->variable.heap, size, K_NO_WAIT);
-        if (ptr)
-        {
-            pool->used_bytes += size;
-        }
-        else
-        {
-            pool->alloc_failures++;
-        }
-        break;
+        return class_track(&pool->fixed.cls, ptr, site,
+                           AKIRA_MEMPROF_TAG_POOL(pool - mem_mgr.pools));
     }
 
+    k_mutex_lock(&pool->mutex, K_FOREVER);
+
+    void *ptr = k_heap_alloc(&pool->variable.heap, AKIRA_ALLOC_HDR_SIZE + size, K_NO_WAIT);
     if (ptr)
     {
+        ptr = hdr_track(ptr, size, 0, site, AKIRA_MEMPROF_TAG_POOL(pool - mem_mgr.pools));
+        pool->used_bytes += size;
         pool->alloc_count++;
         if (pool->used_bytes > pool->peak_usage)
         {
             pool->peak_usage = pool->used_bytes;
         }
     }
+    else
+    {
+        pool->alloc_failures++;
+    }
 
     k_mutex_unlock(&pool->mutex);
 
     return ptr;
 }
 
+static void *pool_alloc_at(akira_pool_t *pool, size_t size, const void *site)
+{
+    if (!pool)
+    {
+        return NULL;
+    }
+
+    bool refilled;
+    void *ptr = pool_try_alloc(pool, size, site, &refilled);
+
+    /* Let caches give memory back before failing the caller */
+    if (!ptr && pool_fits(pool, size) && akira_reclaim_on_failure(AKIRA_MEM_DOMAIN_POOL, size))
+    {
+        ptr = pool_try_alloc(pool, size, site, &refilled);
+    }
+
+    /*
+     * Summing the per-CPU counters is too slow for the magazine fast
+     * path, so the watermarks are only re-checked when an allocation
+     * had to go to the slab. At most one magazine's worth of blocks per
+     * CPU is handed out in between.
+     */
+    if (ptr && refilled)
+    {
+        size_t total;
+        size_t free_bytes = pool_free_bytes(pool, &total);
+        akira_reclaim_check(AKIRA_MEM_DOMAIN_POOL, &pool->pressure, free_bytes, total);
+    }
+
+    return ptr;
+}
+
+void *akira_pool_alloc(akira_pool_t *pool, size_t size)
+{
+    return pool_alloc_at(pool, size, CALL_SITE());
+}
+
 void *akira_pool_calloc(akira_pool_t *pool, size_t count, size_t size)
 {
     size_t total = count * size;
-    void *ptr = akira_pool_alloc(pool, total);
+    void *ptr = pool_alloc_at(pool, total, CALL_SITE());
     if (ptr)
     {
         memset(ptr, 0, total);
@@ -293,23 +1130,35 @@ void akira_pool_free(akira_pool_t *pool, void *ptr)
         return;
     }
 
-    k_mutex_lock(&pool->mutex, K_FOREVER);
-
-    switch (pool->type)
+    if (pool->type == AKIRA_POOL_SLAB)
     {
-    case AKIRA_POOL_FIXED:
-    case AKIRA_POOL_SLAB:
-        k_mem_slab_free(&pool->fixed.slab, ptr);
-        pool->used_bytes -= pool->block_size;
-        break;
+        slab_pool_free(pool, ptr);
+        return;
+    }
 
-    case AKIRA_POOL_VARIABLE:
-        k_heap_free(&pool->variable.heap, ptr);
-        /* Note: Can't track exact size freed for variable pools */
-        break;
+    if (pool->type == AKIRA_POOL_FIXED)
+    {
+        if (!class_owns(&pool->fixed.cls, ptr))
+        {
+            LOG_ERR("Pool '%s': free of foreign pointer %p", pool->name, ptr);
+            return;
+        }
+        class_untrack(&pool->fixed.cls, ptr);
+        class_free(&pool->fixed.cls, ptr);
+        return;
     }
 
-    pool->free_count++;
+    k_mutex_lock(&pool->mutex, K_FOREVER);
+
+    size_t size;
+    void *raw = akira_memory_untrack(ptr, &size);
+
+    if (raw)
+    {
+        k_heap_free(&pool->variable.heap, raw);
+        pool->used_bytes -= size;
+        pool->free_count++;
+    }
 
     k_mutex_unlock(&pool->mutex);
 }
@@ -321,6 +1170,35 @@ int akira_pool_stats(akira_pool_t *pool, akira_mem_stats_t *stats)
         return -1;
     }
 
+    if (pool->type != AKIRA_POOL_VARIABLE)
+    {
+        int count;
+        struct akira_slab_class *classes = pool_classes(pool, &count);
+
+        memset(stats, 0, sizeof(*stats));
+        stats->total_bytes = pool->total_size;
+
+        for (int i = 0; i < count; i++)
+        {
+            uint32_t allocs, frees, cached;
+
+            class_counts(&classes[i], &allocs, &frees, &cached);
+            stats->used_bytes += (size_t)(allocs - frees) * classes[i].block_size;
+            /*
+             * Measured at the shared slab, so blocks parked in magazines
+             * count; summed over classes for slab pools.
+             */
+            stats->peak_usage += (size_t)atomic_get(&classes[i].peak_blocks) *
+                                 classes[i].block_size;
+            stats->alloc_count += allocs;
+            stats->free_count += frees;
+            stats->alloc_failures += (uint32_t)atomic_get(&classes[i].failures);
+        }
+
+        stats->free_bytes = pool->total_size - stats->used_bytes;
+        return 0;
+    }
+
     k_mutex_lock(&pool->mutex, K_FOREVER);
 
     stats->total_bytes = pool->total_size;
@@ -343,17 +1221,128 @@ int akira_pool_free_count(akira_pool_t *pool)
         return -1;
     }
 
-    return k_mem_slab_num_free_get(&pool->fixed.slab);
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
+    int free_blocks = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        uint32_t allocs, frees, cached;
+
+        class_counts(&classes[i], &allocs, &frees, &cached);
+        free_blocks += k_mem_slab_num_free_get(&classes[i].slab) + cached;
+    }
+
+    return free_blocks;
+}
+
+int akira_pool_drain(akira_pool_t *pool)
+{
+    if (!pool || pool->type == AKIRA_POOL_VARIABLE)
+    {
+        return -1;
+    }
+
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
+    int drained = 0;
+
+    for (int i = 0; i < count; i++)
+    {
+        drained += class_drain(&classes[i]);
+    }
+
+    return drained;
+}
+
+int akira_pool_class_count(akira_pool_t *pool)
+{
+    if (!pool || pool->type == AKIRA_POOL_VARIABLE)
+    {
+        return -1;
+    }
+
+    int count;
+    pool_classes(pool, &count);
+    return count;
+}
+
+int akira_pool_class_stats(akira_pool_t *pool, int index,
+                           akira_slab_class_stats_t *stats)
+{
+    if (!pool || !stats || pool->type == AKIRA_POOL_VARIABLE)
+    {
+        return -1;
+    }
+
+    int count;
+    struct akira_slab_class *classes = pool_classes(pool, &count);
+
+    if (index < 0 || index >= count)
+    {
+        return -1;
+    }
+
+    struct akira_slab_class *cls = &classes[index];
+    uint32_t allocs, frees, cached;
+
+    class_counts(cls, &allocs, &frees, &cached);
+
+    stats->block_size = cls->block_size;
+    stats->total_blocks = (cls->end - cls->base) / cls->block_size;
+    stats->used_blocks = allocs - frees;
+    stats->peak_blocks = (uint32_t)atomic_get(&cls->peak_blocks);
+    stats->failures = (uint32_t)atomic_get(&cls->failures);
+
+    return 0;
 }
 
 /*===========================================================================*/
 /* System Heap Implementation                                                */
 /*===========================================================================*/
 
-void *akira_malloc(size_t size)
+static void *heap_raw_alloc(size_t size, size_t alignment)
+{
+    /* Aligned blocks are padded so the header sits right below the user pointer */
+    return alignment > 0 ? k_aligned_alloc(MAX(alignment, sizeof(void *)),
+                                           AKIRA_ALLOC_PAD(alignment) + size)
+                         : k_malloc(AKIRA_ALLOC_HDR_SIZE + size);
+}
+
+static void heap_check_pressure(void)
+{
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) && defined(CONFIG_HEAP_MEM_POOL_SIZE) && \
+    (CONFIG_HEAP_MEM_POOL_SIZE > 0)
+    extern struct k_heap _system_heap;
+    static uint8_t heap_pressure;
+    struct sys_memory_stats stats;
+
+    if (sys_heap_runtime_stats_get(&_system_heap.heap, &stats) == 0)
+    {
+        akira_reclaim_check(AKIRA_MEM_DOMAIN_HEAP, &heap_pressure, stats.free_bytes,
+                            stats.free_bytes + stats.allocated_bytes);
+    }
+#endif
+}
+
+/** Allocate from the system heap on behalf of a call site */
+static void *heap_alloc(size_t size, size_t alignment, const void *site)
 {
-    void *ptr = k_malloc(size);
-    if (ptr && mem_mgr.initialized)
+    void *raw = heap_raw_alloc(size, alignment);
+
+    /* Let caches give memory back before failing the caller */
+    if (!raw && akira_reclaim_on_failure(AKIRA_MEM_DOMAIN_HEAP, size))
+    {
+        raw = heap_raw_alloc(size, alignment);
+    }
+    if (!raw)
+    {
+        return NULL;
+    }
+    heap_check_pressure();
+
+    void *ptr = hdr_track(raw, size, alignment, site, AKIRA_MEMPROF_TAG_HEAP);
+    if (mem_mgr.initialized)
     {
         k_mutex_lock(&mem_mgr.mutex, K_FOREVER);
         mem_mgr.global_stats.alloc_count++;
@@ -367,10 +1356,15 @@ void *akira_malloc(size_t size)
     return ptr;
 }
 
+void *akira_malloc(size_t size)
+{
+    return heap_alloc(size, 0, CALL_SITE());
+}
+
 void *akira_calloc(size_t count, size_t size)
 {
     size_t total = count * size;
-    void *ptr = akira_malloc(total);
+    void *ptr = heap_alloc(total, 0, CALL_SITE());
     if (ptr)
     {
         memset(ptr, 0, total);
@@ -383,7 +1377,7 @@ void *akira_realloc(void *ptr, size_t size)
     /* Zephyr doesn't have realloc, so we implement a basic version */
     if (!ptr)
     {
-        return akira_malloc(size);
+        return heap_alloc(size, 0, CALL_SITE());
     }
 
     if (size == 0)
@@ -392,12 +1386,18 @@ void *akira_realloc(void *ptr, size_t size)
         return NULL;
     }
 
-    /* Simple implementation: allocate new, copy, free old */
-    void *new_ptr = akira_malloc(size);
+    const struct akira_alloc_hdr *hdr = (const struct akira_alloc_hdr *)ptr - 1;
+    if (hdr->magic != AKIRA_ALLOC_MAGIC)
+    {
+        LOG_ERR("Realloc of untracked block %p", ptr);
+        return NULL;
+    }
+
+    /* Allocate new, copy what fits, free old */
+    void *new_ptr = heap_alloc(size, 0, CALL_SITE());
     if (new_ptr)
     {
-        /* Note: We can't know the original size, caller must handle this */
-        memcpy(new_ptr, ptr, size);
+        memcpy(new_ptr, ptr, MIN(size, hdr->size));
         akira_free(ptr);
     }
     return new_ptr;
@@ -410,24 +1410,37 @@ void akira_free(void *ptr)
         return;
     }
 
+    size_t size;
+    void *raw = akira_memory_untrack(ptr, &size);
+    if (!raw)
+    {
+        return;
+    }
+
     if (mem_mgr.initialized)
     {
         k_mutex_lock(&mem_mgr.mutex, K_FOREVER);
         mem_mgr.global_stats.free_count++;
+        mem_mgr.global_stats.used_bytes -= size;
         k_mutex_unlock(&mem_mgr.mutex);
     }
 
-    k_free(ptr);
+    k_free(raw);
 }
 
 void *akira_aligned_alloc(size_t alignment, size_t size)
 {
-    return k_aligned_alloc(alignment, size);
+    if (!IS_POWER_OF_TWO(alignment))
+    {
+        return NULL;
+    }
+
+    return heap_alloc(size, alignment, CALL_SITE());
 }
 
 void akira_aligned_free(void *ptr)
 {
-    k_free(ptr);
+    akira_free(ptr);
 }
 
 /*===========================================================================*/
@@ -524,11 +1537,54 @@ int akira_memory_stats(akira_mem_stats_t *stats)
 
 size_t akira_memory_usage(akira_pid_t pid)
 {
-    /* TODO: Track per-process memory usage */
-    (void)pid;
+    int slot = acct_find(pid);
+    return slot >= 0 ? (size_t)atomic_get(&mem_accounts[slot].bytes) : 0;
+}
+
+int akira_memory_process_stats(akira_pid_t pid, akira_mem_stats_t *stats)
+{
+    int slot = acct_find(pid);
+    if (slot < 0 || !stats)
+    {
+        return -1;
+    }
+
+    struct akira_mem_account *a = &mem_accounts[slot];
+
+    memset(stats, 0, sizeof(*stats));
+    stats->used_bytes = atomic_get(&a->bytes);
+    stats->peak_usage = atomic_get(&a->peak);
+    stats->alloc_count = atomic_get(&a->allocs);
+    stats->free_count = atomic_get(&a->frees);
+
     return 0;
 }
 
+void akira_memory_release(akira_pid_t pid)
+{
+    if (pid == 0)
+    {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&acct_lock);
+    int slot = acct_find(pid);
+
+    if (slot > 0)
+    {
+        /* Stays DEAD (not EMPTY) so later PIDs' probe chains stay intact */
+        mem_accounts[slot].state = ACCT_DEAD;
+    }
+
+    k_spin_unlock(&acct_lock, key);
+
+    if (slot > 0 && atomic_get(&mem_accounts[slot].bytes) > 0)
+    {
+        LOG_WRN("PID %u exited holding %ld bytes", pid,
+                (long)atomic_get(&mem_accounts[slot].bytes));
+    }
+}
+
 int akira_memory_check_leaks(void)
 {
     int leaks = 0;
@@ -542,6 +1598,18 @@ int akira_memory_check_leaks(void)
         LOG_WRN("Detected %d potential memory leaks", leaks);
     }
 
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+    akira_memprof_site_t suspects[8];
+    int n = akira_memprof_check_leaks(suspects, ARRAY_SIZE(suspects));
+
+    for (int i = 0; i < MIN(n, (int)ARRAY_SIZE(suspects)); i++)
+    {
+        LOG_WRN("  Growing site %p (tag %u): %u bytes in %u blocks",
+                (void *)suspects[i].site, suspects[i].tag,
+                suspects[i].live_bytes, suspects[i].live_count);
+    }
+#endif
+
     return leaks;
 }
 
@@ -557,14 +1625,39 @@ void akira_memory_dump(void)
             mem_mgr.global_stats.free_count);
     LOG_INF("Pools: %d", mem_mgr.pool_count);
 
+    for (int i = 0; i < AKIRA_ACCT_SLOTS; i++)
+    {
+        struct akira_mem_account *a = &mem_accounts[i];
+
+        if (a->state != ACCT_EMPTY && (a->state == ACCT_LIVE || atomic_get(&a->bytes) > 0))
+        {
+            LOG_INF("  PID %u%s: %ld bytes (peak %ld)", a->pid,
+                    a->state == ACCT_DEAD ? " (exited)" : "",
+                    (long)atomic_get(&a->bytes), (long)atomic_get(&a->peak));
+        }
+    }
+
     for (int i = 0; i < AKIRA_MAX_MEMORY_POOLS; i++)
     {
         if (mem_mgr.pools[i].name)
         {
             LOG_INF("  Pool '%s': %zu/%zu bytes used",
                     mem_mgr.pools[i].name,
-                    mem_mgr.pools[i].used_bytes,
+                    pool_used_bytes(&mem_mgr.pools[i]),
                     mem_mgr.pools[i].total_size);
+
+            if (mem_mgr.pools[i].type == AKIRA_POOL_SLAB)
+            {
+                for (int c = 0; c < mem_mgr.pools[i].slab.num_classes; c++)
+                {
+                    akira_slab_class_stats_t cs;
+
+                    akira_pool_class_stats(&mem_mgr.pools[i], c, &cs);
+                    LOG_INF("    %4zu B: %u/%u used, peak %u, failed %u",
+                            cs.block_size, cs.used_blocks, cs.total_blocks,
+                            cs.peak_blocks, cs.failures);
+                }
+            }
         }
     }
 }
@@ -30,6 +30,38 @@ extern "C"
 /** Default pool block size */
 #define AKIRA_POOL_DEFAULT_BLOCK 64
 
+/** Blocks cached per CPU in front of each fixed-size pool (0 disables) */
+#ifndef CONFIG_AKIRA_POOL_MAGAZINE_SIZE
+#define CONFIG_AKIRA_POOL_MAGAZINE_SIZE 8
+#endif
+
+/** Maximum number of size classes in a slab pool */
+#ifndef CONFIG_AKIRA_SLAB_MAX_CLASSES
+#define CONFIG_AKIRA_SLAB_MAX_CLASSES 8
+#endif
+
+/** Per-process accounting slots (power of two, at most 128) */
+#ifndef CONFIG_AKIRA_MEM_ACCT_SLOTS
+#define CONFIG_AKIRA_MEM_ACCT_SLOTS 16
+#endif
+
+/** Bytes reserved in front of every heap allocation for its accounting header */
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+#define AKIRA_ALLOC_HDR_SIZE 16
+#else
+#define AKIRA_ALLOC_HDR_SIZE 8
+#endif
+
+/** Bytes to reserve in front of an allocation aligned to align */
+#define AKIRA_ALLOC_PAD(align) \
+    ((align) > AKIRA_ALLOC_HDR_SIZE ? (size_t)(align) : (size_t)AKIRA_ALLOC_HDR_SIZE)
+
+/** Smallest default slab size class */
+#define AKIRA_SLAB_MIN_CLASS 16
+
+/** Largest default slab size class when the pool gives no block size */
+#define AKIRA_SLAB_DEFAULT_MAX_CLASS 2048
+
 /*===========================================================================*/
 /* Memory Protection Flags                                                   */
 /*===========================================================================*/
@@ -68,15 +100,24 @@ extern "C"
     /* Memory Structures                                                         */
     /*===========================================================================*/
 
+    /** Slab pool size class */
+    typedef struct
+    {
+        size_t block_size;   /**< Block size of the class */
+        uint32_t num_blocks; /**< Number of blocks in the class */
+    } akira_slab_class_config_t;
+
     /** Memory pool configuration */
     typedef struct
     {
         const char *name;       /**< Pool name */
         akira_pool_type_t type; /**< Pool type */
         size_t total_size;      /**< Total pool size */
-        size_t block_size;      /**< Block size (for fixed pools) */
+        size_t block_size;      /**< Block size (fixed pools), largest class (slab pools) */
         void *buffer;           /**< Pre-allocated buffer (optional) */
         uint32_t flags;         /**< Memory flags */
+        const akira_slab_class_config_t *classes; /**< Slab size classes (optional) */
+        uint8_t num_classes;                      /**< Number of entries in classes */
     } akira_pool_config_t;
 
     /** Memory pool handle */
@@ -103,6 +144,16 @@ extern "C"
         uint32_t alloc_failures; /**< Allocation failures */
     } akira_mem_stats_t;
 
+    /** Occupancy of one slab size class */
+    typedef struct
+    {
+        size_t block_size;     /**< Block size of the class */
+        uint32_t total_blocks; /**< Blocks in the class */
+        uint32_t used_blocks;  /**< Blocks handed out */
+        uint32_t peak_blocks;  /**< Most blocks taken from the class at once */
+        uint32_t failures;     /**< Allocations that found no free block */
+    } akira_slab_class_stats_t;
+
     /*===========================================================================*/
     /* Memory Pool API                                                           */
     /*===========================================================================*/
@@ -115,6 +166,13 @@ extern "C"
 
     /**
      * @brief Create a memory pool
+     *
+     * Slab pools serve each request from the smallest size class that
+     * fits, falling back to larger classes when it is exhausted. Without
+     * explicit classes the pool gets power-of-two classes from
+     * AKIRA_SLAB_MIN_CLASS up to block_size, sharing total_size equally.
+     * With explicit classes total_size may be 0 to size the pool exactly.
+     *
      * @param config Pool configuration
      * @return Pool handle or NULL on error
      */
@@ -129,7 +187,7 @@ extern "C"
     /**
      * @brief Allocate from a pool
      * @param pool Pool to allocate from
-     * @param size Size to allocate (for variable pools)
+     * @param size Size to allocate (for variable and slab pools)
      * @return Allocated memory or NULL
      */
     void *akira_pool_alloc(akira_pool_t *pool, size_t size);
@@ -159,12 +217,44 @@ extern "C"
     int akira_pool_stats(akira_pool_t *pool, akira_mem_stats_t *stats);
 
     /**
-     * @brief Get pool free count (for fixed pools)
+     * @brief Get pool free count (fixed and slab pools)
+     *
+     * Includes blocks held in per-CPU magazines; slab pools count all classes.
+     *
      * @param pool Pool to query
      * @return Number of free blocks
      */
     int akira_pool_free_count(akira_pool_t *pool);
 
+    /**
+     * @brief Return blocks cached in per-CPU magazines to the pool
+     *
+     * Fixed-size pools keep up to CONFIG_AKIRA_POOL_MAGAZINE_SIZE free
+     * blocks per CPU so most alloc/free pairs never touch the shared
+     * slab. Draining makes those blocks available to every CPU again.
+     *
+     * @param pool Pool to drain
+     * @return Number of blocks returned, negative on error
+     */
+    int akira_pool_drain(akira_pool_t *pool);
+
+    /**
+     * @brief Get the number of size classes of a pool
+     * @param pool Pool to query
+     * @return Number of classes (1 for fixed pools), negative on error
+     */
+    int akira_pool_class_count(akira_pool_t *pool);
+
+    /**
+     * @brief Get occupancy of one size class
+     * @param pool Pool to query
+     * @param index Class index, smallest class first
+     * @param stats Output statistics
+     * @return 0 on success, negative on error
+     */
+    int akira_pool_class_stats(akira_pool_t *pool, int index,
+                               akira_slab_class_stats_t *stats);
+
     /*===========================================================================*/
     /* System Heap API                                                           */
     /*===========================================================================*/
@@ -267,11 +357,57 @@ extern "C"
 
     /**
      * @brief Get process memory usage
+     *
+     * Counts every live allocation made by the process through
+     * akira_malloc(), akira_pool_*() and akira_psram_*(). Allocations made
+     * outside any process are charged to PID 0.
+     *
      * @param pid Process ID
      * @return Memory usage in bytes
      */
     size_t akira_memory_usage(akira_pid_t pid);
 
+    /**
+     * @brief Get per-process allocation statistics
+     * @param pid Process ID
+     * @param stats Output statistics (total/free bytes are left 0)
+     * @return 0 on success, -1 if the process has no account
+     */
+    int akira_memory_process_stats(akira_pid_t pid, akira_mem_stats_t *stats);
+
+    /**
+     * @brief Retire the account of an exited process
+     *
+     * The account is recycled once all of its allocations are freed; until
+     * then its remaining bytes are still reported as leaked by the PID.
+     *
+     * @param pid Process ID
+     */
+    void akira_memory_release(akira_pid_t pid);
+
+    /**
+     * @brief Stamp an accounting header on a raw allocation
+     *
+     * For allocators outside this module (e.g. PSRAM). raw must have room
+     * for AKIRA_ALLOC_PAD(align) + size bytes and be aligned to align; the
+     * caller's process is charged.
+     *
+     * @param raw Start of the raw allocation
+     * @param size Size requested by the caller
+     * @param align Alignment of the user pointer (power of two, 0 for none)
+     * @param site Call site for the allocation profiler (NULL: the caller)
+     * @return Pointer to hand to the caller
+     */
+    void *akira_memory_track(void *raw, size_t size, size_t align, const void *site);
+
+    /**
+     * @brief Remove the accounting header of a tracked allocation
+     * @param ptr Pointer returned by akira_memory_track()
+     * @param size Output for the size originally requested (optional)
+     * @return Start of the raw allocation, NULL if ptr is not tracked
+     */
+    void *akira_memory_untrack(void *ptr, size_t *size);
+
     /**
      * @brief Check for memory leaks
      * @return Number of leaked allocations
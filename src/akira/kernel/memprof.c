@@ -0,0 +1,355 @@
+/**
+ * @file memprof.c
+ * @brief AkiraOS Allocation-Site Profiler Implementation
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include "memprof.h"
+#ifdef CONFIG_ARCH_POSIX
+#include "host_file.h"
+#endif
+
+LOG_MODULE_REGISTER(akira_memprof, CONFIG_AKIRA_LOG_LEVEL);
+
+/*===========================================================================*/
+/* Internal Structures                                                       */
+/*===========================================================================*/
+
+#define MEMPROF_SITES CONFIG_AKIRA_MEM_PROFILER_SITES
+
+BUILD_ASSERT(IS_POWER_OF_TWO(MEMPROF_SITES) && MEMPROF_SITES <= 65536,
+             "CONFIG_AKIRA_MEM_PROFILER_SITES must be a power of two <= 65536");
+
+struct memprof_entry
+{
+    uintptr_t site;
+    uint8_t tag;
+    bool used;
+    uint32_t live_bytes;
+    uint32_t live_count;
+    uint32_t peak_bytes;
+    uint32_t alloc_count;
+    uint32_t alloc_bytes;
+    uint32_t checked_bytes; /* live_bytes at the previous leak check */
+    uint32_t leak_streak;
+};
+
+/*===========================================================================*/
+/* Internal State                                                            */
+/*===========================================================================*/
+
+/* Slot 0 collects every site that found the table full */
+static struct
+{
+    struct memprof_entry sites[MEMPROF_SITES];
+    struct k_spinlock lock;
+    int64_t start_ms;
+} prof = {
+    .sites[0] = {.used = true},
+};
+
+#ifdef CONFIG_ARCH_POSIX
+/* Provided by memprof_host.c, which runs in the native_sim runner context */
+extern int akira_memprof_host_symbolize(uintptr_t addr, char *buf, size_t len);
+#endif
+
+/*===========================================================================*/
+/* Internal Functions                                                        */
+/*===========================================================================*/
+
+static uint32_t site_hash(uintptr_t site, uint8_t tag)
+{
+    /* Fibonacci hashing; code addresses are at least 2-byte aligned */
+    return (uint32_t)((site >> 1) ^ tag) * 2654435761u;
+}
+
+static uint16_t site_lookup(uintptr_t site, uint8_t tag)
+{
+    uint32_t h = site_hash(site, tag);
+
+    for (int n = 0; n < MEMPROF_SITES - 1; n++)
+    {
+        uint16_t i = 1 + (h + n) % (MEMPROF_SITES - 1);
+        struct memprof_entry *e = &prof.sites[i];
+
+        if (!e->used)
+        {
+            e->used = true;
+            e->site = site;
+            e->tag = tag;
+            return i;
+        }
+        if (e->site == site && e->tag == tag)
+        {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+static void entry_to_site(const struct memprof_entry *e, akira_memprof_site_t *out)
+{
+    out->site = e->site;
+    out->tag = e->tag;
+    out->live_bytes = e->live_bytes;
+    out->live_count = e->live_count;
+    out->peak_bytes = e->peak_bytes;
+    out->alloc_count = e->alloc_count;
+    out->alloc_bytes = e->alloc_bytes;
+    out->leak_streak = e->leak_streak;
+}
+
+/*===========================================================================*/
+/* Allocator Hooks                                                           */
+/*===========================================================================*/
+
+uint16_t akira_memprof_on_alloc(const void *site, uint8_t tag, size_t size)
+{
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    uint16_t index = site_lookup((uintptr_t)site, tag);
+    struct memprof_entry *e = &prof.sites[index];
+
+    e->live_bytes += size;
+    e->live_count++;
+    e->alloc_count++;
+    e->alloc_bytes += size;
+    if (e->live_bytes > e->peak_bytes)
+    {
+        e->peak_bytes = e->live_bytes;
+    }
+
+    k_spin_unlock(&prof.lock, key);
+
+    return index;
+}
+
+void akira_memprof_on_free(uint16_t index, size_t size)
+{
+    if (index >= MEMPROF_SITES)
+    {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    struct memprof_entry *e = &prof.sites[index];
+    e->live_bytes -= MIN(size, e->live_bytes);
+    if (e->live_count > 0)
+    {
+        e->live_count--;
+    }
+
+    k_spin_unlock(&prof.lock, key);
+}
+
+/*===========================================================================*/
+/* Reporting API                                                             */
+/*===========================================================================*/
+
+int akira_memprof_top(akira_memprof_site_t *out, int max)
+{
+    int count = 0;
+
+    if (!out || max <= 0)
+    {
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    /* Keep out[] sorted, inserting each site that beats the smallest */
+    for (int i = 0; i < MEMPROF_SITES; i++)
+    {
+        const struct memprof_entry *e = &prof.sites[i];
+
+        if (!e->used || e->alloc_count == 0)
+        {
+            continue;
+        }
+        if (count == max && e->live_bytes <= out[max - 1].live_bytes)
+        {
+            continue;
+        }
+
+        int pos = count < max ? count++ : max - 1;
+        while (pos > 0 && out[pos - 1].live_bytes < e->live_bytes)
+        {
+            out[pos] = out[pos - 1];
+            pos--;
+        }
+        entry_to_site(e, &out[pos]);
+    }
+
+    k_spin_unlock(&prof.lock, key);
+
+    return count;
+}
+
+int akira_memprof_check_leaks(akira_memprof_site_t *out, int max)
+{
+    int suspects = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    for (int i = 0; i < MEMPROF_SITES; i++)
+    {
+        struct memprof_entry *e = &prof.sites[i];
+
+        if (!e->used)
+        {
+            continue;
+        }
+
+        e->leak_streak = e->live_bytes > e->checked_bytes ? e->leak_streak + 1 : 0;
+        e->checked_bytes = e->live_bytes;
+
+        if (e->leak_streak >= AKIRA_MEMPROF_LEAK_STREAK)
+        {
+            if (out && suspects < max)
+            {
+                entry_to_site(e, &out[suspects]);
+            }
+            suspects++;
+        }
+    }
+
+    k_spin_unlock(&prof.lock, key);
+
+    return suspects;
+}
+
+uint32_t akira_memprof_elapsed_ms(void)
+{
+    return (uint32_t)(k_uptime_get() - prof.start_ms);
+}
+
+void akira_memprof_reset(void)
+{
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    for (int i = 0; i < MEMPROF_SITES; i++)
+    {
+        struct memprof_entry *e = &prof.sites[i];
+
+        e->peak_bytes = e->live_bytes;
+        e->alloc_count = 0;
+        e->alloc_bytes = 0;
+        e->checked_bytes = e->live_bytes;
+        e->leak_streak = 0;
+    }
+    prof.start_ms = k_uptime_get();
+
+    k_spin_unlock(&prof.lock, key);
+}
+
+size_t akira_memprof_dump_size(void)
+{
+    int count = 0;
+
+    for (int i = 0; i < MEMPROF_SITES; i++)
+    {
+        if (prof.sites[i].used)
+        {
+            count++;
+        }
+    }
+
+    return AKIRA_MEMPROF_DUMP_HDR_SIZE + count * AKIRA_MEMPROF_DUMP_REC_SIZE;
+}
+
+int akira_memprof_dump(uint8_t *buf, size_t len)
+{
+    if (!buf || len < AKIRA_MEMPROF_DUMP_HDR_SIZE)
+    {
+        return -ENOMEM;
+    }
+
+    uint8_t *p = buf + AKIRA_MEMPROF_DUMP_HDR_SIZE;
+    uint16_t count = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&prof.lock);
+
+    for (int i = 0; i < MEMPROF_SITES; i++)
+    {
+        const struct memprof_entry *e = &prof.sites[i];
+
+        if (!e->used)
+        {
+            continue;
+        }
+        if (p + AKIRA_MEMPROF_DUMP_REC_SIZE > buf + len)
+        {
+            k_spin_unlock(&prof.lock, key);
+            return -ENOMEM;
+        }
+
+        sys_put_le64((uint64_t)e->site, p);
+        sys_put_le32(e->live_bytes, p + 8);
+        sys_put_le32(e->live_count, p + 12);
+        sys_put_le32(e->peak_bytes, p + 16);
+        sys_put_le32(e->alloc_count, p + 20);
+        sys_put_le32(e->alloc_bytes, p + 24);
+        p[28] = e->tag;
+        p[29] = 0;
+        p[30] = 0;
+        p[31] = 0;
+
+        p += AKIRA_MEMPROF_DUMP_REC_SIZE;
+        count++;
+    }
+
+    k_spin_unlock(&prof.lock, key);
+
+    memcpy(buf, AKIRA_MEMPROF_DUMP_MAGIC, 4);
+    sys_put_le16(AKIRA_MEMPROF_DUMP_VERSION, buf + 4);
+    sys_put_le16(count, buf + 6);
+    sys_put_le32(akira_memprof_elapsed_ms(), buf + 8);
+    buf[12] = sizeof(uintptr_t);
+    buf[13] = 0;
+    buf[14] = 0;
+    buf[15] = 0;
+
+    return p - buf;
+}
+
+int akira_memprof_symbolize(uintptr_t site, char *buf, size_t len)
+{
+#ifdef CONFIG_ARCH_POSIX
+    return akira_memprof_host_symbolize(site, buf, len);
+#else
+    ARG_UNUSED(site);
+    ARG_UNUSED(buf);
+    ARG_UNUSED(len);
+    return -ENOTSUP;
+#endif
+}
+
+int akira_memprof_save(const char *path)
+{
+#ifdef CONFIG_ARCH_POSIX
+    /* Sites can appear while we allocate, so leave room for a few more */
+    size_t len = akira_memprof_dump_size() + 8 * AKIRA_MEMPROF_DUMP_REC_SIZE;
+    uint8_t *buf = k_malloc(len);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    int ret = akira_memprof_dump(buf, len);
+    if (ret > 0)
+    {
+        ret = akira_host_write_file(path, buf, ret);
+    }
+
+    k_free(buf);
+    return ret;
+#else
+    ARG_UNUSED(path);
+    return -ENOTSUP;
+#endif
+}
@@ -0,0 +1,158 @@
+/**
+ * @file memprof.h
+ * @brief AkiraOS Allocation-Site Profiler
+ *
+ * Opt-in (CONFIG_AKIRA_MEM_PROFILER) bookkeeping of every Akira heap,
+ * pool and PSRAM allocation by call site. Each site is the return address
+ * of the public allocation call plus a tag naming the allocator, kept in a
+ * fixed-size hash table so live bytes, allocation rate and peak usage can
+ * be reported per site during long soak runs.
+ */
+
+#ifndef AKIRA_KERNEL_MEMPROF_H
+#define AKIRA_KERNEL_MEMPROF_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/** Number of tracked sites (power of two); extra sites share slot 0 */
+#ifndef CONFIG_AKIRA_MEM_PROFILER_SITES
+#define CONFIG_AKIRA_MEM_PROFILER_SITES 256
+#endif
+
+/** Checks in a row a site must grow before it is reported as a leak */
+#define AKIRA_MEMPROF_LEAK_STREAK 3
+
+/** Site tags */
+#define AKIRA_MEMPROF_TAG_HEAP 0        /**< akira_malloc() and friends */
+#define AKIRA_MEMPROF_TAG_EXT 1         /**< akira_memory_track() users (PSRAM) */
+#define AKIRA_MEMPROF_TAG_POOL(i) (2 + (i)) /**< akira_pool_*() on pool slot i */
+
+/** Binary dump format */
+#define AKIRA_MEMPROF_DUMP_MAGIC "AMPF"
+#define AKIRA_MEMPROF_DUMP_VERSION 1
+#define AKIRA_MEMPROF_DUMP_HDR_SIZE 16
+#define AKIRA_MEMPROF_DUMP_REC_SIZE 32
+
+    /*===========================================================================*/
+    /* Types                                                                     */
+    /*===========================================================================*/
+
+    /** Counters of one allocation site */
+    typedef struct
+    {
+        uintptr_t site;       /**< Return address of the allocation call (0: overflow) */
+        uint8_t tag;          /**< Allocator tag */
+        uint32_t live_bytes;  /**< Bytes currently allocated */
+        uint32_t live_count;  /**< Allocations currently live */
+        uint32_t peak_bytes;  /**< Highest live_bytes since reset */
+        uint32_t alloc_count; /**< Allocations since reset */
+        uint32_t alloc_bytes; /**< Bytes allocated since reset */
+        uint32_t leak_streak; /**< Consecutive leak checks with growth */
+    } akira_memprof_site_t;
+
+    /*===========================================================================*/
+    /* Allocator Hooks                                                           */
+    /*===========================================================================*/
+
+    /**
+     * @brief Record an allocation
+     * @param site Return address of the public allocation call
+     * @param tag Allocator tag
+     * @param size Bytes allocated
+     * @return Site index to hand back to akira_memprof_on_free()
+     */
+    uint16_t akira_memprof_on_alloc(const void *site, uint8_t tag, size_t size);
+
+    /**
+     * @brief Record a free
+     * @param index Index returned by akira_memprof_on_alloc()
+     * @param size Bytes freed
+     */
+    void akira_memprof_on_free(uint16_t index, size_t size);
+
+    /*===========================================================================*/
+    /* Reporting API                                                             */
+    /*===========================================================================*/
+
+    /**
+     * @brief Get the sites holding the most live bytes
+     * @param out Output array, sorted by live bytes (largest first)
+     * @param max Capacity of out
+     * @return Number of sites written
+     */
+    int akira_memprof_top(akira_memprof_site_t *out, int max);
+
+    /**
+     * @brief Compare live bytes per site with the previous check
+     *
+     * Meant to be called periodically during a soak test. Sites whose
+     * live bytes grew on AKIRA_MEMPROF_LEAK_STREAK checks in a row are
+     * reported as suspected leaks.
+     *
+     * @param out Output array for suspects (may be NULL)
+     * @param max Capacity of out
+     * @return Number of suspected sites
+     */
+    int akira_memprof_check_leaks(akira_memprof_site_t *out, int max);
+
+    /**
+     * @brief Milliseconds covered by the rate counters
+     */
+    uint32_t akira_memprof_elapsed_ms(void);
+
+    /**
+     * @brief Restart rate, peak and leak counters
+     *
+     * Live counters are kept, since their allocations are still around.
+     */
+    void akira_memprof_reset(void);
+
+    /**
+     * @brief Size of a binary dump of the current table
+     */
+    size_t akira_memprof_dump_size(void);
+
+    /**
+     * @brief Serialize the site table
+     *
+     * Little-endian: a 16-byte header ("AMPF", version, site count,
+     * elapsed ms, pointer size) followed by one 32-byte record per site.
+     * Decoded on the host by tools/akira_memprof.py.
+     *
+     * @param buf Output buffer
+     * @param len Buffer size
+     * @return Bytes written, -ENOMEM if buf is too small
+     */
+    int akira_memprof_dump(uint8_t *buf, size_t len);
+
+    /**
+     * @brief Resolve a site to a symbol name (native_sim only)
+     * @param site Site address
+     * @param buf Output for "symbol+0xoff"
+     * @param len Buffer size
+     * @return 0 on success, -ENOTSUP or -ENOENT otherwise
+     */
+    int akira_memprof_symbolize(uintptr_t site, char *buf, size_t len);
+
+    /**
+     * @brief Write a binary dump to a file on the host (native_sim only)
+     * @param path Host file path
+     * @return 0 on success, negative on error
+     */
+    int akira_memprof_save(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_KERNEL_MEMPROF_H */
@@ -0,0 +1,30 @@
+/**
+ * @file memprof_host.c
+ * @brief Host-side helpers for the allocation profiler on native_sim
+ *
+ * Built into the native_sim runner, so it can use the host C library's
+ * dladdr() for best-effort symbol names. Dumps are saved through
+ * host_file.c.
+ * Symbols that are not exported resolve to the nearest exported one;
+ * tools/akira_memprof.py with --elf gives exact function and line.
+ */
+
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+
+int akira_memprof_host_symbolize(uintptr_t addr, char *buf, size_t len)
+{
+    Dl_info info;
+
+    if (!dladdr((void *)addr, &info) || !info.dli_sname)
+    {
+        return -ENOENT;
+    }
+
+    snprintf(buf, len, "%s+0x%lx", info.dli_sname,
+             (unsigned long)(addr - (uintptr_t)info.dli_saddr));
+    return 0;
+}
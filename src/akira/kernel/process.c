@@ -7,6 +7,7 @@
 #include <zephyr/logging/log.h>
 #include <string.h>
 #include "process.h"
+#include "memory.h"
 
 LOG_MODULE_REGISTER(akira_process, CONFIG_AKIRA_LOG_LEVEL);
 
@@ -468,8 +469,32 @@ akira_process_t *akira_process_find(const char *name)
 
 akira_pid_t akira_process_current(void)
 {
-    /* TODO: Map Zephyr thread to process */
-    return 0;
+    /*
+     * Called on every allocation. Only native processes own a thread and
+     * it is embedded in their slot, so the slot follows from the thread's
+     * address without a scan or the lock; any other thread is the kernel.
+     */
+    uintptr_t self = (uintptr_t)k_current_get();
+    uintptr_t first = (uintptr_t)&proc_mgr.slots[0].thread;
+
+    if (self < first)
+    {
+        return 0;
+    }
+
+    size_t idx = (self - first) / sizeof(process_slot_t);
+    if (idx >= AKIRA_MAX_PROCESSES ||
+        (uintptr_t)&proc_mgr.slots[idx].thread != self)
+    {
+        return 0;
+    }
+
+    process_slot_t *slot = &proc_mgr.slots[idx];
+    if (!slot->in_use || slot->proc.type != AKIRA_PROCESS_NATIVE)
+    {
+        return 0;
+    }
+    return slot->proc.pid;
 }
 
 akira_process_state_t akira_process_get_state(akira_pid_t pid)
@@ -551,6 +576,7 @@ int akira_process_cleanup(void)
                     proc_mgr.slots[i].proc.name,
                     proc_mgr.slots[i].proc.pid);
 
+            akira_memory_release(proc_mgr.slots[i].proc.pid);
             proc_mgr.slots[i].in_use = false;
             proc_mgr.process_count--;
             cleaned++;
@@ -584,15 +610,14 @@ void akira_process_print_table(void)
                     type_names[p->type],
                     state_names[p->state],
                     p->priority,
-                    p->memory_usage);
+                    (uint32_t)akira_memory_usage(p->pid));
         }
     }
 }
 
 uint32_t akira_process_memory_usage(akira_pid_t pid)
 {
-    akira_process_t *proc = akira_process_get(pid);
-    return proc ? proc->memory_usage : 0;
+    return akira_process_get(pid) ? (uint32_t)akira_memory_usage(pid) : 0;
 }
 
 uint32_t akira_process_cpu_time(akira_pid_t pid)
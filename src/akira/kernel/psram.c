@@ -11,6 +11,7 @@
 #include <string.h>
 #include "psram.h"
 #include "memory.h"
+#include "reclaim.h"
 
 LOG_MODULE_REGISTER(akira_psram, CONFIG_AKIRA_LOG_LEVEL);
 
@@ -24,6 +25,14 @@ LOG_MODULE_REGISTER(akira_psram, CONFIG_AKIRA_LOG_LEVEL);
 /* ESP32-S3 PSRAM address range (memory-mapped) */
 #define ESP32S3_PSRAM_START 0x3C000000
 #define ESP32S3_PSRAM_END 0x3DFFFFFF
+#define PSRAM_HAS_BACKEND 1
+#elif defined(CONFIG_AKIRA_PSRAM_EMULATE)
+/* Emulated slow tier: a separate heap plus injected access latency */
+#define PSRAM_EMU_SIZE (CONFIG_AKIRA_PSRAM_EMULATE_SIZE * 1024)
+#define PSRAM_EMU_LINE 32
+static char __aligned(16) psram_emu_buf[PSRAM_EMU_SIZE];
+static struct k_heap psram_emu_heap;
+#define PSRAM_HAS_BACKEND 1
 #endif
 
 /*===========================================================================*/
@@ -43,6 +52,13 @@ static struct
     uint32_t alloc_count;
     uint32_t free_count;
     uint32_t alloc_failures;
+    uint8_t pressure; /* Last akira_mem_pressure_t seen by the watermarks */
+
+    /* Tier placement statistics */
+    akira_tier_stats_t tiers;
+#ifdef CONFIG_AKIRA_PSRAM_EMULATE
+    uint32_t stall_carry_ns;
+#endif
 } psram_state = {
     .initialized = false,
     .available = false,
@@ -66,6 +82,12 @@ static void psram_init_once(void)
     psram_state.available = true;
     psram_state.total_size = CONFIG_ESP_SPIRAM_HEAP_SIZE;
     LOG_INF("PSRAM initialized: %zu bytes available", psram_state.total_size);
+#elif defined(CONFIG_AKIRA_PSRAM_EMULATE)
+    k_heap_init(&psram_emu_heap, psram_emu_buf, PSRAM_EMU_SIZE);
+    psram_state.available = true;
+    psram_state.total_size = PSRAM_EMU_SIZE;
+    LOG_INF("PSRAM emulated: %zu bytes, %d ns per %d-byte access",
+            psram_state.total_size, CONFIG_AKIRA_PSRAM_EMULATE_LATENCY_NS, PSRAM_EMU_LINE);
 #else
     psram_state.available = false;
     psram_state.total_size = 0;
@@ -75,6 +97,69 @@ static void psram_init_once(void)
     psram_state.initialized = true;
 }
 
+#ifdef PSRAM_HAS_BACKEND
+static void *psram_raw_alloc(size_t alignment, size_t bytes)
+{
+#if defined(CONFIG_ESP_SPIRAM)
+    return alignment ? shared_multi_heap_aligned_alloc(SMH_REG_ATTR_EXTERNAL, alignment, bytes)
+                     : shared_multi_heap_alloc(SMH_REG_ATTR_EXTERNAL, bytes);
+#else
+    return k_heap_aligned_alloc(&psram_emu_heap, MAX(alignment, sizeof(void *)), bytes,
+                                K_NO_WAIT);
+#endif
+}
+
+static void psram_raw_free(void *raw)
+{
+#if defined(CONFIG_ESP_SPIRAM)
+    shared_multi_heap_free(raw);
+#else
+    k_heap_free(&psram_emu_heap, raw);
+#endif
+}
+
+static void *psram_alloc_at(size_t alignment, size_t size, const void *site)
+{
+    void *ptr = psram_raw_alloc(alignment, AKIRA_ALLOC_PAD(alignment) + size);
+
+    /* Let caches give memory back before failing the caller */
+    if (!ptr && akira_reclaim_on_failure(AKIRA_MEM_DOMAIN_PSRAM, size))
+    {
+        ptr = psram_raw_alloc(alignment, AKIRA_ALLOC_PAD(alignment) + size);
+    }
+
+    if (ptr)
+    {
+        ptr = akira_memory_track(ptr, size, alignment, site);
+
+        k_mutex_lock(&psram_state.mutex, K_FOREVER);
+        psram_state.used_bytes += size;
+        psram_state.alloc_count++;
+        if (psram_state.used_bytes > psram_state.peak_usage)
+        {
+            psram_state.peak_usage = psram_state.used_bytes;
+        }
+        size_t free_bytes = psram_state.total_size - MIN(psram_state.used_bytes,
+                                                         psram_state.total_size);
+        akira_reclaim_check(AKIRA_MEM_DOMAIN_PSRAM, &psram_state.pressure, free_bytes,
+                            psram_state.total_size);
+        k_mutex_unlock(&psram_state.mutex);
+
+        LOG_DBG("PSRAM alloc: %zu bytes (align=%zu) at %p", size, alignment, ptr);
+    }
+    else
+    {
+        k_mutex_lock(&psram_state.mutex, K_FOREVER);
+        psram_state.alloc_failures++;
+        k_mutex_unlock(&psram_state.mutex);
+
+        LOG_WRN("PSRAM alloc failed: %zu bytes", size);
+    }
+
+    return ptr;
+}
+#endif /* PSRAM_HAS_BACKEND */
+
 /*===========================================================================*/
 /* Public API                                                                */
 /*===========================================================================*/
@@ -116,32 +201,8 @@ void *akira_psram_alloc(size_t size)
         return NULL;
     }
 
-#if defined(CONFIG_ESP_SPIRAM)
-    void *ptr = shared_multi_heap_alloc(SMH_REG_ATTR_EXTERNAL, size);
-
-    if (ptr)
-    {
-        k_mutex_lock(&psram_state.mutex, K_FOREVER);
-        psram_state.used_bytes += size;
-        psram_state.alloc_count++;
-        if (psram_state.used_bytes > psram_state.peak_usage)
-        {
-            psram_state.peak_usage = psram_state.used_bytes;
-        }
-        k_mutex_unlock(&psram_state.mutex);
-
-        LOG_DBG("PSRAM alloc: %zu bytes at %p", size, ptr);
-    }
-    else
-    {
-        k_mutex_lock(&psram_state.mutex, K_FOREVER);
-        psram_state.alloc_failures++;
-        k_mutex_unlock(&psram_state.mutex);
-
-        LOG_WRN("PSRAM alloc failed: %zu bytes", size);
-    }
-
-    return ptr;
+#ifdef PSRAM_HAS_BACKEND
+    return psram_alloc_at(0, size, __builtin_return_address(0));
 #else
     /* Fallback to regular malloc if no PSRAM */
     return akira_malloc(size);
@@ -157,32 +218,8 @@ void *akira_psram_aligned_alloc(size_t alignment, size_t size)
         return NULL;
     }
 
-#if defined(CONFIG_ESP_SPIRAM)
-    void *ptr = shared_multi_heap_aligned_alloc(SMH_REG_ATTR_EXTERNAL, alignment, size);
-
-    if (ptr)
-    {
-        k_mutex_lock(&psram_state.mutex, K_FOREVER);
-        psram_state.used_bytes += size;
-        psram_state.alloc_count++;
-        if (psram_state.used_bytes > psram_state.peak_usage)
-        {
-            psram_state.peak_usage = psram_state.used_bytes;
-        }
-        k_mutex_unlock(&psram_state.mutex);
-
-        LOG_DBG("PSRAM aligned alloc: %zu bytes (align=%zu) at %p", size, alignment, ptr);
-    }
-    else
-    {
-        k_mutex_lock(&psram_state.mutex, K_FOREVER);
-        psram_state.alloc_failures++;
-        k_mutex_unlock(&psram_state.mutex);
-
-        LOG_WRN("PSRAM aligned alloc failed: %zu bytes", size);
-    }
-
-    return ptr;
+#ifdef PSRAM_HAS_BACKEND
+    return psram_alloc_at(alignment, size, __builtin_return_address(0));
 #else
     return akira_aligned_alloc(alignment, size);
 #endif
@@ -208,14 +245,21 @@ void akira_psram_free(void *ptr)
         return;
     }
 
-#if defined(CONFIG_ESP_SPIRAM)
+#ifdef PSRAM_HAS_BACKEND
     if (akira_psram_ptr_is_psram(ptr))
     {
-        shared_multi_heap_free(ptr);
+        size_t size;
+        void *raw = akira_memory_untrack(ptr, &size);
+
+        if (!raw)
+        {
+            return;
+        }
+        psram_raw_free(raw);
 
         k_mutex_lock(&psram_state.mutex, K_FOREVER);
         psram_state.free_count++;
-        /* Note: We can't track exact freed size with shared_multi_heap */
+        psram_state.used_bytes -= size;
         k_mutex_unlock(&psram_state.mutex);
 
         LOG_DBG("PSRAM free: %p", ptr);
@@ -235,6 +279,9 @@ bool akira_psram_ptr_is_psram(const void *ptr)
 #if defined(CONFIG_ESP_SPIRAM) && defined(CONFIG_SOC_SERIES_ESP32S3)
     uintptr_t addr = (uintptr_t)ptr;
     return (addr >= ESP32S3_PSRAM_START && addr <= ESP32S3_PSRAM_END);
+#elif defined(CONFIG_AKIRA_PSRAM_EMULATE) && !defined(CONFIG_ESP_SPIRAM)
+    return (const char *)ptr >= psram_emu_buf &&
+           (const char *)ptr < psram_emu_buf + PSRAM_EMU_SIZE;
 #else
     (void)ptr;
     return false;
@@ -293,6 +340,14 @@ void akira_psram_dump_stats(void)
         LOG_INF("Allocs: %u, Frees: %u, Failures: %u",
                 stats.alloc_count, stats.free_count, stats.alloc_failures);
     }
+
+    akira_tier_stats_t tiers;
+    akira_tier_get_stats(&tiers);
+    LOG_INF("Tiers: SRAM %zu bytes, PSRAM %zu bytes live",
+            tiers.live_bytes[AKIRA_MEM_TIER_SRAM], tiers.live_bytes[AKIRA_MEM_TIER_PSRAM]);
+    LOG_INF("Fallbacks: %u, Failures: %u, Misplaced: %u (%zu bytes), Rebalanced: %u",
+            tiers.fallbacks, tiers.failures, tiers.misplaced_count,
+            tiers.misplaced_bytes, tiers.rebalanced);
 }
 
 /*===========================================================================*/
@@ -350,3 +405,251 @@ void akira_psram_pool_destroy(void *pool)
     /* The pool will free its buffer when destroyed */
     akira_pool_destroy((akira_pool_t *)pool);
 }
+
+/*===========================================================================*/
+/* Tiered Allocation API                                                     */
+/*===========================================================================*/
+
+/* Prefix in front of tiered allocations so frees know hint and tier */
+struct tier_prefix
+{
+    uint32_t size;
+    uint8_t hint;
+    uint8_t tier;
+    uint8_t reserved[2];
+};
+
+BUILD_ASSERT(sizeof(struct tier_prefix) == 8);
+
+static akira_mem_tier_t tier_preferred(size_t size, akira_mem_hint_t hint)
+{
+    switch (hint)
+    {
+    case AKIRA_MEM_HINT_COLD:
+        return AKIRA_MEM_TIER_PSRAM;
+    case AKIRA_MEM_HINT_STREAMING:
+        return size >= CONFIG_AKIRA_TIER_STREAM_THRESHOLD ? AKIRA_MEM_TIER_PSRAM
+                                                          : AKIRA_MEM_TIER_SRAM;
+    case AKIRA_MEM_HINT_HOT:
+    case AKIRA_MEM_HINT_DMA:
+    default:
+        return AKIRA_MEM_TIER_SRAM;
+    }
+}
+
+static void *tier_raw_alloc(akira_mem_tier_t tier, size_t bytes, const void *site)
+{
+    if (tier == AKIRA_MEM_TIER_SRAM)
+    {
+        /* akira_malloc() is the internal heap; report the tiered caller */
+        void *raw = k_malloc(AKIRA_ALLOC_HDR_SIZE + bytes);
+        return raw ? akira_memory_track(raw, bytes, 0, site) : NULL;
+    }
+
+#ifdef PSRAM_HAS_BACKEND
+    if (psram_state.available)
+    {
+        return psram_alloc_at(0, bytes, site);
+    }
+#endif
+    return NULL;
+}
+
+static void tier_raw_free(akira_mem_tier_t tier, void *ptr)
+{
+    if (tier == AKIRA_MEM_TIER_SRAM)
+    {
+        void *raw = akira_memory_untrack(ptr, NULL);
+        if (raw)
+        {
+            k_free(raw);
+        }
+        return;
+    }
+
+    akira_psram_free(ptr);
+}
+
+static void *tier_alloc_at(size_t size, akira_mem_hint_t hint, const void *site)
+{
+    if (size == 0 || hint >= AKIRA_MEM_HINT_COUNT)
+    {
+        return NULL;
+    }
+
+    psram_init_once();
+
+    akira_mem_tier_t want = tier_preferred(size, hint);
+    akira_mem_tier_t tier = want;
+    struct tier_prefix *pre = tier_raw_alloc(tier, sizeof(*pre) + size, site);
+
+    /* DMA buffers must stay in internal RAM; everything else may spill */
+    if (!pre && hint != AKIRA_MEM_HINT_DMA)
+    {
+        tier = want == AKIRA_MEM_TIER_SRAM ? AKIRA_MEM_TIER_PSRAM : AKIRA_MEM_TIER_SRAM;
+        pre = tier_raw_alloc(tier, sizeof(*pre) + size, site);
+    }
+
+    k_mutex_lock(&psram_state.mutex, K_FOREVER);
+    if (pre)
+    {
+        psram_state.tiers.placed[hint][tier]++;
+        psram_state.tiers.live_bytes[tier] += size;
+        if (tier != want)
+        {
+            psram_state.tiers.fallbacks++;
+            psram_state.tiers.misplaced_bytes += size;
+            psram_state.tiers.misplaced_count++;
+        }
+    }
+    else
+    {
+        psram_state.tiers.failures++;
+    }
+    k_mutex_unlock(&psram_state.mutex);
+
+    if (!pre)
+    {
+        return NULL;
+    }
+
+    pre->size = size;
+    pre->hint = hint;
+    pre->tier = tier;
+    return pre + 1;
+}
+
+void *akira_tier_alloc(size_t size, akira_mem_hint_t hint)
+{
+    return tier_alloc_at(size, hint, __builtin_return_address(0));
+}
+
+void *akira_tier_calloc(size_t count, size_t size, akira_mem_hint_t hint)
+{
+    size_t total = count * size;
+    void *ptr = tier_alloc_at(total, hint, __builtin_return_address(0));
+
+    if (ptr)
+    {
+        memset(ptr, 0, total);
+    }
+
+    return ptr;
+}
+
+void akira_tier_free(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+
+    struct tier_prefix *pre = (struct tier_prefix *)ptr - 1;
+    akira_mem_tier_t tier = pre->tier;
+
+    k_mutex_lock(&psram_state.mutex, K_FOREVER);
+    psram_state.tiers.live_bytes[tier] -= pre->size;
+    if (tier != tier_preferred(pre->size, pre->hint))
+    {
+        psram_state.tiers.misplaced_bytes -= pre->size;
+        psram_state.tiers.misplaced_count--;
+    }
+    k_mutex_unlock(&psram_state.mutex);
+
+    tier_raw_free(tier, pre);
+}
+
+akira_mem_tier_t akira_tier_of(const void *ptr)
+{
+    return akira_psram_ptr_is_psram(ptr) ? AKIRA_MEM_TIER_PSRAM : AKIRA_MEM_TIER_SRAM;
+}
+
+void *akira_tier_rebalance(void *ptr)
+{
+    if (!ptr)
+    {
+        return NULL;
+    }
+
+    struct tier_prefix *pre = (struct tier_prefix *)ptr - 1;
+    akira_mem_tier_t want = tier_preferred(pre->size, pre->hint);
+
+    if (pre->tier == want)
+    {
+        return ptr;
+    }
+
+    struct tier_prefix *moved = tier_raw_alloc(want, sizeof(*moved) + pre->size,
+                                               __builtin_return_address(0));
+    if (!moved)
+    {
+        return ptr; /* Preferred tier still full, stay put */
+    }
+
+    akira_tier_access(ptr, pre->size);
+    memcpy(moved, pre, sizeof(*pre) + pre->size);
+    moved->tier = want;
+
+    k_mutex_lock(&psram_state.mutex, K_FOREVER);
+    psram_state.tiers.live_bytes[pre->tier] -= pre->size;
+    psram_state.tiers.live_bytes[want] += pre->size;
+    psram_state.tiers.misplaced_bytes -= pre->size;
+    psram_state.tiers.misplaced_count--;
+    psram_state.tiers.rebalanced++;
+    k_mutex_unlock(&psram_state.mutex);
+
+    tier_raw_free(pre->tier, pre);
+    return moved + 1;
+}
+
+void akira_tier_access(const void *ptr, size_t len)
+{
+#if defined(CONFIG_AKIRA_PSRAM_EMULATE) && !defined(CONFIG_ESP_SPIRAM)
+    if (CONFIG_AKIRA_PSRAM_EMULATE_LATENCY_NS == 0 || !akira_psram_ptr_is_psram(ptr))
+    {
+        return;
+    }
+
+    uint32_t lines = DIV_ROUND_UP(len, PSRAM_EMU_LINE);
+    uint64_t ns = (uint64_t)lines * CONFIG_AKIRA_PSRAM_EMULATE_LATENCY_NS;
+
+    /* k_busy_wait() has microsecond resolution; carry the remainder */
+    k_mutex_lock(&psram_state.mutex, K_FOREVER);
+    psram_state.tiers.stall_ns += ns;
+    ns += psram_state.stall_carry_ns;
+    psram_state.stall_carry_ns = ns % 1000;
+    k_mutex_unlock(&psram_state.mutex);
+
+    if (ns >= 1000)
+    {
+        k_busy_wait(ns / 1000);
+    }
+#else
+    /* Real PSRAM is slow on its own */
+    ARG_UNUSED(ptr);
+    ARG_UNUSED(len);
+#endif
+}
+
+void *akira_tier_memcpy(void *dst, const void *src, size_t len)
+{
+    akira_tier_access(src, len);
+    akira_tier_access(dst, len);
+    return memcpy(dst, src, len);
+}
+
+int akira_tier_get_stats(akira_tier_stats_t *stats)
+{
+    if (!stats)
+    {
+        return -EINVAL;
+    }
+
+    psram_init_once();
+
+    k_mutex_lock(&psram_state.mutex, K_FOREVER);
+    *stats = psram_state.tiers;
+    k_mutex_unlock(&psram_state.mutex);
+
+    return 0;
+}
@@ -6,7 +6,10 @@
  * on ESP32-S3 N16R8 modules (8MB OPI PSRAM).
  *
  * Uses Zephyr's shared_multi_heap to manage PSRAM allocations with
- * SMH_REG_ATTR_EXTERNAL attribute.
+ * SMH_REG_ATTR_EXTERNAL attribute. With CONFIG_AKIRA_PSRAM_EMULATE
+ * (native_sim) a separate heap stands in for PSRAM and accesses through
+ * akira_tier_access() pay an injected latency, so placement decisions can
+ * be measured off-target.
  */
 
 #ifndef AKIRA_KERNEL_PSRAM_H
@@ -35,6 +38,16 @@ extern "C"
 #define AKIRA_PSRAM_HEAP_SIZE (4 * 1024 * 1024)
 #endif
 
+/** Emulated PSRAM latency per 32-byte access, in nanoseconds */
+#ifndef CONFIG_AKIRA_PSRAM_EMULATE_LATENCY_NS
+#define CONFIG_AKIRA_PSRAM_EMULATE_LATENCY_NS 100
+#endif
+
+/** Streaming allocations at least this large go to PSRAM */
+#ifndef CONFIG_AKIRA_TIER_STREAM_THRESHOLD
+#define CONFIG_AKIRA_TIER_STREAM_THRESHOLD 4096
+#endif
+
 /*===========================================================================*/
 /* PSRAM Statistics                                                          */
 /*===========================================================================*/
@@ -50,6 +63,38 @@ typedef struct {
     uint32_t alloc_failures;  /**< Failed allocations */
 } akira_psram_stats_t;
 
+/*===========================================================================*/
+/* Memory Tiers                                                              */
+/*===========================================================================*/
+
+/** How an allocation will be used; drives tier placement */
+typedef enum {
+    AKIRA_MEM_HINT_HOT = 0,   /**< Touched often: SRAM, PSRAM if full */
+    AKIRA_MEM_HINT_COLD,      /**< Rarely touched: PSRAM, SRAM if full */
+    AKIRA_MEM_HINT_STREAMING, /**< Sequential bulk data: PSRAM when large */
+    AKIRA_MEM_HINT_DMA,       /**< DMA-capable: SRAM only, never falls back */
+    AKIRA_MEM_HINT_COUNT
+} akira_mem_hint_t;
+
+/** Memory tier */
+typedef enum {
+    AKIRA_MEM_TIER_SRAM = 0,  /**< Internal RAM */
+    AKIRA_MEM_TIER_PSRAM,     /**< External (or emulated) PSRAM */
+    AKIRA_MEM_TIER_COUNT
+} akira_mem_tier_t;
+
+/** Tier placement statistics */
+typedef struct {
+    uint32_t placed[AKIRA_MEM_HINT_COUNT][AKIRA_MEM_TIER_COUNT]; /**< Allocations per hint and tier */
+    size_t live_bytes[AKIRA_MEM_TIER_COUNT]; /**< Bytes currently placed per tier */
+    uint32_t fallbacks;       /**< Allocations placed off their preferred tier */
+    uint32_t failures;        /**< Allocations that fit in no allowed tier */
+    uint32_t misplaced_count; /**< Live allocations off their preferred tier */
+    size_t misplaced_bytes;   /**< Bytes of those allocations */
+    uint32_t rebalanced;      /**< Allocations moved back by akira_tier_rebalance() */
+    uint64_t stall_ns;        /**< Injected PSRAM latency (emulation only) */
+} akira_tier_stats_t;
+
 /*===========================================================================*/
 /* PSRAM API                                                                 */
 /*===========================================================================*/
@@ -144,6 +189,75 @@ void *akira_psram_pool_create(const char *name, size_t size);
  */
 void akira_psram_pool_destroy(void *pool);
 
+/*===========================================================================*/
+/* Tiered Allocation API                                                     */
+/*===========================================================================*/
+
+/**
+ * @brief Allocate memory on the tier matching a usage hint
+ * @param size Number of bytes to allocate
+ * @param hint Expected access pattern
+ * @return Pointer to allocated memory, or NULL on failure
+ *
+ * @note When the preferred tier is full the other one is used (except for
+ *       AKIRA_MEM_HINT_DMA) and the allocation is counted as misplaced.
+ */
+void *akira_tier_alloc(size_t size, akira_mem_hint_t hint);
+
+/**
+ * @brief Allocate zeroed memory on the tier matching a usage hint
+ * @param count Number of elements
+ * @param size Size of each element
+ * @param hint Expected access pattern
+ * @return Pointer to zeroed memory, or NULL on failure
+ */
+void *akira_tier_calloc(size_t count, size_t size, akira_mem_hint_t hint);
+
+/**
+ * @brief Free memory from akira_tier_alloc()
+ * @param ptr Pointer to free (may be NULL)
+ */
+void akira_tier_free(void *ptr);
+
+/**
+ * @brief Get the tier a pointer lives on
+ * @param ptr Pointer to check
+ * @return AKIRA_MEM_TIER_PSRAM or AKIRA_MEM_TIER_SRAM
+ */
+akira_mem_tier_t akira_tier_of(const void *ptr);
+
+/**
+ * @brief Move a misplaced allocation to its preferred tier
+ * @param ptr Pointer from akira_tier_alloc()
+ * @return New pointer, or ptr if already placed or the tier is still full
+ *
+ * @note Like realloc(), the old pointer is invalid if a new one is returned.
+ */
+void *akira_tier_rebalance(void *ptr);
+
+/**
+ * @brief Account for an access to tiered memory
+ *
+ * With emulated PSRAM this busy-waits for the configured latency per
+ * 32-byte line; on real hardware it does nothing.
+ *
+ * @param ptr Start of the accessed range
+ * @param len Bytes accessed
+ */
+void akira_tier_access(const void *ptr, size_t len);
+
+/**
+ * @brief memcpy() that pays emulated PSRAM latency on either side
+ */
+void *akira_tier_memcpy(void *dst, const void *src, size_t len);
+
+/**
+ * @brief Get tier placement statistics
+ * @param stats Output statistics structure
+ * @return 0 on success, negative on error
+ */
+int akira_tier_get_stats(akira_tier_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,367 @@
+/**
+ * @file reclaim.c
+ * @brief AkiraOS Memory Pressure & Cache Reclaim Implementation
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+#include "reclaim.h"
+
+LOG_MODULE_REGISTER(akira_reclaim, CONFIG_AKIRA_LOG_LEVEL);
+
+BUILD_ASSERT(CONFIG_AKIRA_MEM_CRITICAL_WATERMARK <= CONFIG_AKIRA_MEM_LOW_WATERMARK,
+             "Critical watermark must not be above the low watermark");
+
+/*===========================================================================*/
+/* Internal Structures                                                       */
+/*===========================================================================*/
+
+struct reclaimer
+{
+    const char *name;
+    akira_reclaim_cb_t cb;
+    void *user_data;
+    int priority;
+    uint32_t calls;
+    size_t reclaimed;
+};
+
+struct reclaim_domain
+{
+    uint8_t low_pct;
+    uint8_t critical_pct;
+    atomic_t level;
+    atomic_t target; /* Bytes wanted by the queued asynchronous reclaim */
+    atomic_t low_events;
+    atomic_t critical_events;
+    atomic_t rescued;
+    atomic_t failed;
+    size_t reclaimed;
+};
+
+/*===========================================================================*/
+/* Internal State                                                            */
+/*===========================================================================*/
+
+static void reclaim_work_handler(struct k_work *work);
+
+#define DEFAULT_WATERMARKS                                      \
+    {                                                           \
+        .low_pct = CONFIG_AKIRA_MEM_LOW_WATERMARK,              \
+        .critical_pct = CONFIG_AKIRA_MEM_CRITICAL_WATERMARK,    \
+    }
+
+static struct
+{
+    /* Sorted by priority, lowest first */
+    struct reclaimer reclaimers[CONFIG_AKIRA_MEM_RECLAIMERS];
+    int count;
+    struct reclaim_domain domains[AKIRA_MEM_DOMAIN_COUNT];
+    k_tid_t running; /* Thread inside the callbacks, to stop recursion */
+    atomic_t pending; /* Domains with a queued asynchronous reclaim */
+} rc = {
+    .domains = {
+        [AKIRA_MEM_DOMAIN_HEAP] = DEFAULT_WATERMARKS,
+        [AKIRA_MEM_DOMAIN_POOL] = DEFAULT_WATERMARKS,
+        [AKIRA_MEM_DOMAIN_PSRAM] = DEFAULT_WATERMARKS,
+    },
+};
+
+static K_MUTEX_DEFINE(rc_mutex);
+static K_WORK_DEFINE(reclaim_work, reclaim_work_handler);
+
+static const char *const domain_names[AKIRA_MEM_DOMAIN_COUNT] = {"heap", "pool", "psram"};
+
+/*===========================================================================*/
+/* Internal Functions                                                        */
+/*===========================================================================*/
+
+static bool domain_valid(akira_mem_domain_t domain)
+{
+    return (unsigned int)domain < AKIRA_MEM_DOMAIN_COUNT;
+}
+
+static int reclaimer_find(akira_reclaim_cb_t cb, void *user_data)
+{
+    for (int i = 0; i < rc.count; i++)
+    {
+        if (rc.reclaimers[i].cb == cb && rc.reclaimers[i].user_data == user_data)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void reclaim_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    atomic_val_t pending = atomic_clear(&rc.pending);
+
+    for (int d = 0; d < AKIRA_MEM_DOMAIN_COUNT; d++)
+    {
+        if (!(pending & BIT(d)))
+        {
+            continue;
+        }
+
+        struct reclaim_domain *dom = &rc.domains[d];
+        size_t target = atomic_clear(&dom->target);
+
+        akira_reclaim_run(d, atomic_get(&dom->level), target);
+    }
+}
+
+/*===========================================================================*/
+/* Reclaim API                                                               */
+/*===========================================================================*/
+
+int akira_reclaim_register(const char *name, akira_reclaim_cb_t cb, void *user_data,
+                           int priority)
+{
+    if (!cb)
+    {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&rc_mutex, K_FOREVER);
+
+    if (reclaimer_find(cb, user_data) >= 0)
+    {
+        k_mutex_unlock(&rc_mutex);
+        return -EALREADY;
+    }
+
+    if (rc.count >= CONFIG_AKIRA_MEM_RECLAIMERS)
+    {
+        k_mutex_unlock(&rc_mutex);
+        LOG_ERR("No room for reclaimer '%s'", name ? name : "unnamed");
+        return -ENOMEM;
+    }
+
+    /* Insert after every callback of equal or lower priority */
+    int pos = rc.count;
+    while (pos > 0 && rc.reclaimers[pos - 1].priority > priority)
+    {
+        rc.reclaimers[pos] = rc.reclaimers[pos - 1];
+        pos--;
+    }
+
+    rc.reclaimers[pos] = (struct reclaimer){
+        .name = name ? name : "unnamed",
+        .cb = cb,
+        .user_data = user_data,
+        .priority = priority,
+    };
+    rc.count++;
+
+    k_mutex_unlock(&rc_mutex);
+
+    LOG_DBG("Reclaimer '%s' registered (priority %d)", rc.reclaimers[pos].name, priority);
+    return 0;
+}
+
+int akira_reclaim_unregister(akira_reclaim_cb_t cb, void *user_data)
+{
+    k_mutex_lock(&rc_mutex, K_FOREVER);
+
+    int i = reclaimer_find(cb, user_data);
+    if (i < 0)
+    {
+        k_mutex_unlock(&rc_mutex);
+        return -ENOENT;
+    }
+
+    memmove(&rc.reclaimers[i], &rc.reclaimers[i + 1],
+            (rc.count - i - 1) * sizeof(rc.reclaimers[0]));
+    rc.count--;
+
+    k_mutex_unlock(&rc_mutex);
+    return 0;
+}
+
+int akira_reclaim_set_watermarks(akira_mem_domain_t domain, uint8_t low_pct,
+                                 uint8_t critical_pct)
+{
+    if (!domain_valid(domain) || low_pct > 100 || critical_pct > low_pct)
+    {
+        return -EINVAL;
+    }
+
+    rc.domains[domain].low_pct = low_pct;
+    rc.domains[domain].critical_pct = critical_pct;
+    return 0;
+}
+
+akira_mem_pressure_t akira_reclaim_pressure(akira_mem_domain_t domain)
+{
+    if (!domain_valid(domain))
+    {
+        return AKIRA_MEM_PRESSURE_NONE;
+    }
+
+    return atomic_get(&rc.domains[domain].level);
+}
+
+size_t akira_reclaim_run(akira_mem_domain_t domain, akira_mem_pressure_t level,
+                         size_t target)
+{
+    size_t freed = 0;
+
+    if (!domain_valid(domain) || k_is_in_isr())
+    {
+        return 0;
+    }
+
+    k_mutex_lock(&rc_mutex, K_FOREVER);
+
+    /* A callback that allocates must not start another round */
+    if (rc.running)
+    {
+        k_mutex_unlock(&rc_mutex);
+        return 0;
+    }
+    rc.running = k_current_get();
+
+    for (int i = 0; i < rc.count; i++)
+    {
+        struct reclaimer *r = &rc.reclaimers[i];
+
+        if (level < AKIRA_MEM_PRESSURE_CRITICAL && freed >= target)
+        {
+            break;
+        }
+
+        size_t got = r->cb(domain, level, target > freed ? target - freed : 0, r->user_data);
+        r->calls++;
+        r->reclaimed += got;
+        freed += got;
+    }
+
+    rc.domains[domain].reclaimed += freed;
+    rc.running = NULL;
+
+    k_mutex_unlock(&rc_mutex);
+
+    if (freed > 0)
+    {
+        LOG_DBG("Reclaimed %zu bytes for %s (level %d)", freed, domain_names[domain], level);
+    }
+
+    return freed;
+}
+
+int akira_reclaim_get_stats(akira_mem_domain_t domain, akira_reclaim_stats_t *stats)
+{
+    if (!domain_valid(domain) || !stats)
+    {
+        return -EINVAL;
+    }
+
+    struct reclaim_domain *dom = &rc.domains[domain];
+
+    stats->level = atomic_get(&dom->level);
+    stats->low_pct = dom->low_pct;
+    stats->critical_pct = dom->critical_pct;
+    stats->low_events = atomic_get(&dom->low_events);
+    stats->critical_events = atomic_get(&dom->critical_events);
+    stats->rescued = atomic_get(&dom->rescued);
+    stats->failed = atomic_get(&dom->failed);
+    stats->reclaimed = dom->reclaimed;
+
+    return 0;
+}
+
+int akira_reclaim_list(akira_reclaimer_info_t *out, int max)
+{
+    int n = 0;
+
+    if (!out)
+    {
+        return 0;
+    }
+
+    k_mutex_lock(&rc_mutex, K_FOREVER);
+
+    for (; n < rc.count && n < max; n++)
+    {
+        out[n].name = rc.reclaimers[n].name;
+        out[n].priority = rc.reclaimers[n].priority;
+        out[n].calls = rc.reclaimers[n].calls;
+        out[n].reclaimed = rc.reclaimers[n].reclaimed;
+    }
+
+    k_mutex_unlock(&rc_mutex);
+
+    return n;
+}
+
+/*===========================================================================*/
+/* Allocator Hooks                                                           */
+/*===========================================================================*/
+
+akira_mem_pressure_t akira_reclaim_check(akira_mem_domain_t domain, uint8_t *state,
+                                         size_t free_bytes, size_t total_bytes)
+{
+    struct reclaim_domain *dom = &rc.domains[domain];
+    akira_mem_pressure_t level = AKIRA_MEM_PRESSURE_NONE;
+
+    /* Compare percentages without dividing: free / total < pct / 100 */
+    uint64_t free_scaled = (uint64_t)free_bytes * 100;
+
+    if (free_scaled < (uint64_t)total_bytes * dom->critical_pct)
+    {
+        level = AKIRA_MEM_PRESSURE_CRITICAL;
+    }
+    else if (free_scaled < (uint64_t)total_bytes * dom->low_pct)
+    {
+        level = AKIRA_MEM_PRESSURE_LOW;
+    }
+
+    if (level == *state)
+    {
+        return level;
+    }
+
+    akira_mem_pressure_t prev = *state;
+    *state = level;
+    atomic_set(&dom->level, level);
+
+    if (level > prev)
+    {
+        atomic_inc(level == AKIRA_MEM_PRESSURE_CRITICAL ? &dom->critical_events
+                                                        : &dom->low_events);
+
+        /* Ask for enough to climb back above the low watermark */
+        size_t want = (size_t)((uint64_t)total_bytes * dom->low_pct / 100);
+        atomic_set(&dom->target, want > free_bytes ? want - free_bytes : 0);
+        atomic_or(&rc.pending, BIT(domain));
+        k_work_submit(&reclaim_work);
+
+        LOG_DBG("%s pressure %d: %zu of %zu bytes free", domain_names[domain], level,
+                free_bytes, total_bytes);
+    }
+
+    return level;
+}
+
+bool akira_reclaim_on_failure(akira_mem_domain_t domain, size_t size)
+{
+    if (!domain_valid(domain) || rc.count == 0)
+    {
+        return false;
+    }
+
+    size_t freed = akira_reclaim_run(domain, AKIRA_MEM_PRESSURE_CRITICAL, size);
+
+    if (freed > 0)
+    {
+        atomic_inc(&rc.domains[domain].rescued);
+        return true;
+    }
+
+    atomic_inc(&rc.domains[domain].failed);
+    return false;
+}
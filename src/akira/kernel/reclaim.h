@@ -0,0 +1,203 @@
+/**
+ * @file reclaim.h
+ * @brief AkiraOS Memory Pressure & Cache Reclaim
+ *
+ * Caches that can give memory back (module caches, glyph caches, RAM
+ * files, log buffers, ...) register a reclaim callback. The allocators
+ * watch low and critical free-memory watermarks on the kernel heap, Akira
+ * pools and PSRAM: crossing one queues an asynchronous reclaim on the
+ * system work queue, and an allocation that is about to fail first runs
+ * every callback synchronously and retries once.
+ *
+ * Callbacks run in priority order (lowest value first) and should drop
+ * the cheapest-to-rebuild data first. They may be called from any thread
+ * that allocates, so they must not block on locks that can be held while
+ * allocating; use K_NO_WAIT and report 0 bytes if busy.
+ */
+
+#ifndef AKIRA_KERNEL_RECLAIM_H
+#define AKIRA_KERNEL_RECLAIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/** Maximum number of registered reclaim callbacks */
+#ifndef CONFIG_AKIRA_MEM_RECLAIMERS
+#define CONFIG_AKIRA_MEM_RECLAIMERS 8
+#endif
+
+/** Default low watermark, in percent of the domain left free */
+#ifndef CONFIG_AKIRA_MEM_LOW_WATERMARK
+#define CONFIG_AKIRA_MEM_LOW_WATERMARK 15
+#endif
+
+/** Default critical watermark, in percent of the domain left free */
+#ifndef CONFIG_AKIRA_MEM_CRITICAL_WATERMARK
+#define CONFIG_AKIRA_MEM_CRITICAL_WATERMARK 5
+#endif
+
+/** Suggested callback priorities */
+#define AKIRA_RECLAIM_PRIO_CACHE 0   /**< Pure caches, cheap to rebuild */
+#define AKIRA_RECLAIM_PRIO_BUFFER 50 /**< Buffers whose contents are lost (logs) */
+#define AKIRA_RECLAIM_PRIO_DATA 100  /**< Data that is expensive to restore */
+
+    /*===========================================================================*/
+    /* Types                                                                     */
+    /*===========================================================================*/
+
+    /** Memory watched by the watermarks */
+    typedef enum
+    {
+        AKIRA_MEM_DOMAIN_HEAP = 0, /**< Kernel (system) heap */
+        AKIRA_MEM_DOMAIN_POOL,     /**< Akira memory pools */
+        AKIRA_MEM_DOMAIN_PSRAM,    /**< External PSRAM */
+        AKIRA_MEM_DOMAIN_COUNT
+    } akira_mem_domain_t;
+
+    /** Memory pressure level */
+    typedef enum
+    {
+        AKIRA_MEM_PRESSURE_NONE = 0, /**< Above the low watermark */
+        AKIRA_MEM_PRESSURE_LOW,      /**< Below the low watermark */
+        AKIRA_MEM_PRESSURE_CRITICAL  /**< Below the critical watermark or failing */
+    } akira_mem_pressure_t;
+
+    /**
+     * @brief Reclaim callback
+     * @param domain Domain under pressure
+     * @param level Pressure level; at CRITICAL give back everything possible
+     * @param target Bytes the caller would like freed
+     * @param user_data User data from registration
+     * @return Bytes actually freed
+     */
+    typedef size_t (*akira_reclaim_cb_t)(akira_mem_domain_t domain, akira_mem_pressure_t level,
+                                         size_t target, void *user_data);
+
+    /** Reclaim statistics of one domain */
+    typedef struct
+    {
+        akira_mem_pressure_t level; /**< Current pressure level */
+        uint8_t low_pct;            /**< Low watermark (% free) */
+        uint8_t critical_pct;       /**< Critical watermark (% free) */
+        uint32_t low_events;        /**< Times the low watermark was crossed */
+        uint32_t critical_events;   /**< Times the critical watermark was crossed */
+        uint32_t rescued;           /**< Failing allocations retried after reclaim */
+        uint32_t failed;            /**< Failing allocations nothing could be freed for */
+        size_t reclaimed;           /**< Bytes reported freed for this domain */
+    } akira_reclaim_stats_t;
+
+    /** Registered callback, as reported by akira_reclaim_list() */
+    typedef struct
+    {
+        const char *name;
+        int priority;
+        uint32_t calls;   /**< Times the callback was invoked */
+        size_t reclaimed; /**< Bytes it reported freed */
+    } akira_reclaimer_info_t;
+
+    /*===========================================================================*/
+    /* Reclaim API                                                               */
+    /*===========================================================================*/
+
+    /**
+     * @brief Register a reclaim callback
+     * @param name Name for diagnostics
+     * @param cb Callback
+     * @param user_data Passed to the callback
+     * @param priority Lower values are asked first (AKIRA_RECLAIM_PRIO_*)
+     * @return 0 on success, -EINVAL, -EALREADY or -ENOMEM
+     */
+    int akira_reclaim_register(const char *name, akira_reclaim_cb_t cb, void *user_data,
+                               int priority);
+
+    /**
+     * @brief Unregister a reclaim callback
+     * @return 0 on success, -ENOENT if not registered
+     */
+    int akira_reclaim_unregister(akira_reclaim_cb_t cb, void *user_data);
+
+    /**
+     * @brief Set the watermarks of a domain
+     * @param domain Memory domain
+     * @param low_pct Free percentage below which LOW pressure is signalled
+     * @param critical_pct Free percentage below which CRITICAL is signalled
+     * @return 0 on success, -EINVAL if critical_pct > low_pct or out of range
+     */
+    int akira_reclaim_set_watermarks(akira_mem_domain_t domain, uint8_t low_pct,
+                                     uint8_t critical_pct);
+
+    /**
+     * @brief Get the current pressure level of a domain
+     *
+     * For pools this is the level of the pool that changed level last.
+     */
+    akira_mem_pressure_t akira_reclaim_pressure(akira_mem_domain_t domain);
+
+    /**
+     * @brief Run reclaim callbacks now
+     *
+     * Below CRITICAL, stops once target bytes were freed.
+     *
+     * @param domain Domain to reclaim for
+     * @param level Pressure level passed to the callbacks
+     * @param target Bytes wanted
+     * @return Bytes freed
+     */
+    size_t akira_reclaim_run(akira_mem_domain_t domain, akira_mem_pressure_t level,
+                             size_t target);
+
+    /**
+     * @brief Get reclaim statistics of a domain
+     * @return 0 on success, -EINVAL on bad arguments
+     */
+    int akira_reclaim_get_stats(akira_mem_domain_t domain, akira_reclaim_stats_t *stats);
+
+    /**
+     * @brief List registered callbacks in priority order
+     * @param out Output array
+     * @param max Capacity of out
+     * @return Number of callbacks written
+     */
+    int akira_reclaim_list(akira_reclaimer_info_t *out, int max);
+
+    /*===========================================================================*/
+    /* Allocator Hooks                                                           */
+    /*===========================================================================*/
+
+    /**
+     * @brief Compare a domain's free memory with its watermarks
+     *
+     * Queues an asynchronous reclaim when the level rises.
+     *
+     * @param domain Memory domain
+     * @param state Level last seen by the caller (per pool for pools)
+     * @param free_bytes Bytes free
+     * @param total_bytes Bytes managed
+     * @return Current level
+     */
+    akira_mem_pressure_t akira_reclaim_check(akira_mem_domain_t domain, uint8_t *state,
+                                             size_t free_bytes, size_t total_bytes);
+
+    /**
+     * @brief Reclaim synchronously before failing an allocation
+     * @param domain Domain the allocation failed in
+     * @param size Bytes requested
+     * @return true if memory was freed and the allocation should be retried
+     */
+    bool akira_reclaim_on_failure(akira_mem_domain_t domain, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_KERNEL_RECLAIM_H */
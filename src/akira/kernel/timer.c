@@ -5,9 +5,11 @@
 
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <stdio.h>
 #include <string.h>
 #include "timer.h"
 #include "memory.h"
+#include "trace.h"
 
 LOG_MODULE_REGISTER(akira_timer, CONFIG_AKIRA_LOG_LEVEL);
 
@@ -15,6 +17,21 @@ LOG_MODULE_REGISTER(akira_timer, CONFIG_AKIRA_LOG_LEVEL);
 /* Internal Structures                                                       */
 /*===========================================================================*/
 
+/*
+ * Timers live in a hierarchical timing wheel with a resolution of 1 ms.
+ * Level L has WHEEL_SLOTS slots of 32^L ms each; a timer goes into the
+ * lowest level whose span covers its delay and cascades one or more
+ * levels down when its slot comes up. Per-level occupancy bitmaps give
+ * the next deadline in constant time, so a single kernel timer only
+ * fires when a slot actually has to be processed.
+ */
+#define WHEEL_BITS 5
+#define WHEEL_SLOTS BIT(WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS 5
+#define WHEEL_SHIFT(level) ((level) * WHEEL_BITS)
+#define WHEEL_RANGE BIT64(WHEEL_LEVELS * WHEEL_BITS) /* ~9.3 hours */
+
 struct akira_timer
 {
     bool in_use;
@@ -25,11 +42,17 @@ struct akira_timer
     akira_duration_t period_ms;
     akira_duration_t initial_ms;
     akira_duration_t remaining_ms;
+    akira_duration_t slack_ms;
     akira_timer_callback_t callback;
     void *user_data;
     uint32_t fire_count;
 
-    struct k_timer k_timer;
+    uint64_t target;      /* Nominal expiry, as uptime in ms */
+    uint64_t expires;     /* When it fires: target plus up to slack_ms */
+    uint8_t level;        /* Wheel slot the timer was last placed in */
+    uint8_t slot;
+    sys_dnode_t node;     /* In a wheel slot or in the batch being fired */
+    sys_dnode_t all_node; /* In timer_mgr.all */
 };
 
 /*===========================================================================*/
@@ -39,69 +62,301 @@ struct akira_timer
 static struct
 {
     bool initialized;
-    akira_timer_t timers[AKIRA_MAX_TIMERS];
+    sys_dlist_t all;
     akira_handle_t next_id;
     int active_count;
-    struct k_mutex mutex;
+    struct k_mutex mutex; /* Protects the timer list */
+
+    /* Wheel, protected by lock */
+    struct k_spinlock lock;
+    sys_dlist_t slots[WHEEL_LEVELS][WHEEL_SLOTS];
+    uint32_t occupied[WHEEL_LEVELS];
+    uint64_t now;   /* Every slot due up to this time has been processed */
+    uint64_t armed; /* Deadline the kernel timer is set for */
+    struct k_timer k_timer;
+    struct k_work work;
+
+    /* Statistics */
+    uint32_t wakeups;
+    uint32_t expirations;
+    uint32_t deferred;
+    int64_t stats_since;
 } timer_mgr;
 
 /*===========================================================================*/
 /* Internal Functions                                                        */
 /*===========================================================================*/
 
-static akira_timer_t *find_timer_by_k_timer(struct k_timer *k_timer)
+static bool wheel_empty(void)
 {
-    for (int i = 0; i < AKIRA_MAX_TIMERS; i++)
+    for (int level = 0; level < WHEEL_LEVELS; level++)
     {
-        if (timer_mgr.timers[i].in_use &&
-            &timer_mgr.timers[i].k_timer == k_timer)
+        if (timer_mgr.occupied[level])
         {
-            return &timer_mgr.timers[i];
+            return false;
         }
     }
-    return NULL;
+    return true;
 }
 
-static akira_timer_t *find_free_slot(void)
+/* Called with the wheel locked */
+static void wheel_place(akira_timer_t *timer, int level, uint8_t slot)
 {
-    for (int i = 0; i < AKIRA_MAX_TIMERS; i++)
+    sys_dlist_append(&timer_mgr.slots[level][slot], &timer->node);
+    timer_mgr.occupied[level] |= BIT(slot);
+    timer->level = level;
+    timer->slot = slot;
+}
+
+/* Called with the wheel locked */
+static void wheel_insert(akira_timer_t *timer)
+{
+    uint64_t when = MAX(timer->expires, timer_mgr.now + 1);
+    uint64_t delta = when - timer_mgr.now;
+    int level = 0;
+
+    /* Beyond the top level, park in its furthest slot and re-sort from there */
+    if (delta >= WHEEL_RANGE)
     {
-        if (!timer_mgr.timers[i].in_use)
+        delta = WHEEL_RANGE - 1;
+        when = timer_mgr.now + delta;
+    }
+
+    while (level < WHEEL_LEVELS - 1 && delta >= BIT64(WHEEL_SHIFT(level + 1)))
+    {
+        level++;
+    }
+
+    wheel_place(timer, level, (when >> WHEEL_SHIFT(level)) & WHEEL_MASK);
+}
+
+/* Called with the wheel locked */
+static void wheel_remove(akira_timer_t *timer)
+{
+    if (!sys_dnode_is_linked(&timer->node))
+    {
+        return;
+    }
+
+    sys_dlist_remove(&timer->node);
+
+    /* Also right when the timer was in the batch being fired */
+    if (sys_dlist_is_empty(&timer_mgr.slots[timer->level][timer->slot]))
+    {
+        timer_mgr.occupied[timer->level] &= ~BIT(timer->slot);
+    }
+}
+
+/* Called with the wheel locked; UINT64_MAX if the wheel is empty */
+static uint64_t wheel_next(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (int level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t occupied = timer_mgr.occupied[level];
+        if (!occupied)
+        {
+            continue;
+        }
+
+        /* Rotate so that bit 0 is the slot after the current one, which
+         * has already been processed and is reached again last */
+        uint64_t base = timer_mgr.now >> WHEEL_SHIFT(level);
+        uint32_t first = (base + 1) & WHEEL_MASK;
+
+        if (first)
         {
-            return &timer_mgr.timers[i];
+            occupied = (occupied >> first) | (occupied << (WHEEL_SLOTS - first));
         }
+
+        uint64_t due = (base + find_lsb_set(occupied)) << WHEEL_SHIFT(level);
+        next = MIN(next, due);
     }
-    return NULL;
+
+    return next;
 }
 
-static void timer_expiry_handler(struct k_timer *k_timer)
+/* Called with the wheel locked */
+static void wheel_arm(void)
 {
-    akira_timer_t *timer = find_timer_by_k_timer(k_timer);
-    if (!timer)
+    uint64_t next = wheel_next();
+
+    if (next == timer_mgr.armed)
     {
         return;
     }
 
-    timer->fire_count++;
+    timer_mgr.armed = next;
 
-    if (timer->mode == AKIRA_TIMER_ONESHOT)
+    if (next == UINT64_MAX)
     {
-        timer->state = AKIRA_TIMER_EXPIRED;
+        k_timer_stop(&timer_mgr.k_timer);
+        return;
+    }
+
+    uint64_t uptime = k_uptime_get();
+    k_timer_start(&timer_mgr.k_timer,
+                  next > uptime ? K_MSEC(next - uptime) : K_NO_WAIT, K_NO_WAIT);
+}
+
+/* Called with the wheel locked */
+static void timer_apply_slack(akira_timer_t *timer)
+{
+    uint64_t latest = timer->target + timer->slack_ms;
+
+    timer->expires = timer->target;
+    if (timer->slack_ms == 0)
+    {
+        return;
+    }
+
+    /* Share a wakeup that is already scheduled inside the window */
+    uint64_t next = wheel_next();
+    if (next >= timer->target && next <= latest)
+    {
+        timer->expires = next;
+        return;
+    }
+
+    /* Otherwise round up to the largest power of two the slack allows,
+     * which timers with overlapping windows tend to land on together */
+    uint64_t grain = BIT64(find_msb_set(timer->slack_ms) - 1);
+    timer->expires = (timer->target + grain - 1) & ~(grain - 1);
+}
+
+/* Called with the wheel locked */
+static void wheel_cascade(int level, uint64_t due)
+{
+    uint8_t slot = (due >> WHEEL_SHIFT(level)) & WHEEL_MASK;
+    sys_dlist_t *list = &timer_mgr.slots[level][slot];
+    sys_dnode_t *node;
+
+    /* Everything here is due within one slot of the level below */
+    timer_mgr.occupied[level] &= ~BIT(slot);
+    while ((node = sys_dlist_get(list)) != NULL)
+    {
+        akira_timer_t *timer = CONTAINER_OF(node, akira_timer_t, node);
+
+        /* Due right now: straight into the level 0 slot about to fire */
+        if (timer->expires <= due)
+        {
+            wheel_place(timer, 0, due & WHEEL_MASK);
+        }
+        else
+        {
+            wheel_insert(timer);
+        }
     }
+}
+
+static void timer_work_handler(struct k_work *work)
+{
+    ARG_UNUSED(work);
+
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+    uint64_t uptime = k_uptime_get();
+    uint64_t due;
+
+    timer_mgr.armed = UINT64_MAX;
+    timer_mgr.wakeups++;
 
-    if (timer->callback)
+    while ((due = wheel_next()) <= uptime)
     {
-        timer->callback(timer, timer->user_data);
+        timer_mgr.now = due;
+
+        /* Top down, so a timer can drop several levels at once */
+        for (int level = WHEEL_LEVELS - 1; level > 0; level--)
+        {
+            if ((due & (BIT64(WHEEL_SHIFT(level)) - 1)) == 0 &&
+                (timer_mgr.occupied[level] & BIT((due >> WHEEL_SHIFT(level)) & WHEEL_MASK)))
+            {
+                wheel_cascade(level, due);
+            }
+        }
+
+        uint8_t slot = due & WHEEL_MASK;
+        sys_dlist_t batch;
+        sys_dnode_t *node;
+
+        sys_dlist_init(&batch);
+        while ((node = sys_dlist_get(&timer_mgr.slots[0][slot])) != NULL)
+        {
+            sys_dlist_append(&batch, node);
+        }
+        timer_mgr.occupied[0] &= ~BIT(slot);
+
+        /* Callbacks run unlocked and may start, stop or destroy any timer,
+         * including ones still in the batch */
+        while ((node = sys_dlist_get(&batch)) != NULL)
+        {
+            akira_timer_t *timer = CONTAINER_OF(node, akira_timer_t, node);
+
+            timer->fire_count++;
+            timer_mgr.expirations++;
+            if (timer->expires != timer->target)
+            {
+                timer_mgr.deferred++;
+            }
+            AKIRA_TRACE(AKIRA_TRACE_TIMER_EXPIRE, 0, timer->id, timer->fire_count);
+
+            if (timer->mode == AKIRA_TIMER_ONESHOT || timer->period_ms == 0)
+            {
+                timer->state = AKIRA_TIMER_EXPIRED;
+            }
+            else
+            {
+                /* Keep the phase, skipping periods that were missed */
+                timer->target += timer->period_ms;
+                if (timer->target <= due)
+                {
+                    timer->target = due + timer->period_ms;
+                }
+                timer_apply_slack(timer);
+                wheel_insert(timer);
+            }
+
+            akira_timer_callback_t callback = timer->callback;
+            void *user_data = timer->user_data;
+
+            if (callback)
+            {
+                k_spin_unlock(&timer_mgr.lock, key);
+                callback(timer, user_data);
+                key = k_spin_lock(&timer_mgr.lock);
+            }
+        }
     }
+
+    timer_mgr.now = MAX(timer_mgr.now, uptime);
+    wheel_arm();
+
+    k_spin_unlock(&timer_mgr.lock, key);
+}
+
+static void timer_kernel_expiry(struct k_timer *k_timer)
+{
+    ARG_UNUSED(k_timer);
+
+    k_work_submit(&timer_mgr.work);
 }
 
-static void timer_stop_handler(struct k_timer *k_timer)
+/* Called with the wheel locked */
+static void timer_schedule(akira_timer_t *timer, akira_duration_t delay_ms)
 {
-    akira_timer_t *timer = find_timer_by_k_timer(k_timer);
-    if (timer)
+    uint64_t uptime = k_uptime_get();
+
+    /* An idle wheel can skip ahead instead of cascading through the gap */
+    if (wheel_empty())
     {
-        timer->state = AKIRA_TIMER_STOPPED;
+        timer_mgr.now = MAX(timer_mgr.now, uptime);
     }
+
+    wheel_remove(timer);
+    timer->target = uptime + delay_ms;
+    timer_apply_slack(timer);
+    wheel_insert(timer);
+    wheel_arm();
 }
 
 /*===========================================================================*/
@@ -118,13 +373,28 @@ int akira_timer_subsystem_init(void)
     LOG_INF("Initializing timer subsystem");
 
     k_mutex_init(&timer_mgr.mutex);
-    memset(&timer_mgr.timers, 0, sizeof(timer_mgr.timers));
+    sys_dlist_init(&timer_mgr.all);
     timer_mgr.next_id = 1;
     timer_mgr.active_count = 0;
 
+    for (int level = 0; level < WHEEL_LEVELS; level++)
+    {
+        for (int slot = 0; slot < WHEEL_SLOTS; slot++)
+        {
+            sys_dlist_init(&timer_mgr.slots[level][slot]);
+        }
+        timer_mgr.occupied[level] = 0;
+    }
+    timer_mgr.now = k_uptime_get();
+    timer_mgr.armed = UINT64_MAX;
+    timer_mgr.stats_since = k_uptime_get();
+
+    k_timer_init(&timer_mgr.k_timer, timer_kernel_expiry, NULL);
+    k_work_init(&timer_mgr.work, timer_work_handler);
+
     timer_mgr.initialized = true;
 
-    LOG_INF("Timer subsystem initialized (max=%d)", AKIRA_MAX_TIMERS);
+    LOG_INF("Timer subsystem initialized (%d-level wheel)", WHEEL_LEVELS);
 
     return 0;
 }
@@ -136,24 +406,24 @@ akira_timer_t *akira_timer_create(const akira_timer_config_t *config)
         return NULL;
     }
 
-    k_mutex_lock(&timer_mgr.mutex, K_FOREVER);
-
-    akira_timer_t *timer = find_free_slot();
+    akira_timer_t *timer = akira_malloc(sizeof(*timer));
     if (!timer)
     {
-        k_mutex_unlock(&timer_mgr.mutex);
-        LOG_ERR("No free timer slots");
+        LOG_ERR("No memory for timer");
         return NULL;
     }
 
     memset(timer, 0, sizeof(*timer));
 
+    k_mutex_lock(&timer_mgr.mutex, K_FOREVER);
+
     timer->in_use = true;
     timer->id = timer_mgr.next_id++;
     timer->mode = config->mode;
     timer->state = AKIRA_TIMER_STOPPED;
     timer->period_ms = config->period_ms;
     timer->initial_ms = config->initial_ms > 0 ? config->initial_ms : config->period_ms;
+    timer->slack_ms = config->slack_ms;
     timer->callback = config->callback;
     timer->user_data = config->user_data;
 
@@ -166,8 +436,7 @@ akira_timer_t *akira_timer_create(const akira_timer_config_t *config)
         snprintf(timer->name, sizeof(timer->name), "timer_%u", timer->id);
     }
 
-    k_timer_init(&timer->k_timer, timer_expiry_handler, timer_stop_handler);
-
+    sys_dlist_append(&timer_mgr.all, &timer->all_node);
     timer_mgr.active_count++;
 
     k_mutex_unlock(&timer_mgr.mutex);
@@ -194,12 +463,17 @@ void akira_timer_destroy(akira_timer_t *timer)
 
     LOG_DBG("Destroying timer '%s'", timer->name);
 
-    k_timer_stop(&timer->k_timer);
-
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+    wheel_remove(timer);
     timer->in_use = false;
+    k_spin_unlock(&timer_mgr.lock, key);
+
+    sys_dlist_remove(&timer->all_node);
     timer_mgr.active_count--;
 
     k_mutex_unlock(&timer_mgr.mutex);
+
+    akira_free(timer);
 }
 
 int akira_timer_start(akira_timer_t *timer)
@@ -209,24 +483,17 @@ int akira_timer_start(akira_timer_t *timer)
         return -1;
     }
 
-    k_timeout_t initial = K_MSEC(timer->initial_ms);
-    k_timeout_t period;
-
-    switch (timer->mode)
+    if (timer->mode != AKIRA_TIMER_ONESHOT &&
+        timer->mode != AKIRA_TIMER_PERIODIC &&
+        timer->mode != AKIRA_TIMER_INTERVAL)
     {
-    case AKIRA_TIMER_ONESHOT:
-        period = K_NO_WAIT;
-        break;
-    case AKIRA_TIMER_PERIODIC:
-    case AKIRA_TIMER_INTERVAL:
-        period = K_MSEC(timer->period_ms);
-        break;
-    default:
         return -1;
     }
 
-    k_timer_start(&timer->k_timer, initial, period);
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+    timer_schedule(timer, timer->initial_ms);
     timer->state = AKIRA_TIMER_RUNNING;
+    k_spin_unlock(&timer_mgr.lock, key);
 
     LOG_DBG("Started timer '%s'", timer->name);
 
@@ -240,8 +507,10 @@ int akira_timer_stop(akira_timer_t *timer)
         return -1;
     }
 
-    k_timer_stop(&timer->k_timer);
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+    wheel_remove(timer);
     timer->state = AKIRA_TIMER_STOPPED;
+    k_spin_unlock(&timer_mgr.lock, key);
 
     LOG_DBG("Stopped timer '%s'", timer->name);
 
@@ -268,9 +537,11 @@ int akira_timer_pause(akira_timer_t *timer)
         return -1;
     }
 
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
     timer->remaining_ms = akira_timer_remaining(timer);
-    k_timer_stop(&timer->k_timer);
+    wheel_remove(timer);
     timer->state = AKIRA_TIMER_PAUSED;
+    k_spin_unlock(&timer_mgr.lock, key);
 
     return 0;
 }
@@ -283,11 +554,10 @@ int akira_timer_resume(akira_timer_t *timer)
         return -1;
     }
 
-    k_timeout_t remaining = K_MSEC(timer->remaining_ms);
-    k_timeout_t period = (timer->mode == AKIRA_TIMER_ONESHOT) ? K_NO_WAIT : K_MSEC(timer->period_ms);
-
-    k_timer_start(&timer->k_timer, remaining, period);
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+    timer_schedule(timer, timer->remaining_ms);
     timer->state = AKIRA_TIMER_RUNNING;
+    k_spin_unlock(&timer_mgr.lock, key);
 
     return 0;
 }
@@ -309,7 +579,13 @@ akira_duration_t akira_timer_remaining(akira_timer_t *timer)
         return timer->remaining_ms;
     }
 
-    return k_timer_remaining_get(&timer->k_timer);
+    if (timer->state != AKIRA_TIMER_RUNNING)
+    {
+        return 0;
+    }
+
+    uint64_t uptime = k_uptime_get();
+    return timer->expires > uptime ? (akira_duration_t)(timer->expires - uptime) : 0;
 }
 
 int akira_timer_get_info(akira_timer_t *timer, akira_timer_info_t *info)
@@ -324,6 +600,7 @@ int akira_timer_get_info(akira_timer_t *timer, akira_timer_info_t *info)
     info->mode = timer->mode;
     info->state = timer->state;
     info->period_ms = timer->period_ms;
+    info->slack_ms = timer->slack_ms;
     info->remaining_ms = akira_timer_remaining(timer);
     info->fire_count = timer->fire_count;
 
@@ -332,16 +609,22 @@ int akira_timer_get_info(akira_timer_t *timer, akira_timer_info_t *info)
 
 int akira_timer_set_period(akira_timer_t *timer, akira_duration_t period_ms)
 {
-    if (!timer)
+    if (!timer || !timer->in_use)
         return -1;
 
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+
     timer->period_ms = period_ms;
 
+    /* Restart in one step so the work handler never sees a half update */
     if (timer->state == AKIRA_TIMER_RUNNING)
     {
-        akira_timer_reset(timer);
+        timer->fire_count = 0;
+        timer_schedule(timer, timer->initial_ms);
     }
 
+    k_spin_unlock(&timer_mgr.lock, key);
+
     return 0;
 }
 
@@ -352,8 +635,34 @@ int akira_timer_set_callback(akira_timer_t *timer,
     if (!timer)
         return -1;
 
+    /* The work handler reads both under the lock */
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
     timer->callback = callback;
     timer->user_data = user_data;
+    k_spin_unlock(&timer_mgr.lock, key);
+
+    return 0;
+}
+
+int akira_timer_set_slack(akira_timer_t *timer, akira_duration_t slack_ms)
+{
+    if (!timer || !timer->in_use)
+        return -1;
+
+    k_spinlock_key_t key = k_spin_lock(&timer_mgr.lock);
+
+    timer->slack_ms = slack_ms;
+
+    /* Move a pending expiry into the new window, keeping its target */
+    if (timer->state == AKIRA_TIMER_RUNNING && sys_dnode_is_linked(&timer->node))
+    {
+        wheel_remove(timer);
+        timer_apply_slack(timer);
+        wheel_insert(timer);
+        wheel_arm();
+    }
+
+    k_spin_unlock(&timer_mgr.lock, key);
 
     return 0;
 }
@@ -480,10 +789,37 @@ int akira_timer_count(void)
     return timer_mgr.active_count;
 }
 
+int akira_timer_get_stats(akira_timer_stats_t *stats)
+{
+    if (!stats)
+    {
+        return -1;
+    }
+
+    stats->wakeups = timer_mgr.wakeups;
+    stats->expirations = timer_mgr.expirations;
+    stats->deferred = timer_mgr.deferred;
+    stats->uptime_ms = timer_mgr.initialized ? k_uptime_get() - timer_mgr.stats_since : 0;
+
+    return 0;
+}
+
 void akira_timer_print_all(void)
 {
+    akira_timer_stats_t stats;
+
     LOG_INF("=== Timer Status ===");
-    LOG_INF("Active timers: %d/%d", timer_mgr.active_count, AKIRA_MAX_TIMERS);
+    LOG_INF("Active timers: %d", timer_mgr.active_count);
+
+    akira_timer_get_stats(&stats);
+
+    /* Hundredths, to avoid needing float formatting */
+    uint32_t rate = stats.uptime_ms ? (uint64_t)stats.wakeups * 100000 / stats.uptime_ms : 0;
+    uint32_t ratio = stats.wakeups ? (uint64_t)stats.expirations * 100 / stats.wakeups : 0;
+
+    LOG_INF("Wakeups: %u (%u.%02u/s)", stats.wakeups, rate / 100, rate % 100);
+    LOG_INF("Expirations: %u (%u.%02u per wakeup, %u deferred by slack)",
+            stats.expirations, ratio / 100, ratio % 100, stats.deferred);
 
     static const char *state_names[] = {
         "STOPPED", "RUNNING", "EXPIRED", "PAUSED"};
@@ -491,18 +827,25 @@ void akira_timer_print_all(void)
     static const char *mode_names[] = {
         "ONESHOT", "PERIODIC", "INTERVAL"};
 
-    for (int i = 0; i < AKIRA_MAX_TIMERS; i++)
+    if (!timer_mgr.initialized)
     {
-        akira_timer_t *t = &timer_mgr.timers[i];
-        if (t->in_use)
-        {
-            LOG_INF("  %s: %s %s period=%ums remaining=%ums fired=%u",
-                    t->name,
-                    mode_names[t->mode],
-                    state_names[t->state],
-                    t->period_ms,
-                    akira_timer_remaining(t),
-                    t->fire_count);
-        }
+        return;
     }
-}
\ No newline at end of file
+
+    k_mutex_lock(&timer_mgr.mutex, K_FOREVER);
+
+    akira_timer_t *t;
+    SYS_DLIST_FOR_EACH_CONTAINER(&timer_mgr.all, t, all_node)
+    {
+        LOG_INF("  %s: %s %s period=%ums slack=%ums remaining=%ums fired=%u",
+                t->name,
+                mode_names[t->mode],
+                state_names[t->state],
+                t->period_ms,
+                t->slack_ms,
+                akira_timer_remaining(t),
+                t->fire_count);
+    }
+
+    k_mutex_unlock(&timer_mgr.mutex);
+}
@@ -4,6 +4,17 @@
  *
  * Provides software timers, periodic callbacks, and time utilities
  * built on top of Zephyr's timer infrastructure.
+ *
+ * Timers are kept in a hierarchical timing wheel driven by one kernel
+ * timer, so starting, stopping and expiring a timer take constant time
+ * and the number of timers is only limited by the heap. Callbacks run on
+ * the system work queue with millisecond resolution.
+ *
+ * A timer created with a slack may fire up to slack_ms late. The wheel
+ * uses that window to join a wakeup that is already scheduled, or to
+ * round the expiry to a coarse boundary shared with other timers, so
+ * that periodic work from different subsystems wakes the CPU once
+ * instead of on each of its own schedules.
  */
 
 #ifndef AKIRA_KERNEL_TIMER_H
@@ -18,13 +29,6 @@ extern "C"
 {
 #endif
 
-/*===========================================================================*/
-/* Constants                                                                 */
-/*===========================================================================*/
-
-/** Maximum number of software timers */
-#define AKIRA_MAX_TIMERS 32
-
     /*===========================================================================*/
     /* Timer Types                                                               */
     /*===========================================================================*/
@@ -55,6 +59,10 @@ extern "C"
 
     /**
      * @brief Timer callback function
+     *
+     * Called from the system work queue. The callback may start, stop or
+     * destroy any timer, including the one that fired.
+     *
      * @param timer Timer that expired
      * @param user_data User-provided context
      */
@@ -71,6 +79,7 @@ extern "C"
         akira_timer_mode_t mode;         /**< Timer mode */
         akira_duration_t period_ms;      /**< Period in milliseconds */
         akira_duration_t initial_ms;     /**< Initial delay (0 = use period) */
+        akira_duration_t slack_ms;       /**< Tolerated lateness (0 = exact) */
         akira_timer_callback_t callback; /**< Expiry callback */
         void *user_data;                 /**< User context */
         bool start_immediately;          /**< Start on creation */
@@ -84,10 +93,20 @@ extern "C"
         akira_timer_mode_t mode;       /**< Timer mode */
         akira_timer_state_t state;     /**< Current state */
         akira_duration_t period_ms;    /**< Period in milliseconds */
+        akira_duration_t slack_ms;     /**< Tolerated lateness */
         akira_duration_t remaining_ms; /**< Time until expiry */
         uint32_t fire_count;           /**< Number of times fired */
     } akira_timer_info_t;
 
+    /** Timer subsystem statistics */
+    typedef struct
+    {
+        uint32_t wakeups;     /**< Times the kernel timer fired */
+        uint32_t expirations; /**< Timer callbacks run */
+        uint32_t deferred;    /**< Expirations moved later by their slack */
+        uint32_t uptime_ms;   /**< Time the counters cover */
+    } akira_timer_stats_t;
+
     /*===========================================================================*/
     /* Timer API                                                                 */
     /*===========================================================================*/
@@ -187,6 +206,18 @@ extern "C"
                                  akira_timer_callback_t callback,
                                  void *user_data);
 
+    /**
+     * @brief Change timer slack
+     *
+     * A pending expiry of a running timer is moved into the new window
+     * right away; its nominal fire time does not change.
+     *
+     * @param timer Timer to modify
+     * @param slack_ms How late the timer may fire (0 = exact)
+     * @return 0 on success
+     */
+    int akira_timer_set_slack(akira_timer_t *timer, akira_duration_t slack_ms);
+
     /*===========================================================================*/
     /* Convenience Functions                                                     */
     /*===========================================================================*/
@@ -287,6 +318,13 @@ extern "C"
      */
     int akira_timer_count(void);
 
+    /**
+     * @brief Get wakeup and coalescing statistics
+     * @param stats Output statistics
+     * @return 0 on success
+     */
+    int akira_timer_get_stats(akira_timer_stats_t *stats);
+
     /**
      * @brief Print timer status
      */
@@ -0,0 +1,128 @@
+/**
+ * @file trace.c
+ * @brief AkiraOS Binary Event Trace Implementation
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include "trace.h"
+#ifdef CONFIG_ARCH_POSIX
+#include "host_file.h"
+#endif
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_AKIRA_EVENT_TRACE_RECORDS),
+             "CONFIG_AKIRA_EVENT_TRACE_RECORDS must be a power of two");
+BUILD_ASSERT(sizeof(akira_trace_rec_t) == AKIRA_TRACE_DUMP_REC_SIZE,
+             "Trace record layout changed");
+
+#define TRACE_FLAG_WRAPPED BIT(0)
+
+/*===========================================================================*/
+/* Internal State                                                            */
+/*===========================================================================*/
+
+/* Records from boot on; stop with `akira trace off` */
+struct akira_trace_ring akira_trace_ring = {
+    .enabled = true,
+};
+
+/*===========================================================================*/
+/* Trace API                                                                 */
+/*===========================================================================*/
+
+void akira_trace_enable(bool enable)
+{
+    akira_trace_ring.enabled = enable;
+}
+
+bool akira_trace_enabled(void)
+{
+    return akira_trace_ring.enabled;
+}
+
+void akira_trace_clear(void)
+{
+    atomic_set(&akira_trace_ring.head, 0);
+}
+
+size_t akira_trace_dump_size(void)
+{
+    /* Records keep arriving, so size for a full ring */
+    return AKIRA_TRACE_DUMP_HDR_SIZE +
+           (size_t)CONFIG_AKIRA_EVENT_TRACE_RECORDS * AKIRA_TRACE_DUMP_REC_SIZE;
+}
+
+int akira_trace_dump(uint8_t *buf, size_t len)
+{
+    if (!buf || len < AKIRA_TRACE_DUMP_HDR_SIZE)
+    {
+        return -ENOMEM;
+    }
+
+    /* Writers that already passed the enabled check finish within a few
+     * instructions; a record caught mid-write is at worst garbled.
+     */
+    bool was_enabled = akira_trace_ring.enabled;
+    akira_trace_ring.enabled = false;
+
+    uint32_t head = (uint32_t)atomic_get(&akira_trace_ring.head);
+    uint32_t count = MIN(head, CONFIG_AKIRA_EVENT_TRACE_RECORDS);
+
+    if (len < AKIRA_TRACE_DUMP_HDR_SIZE + (size_t)count * AKIRA_TRACE_DUMP_REC_SIZE)
+    {
+        akira_trace_ring.enabled = was_enabled;
+        return -ENOMEM;
+    }
+
+    uint8_t *p = buf + AKIRA_TRACE_DUMP_HDR_SIZE;
+
+    for (uint32_t n = head - count; n != head; n++)
+    {
+        const akira_trace_rec_t *rec =
+            &akira_trace_ring.recs[n & (CONFIG_AKIRA_EVENT_TRACE_RECORDS - 1)];
+
+        sys_put_le32(rec->cycles, p);
+        p[4] = rec->kind;
+        p[5] = 0;
+        sys_put_le16(rec->type, p + 6);
+        sys_put_le32(rec->source, p + 8);
+        sys_put_le32(rec->arg, p + 12);
+
+        p += AKIRA_TRACE_DUMP_REC_SIZE;
+    }
+
+    akira_trace_ring.enabled = was_enabled;
+
+    memcpy(buf, AKIRA_TRACE_DUMP_MAGIC, 4);
+    sys_put_le16(AKIRA_TRACE_DUMP_VERSION, buf + 4);
+    sys_put_le16(head > count ? TRACE_FLAG_WRAPPED : 0, buf + 6);
+    sys_put_le32(sys_clock_hw_cycles_per_sec(), buf + 8);
+    sys_put_le32(count, buf + 12);
+
+    return p - buf;
+}
+
+int akira_trace_save(const char *path)
+{
+#ifdef CONFIG_ARCH_POSIX
+    size_t len = akira_trace_dump_size();
+    uint8_t *buf = k_malloc(len);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    int ret = akira_trace_dump(buf, len);
+    if (ret > 0)
+    {
+        ret = akira_host_write_file(path, buf, ret);
+    }
+
+    k_free(buf);
+    return ret;
+#else
+    ARG_UNUSED(path);
+    return -ENOTSUP;
+#endif
+}
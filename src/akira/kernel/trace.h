@@ -0,0 +1,168 @@
+/**
+ * @file trace.h
+ * @brief AkiraOS Binary Event Trace
+ *
+ * Opt-in (CONFIG_AKIRA_EVENT_TRACE) ring of fixed-size records written
+ * at event post and delivery, message bus dispatch, timer expiry and app
+ * state changes. Each record holds a cycle counter timestamp, a kind, an
+ * event type and a source; writing one is an atomic increment and four
+ * stores. With tracing disabled the AKIRA_TRACE() hooks compile to
+ * nothing.
+ *
+ * The ring is dumped with `akira trace dump`, GET /api/trace or a file
+ * on native_sim, and decoded by tools/akira_trace.py.
+ */
+
+#ifndef AKIRA_KERNEL_TRACE_H
+#define AKIRA_KERNEL_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef CONFIG_AKIRA_EVENT_TRACE
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*===========================================================================*/
+/* Constants                                                                 */
+/*===========================================================================*/
+
+/** Number of records kept (power of two); older ones are overwritten */
+#ifndef CONFIG_AKIRA_EVENT_TRACE_RECORDS
+#define CONFIG_AKIRA_EVENT_TRACE_RECORDS 1024
+#endif
+
+/** Record kinds; type/source/arg meaning per kind */
+#define AKIRA_TRACE_EVENT_POST 1     /**< Event queued; arg = queue position */
+#define AKIRA_TRACE_EVENT_COALESCE 2 /**< Event folded into a pending one */
+#define AKIRA_TRACE_EVENT_DROP 3     /**< Event lost, queue full */
+#define AKIRA_TRACE_EVENT_PUBLISH 4  /**< Synchronous publish */
+#define AKIRA_TRACE_EVENT_DELIVER 5  /**< Handlers start; arg = queue position or ~0 */
+#define AKIRA_TRACE_EVENT_DONE 6     /**< Handlers returned; arg = handlers run */
+#define AKIRA_TRACE_MSG_SEND 7       /**< Message queued; source = sender, arg = msg id */
+#define AKIRA_TRACE_MSG_DISPATCH 8   /**< Message fanned out; arg = msg id */
+#define AKIRA_TRACE_TIMER_EXPIRE 9   /**< Timer fired; source = timer id, arg = count */
+#define AKIRA_TRACE_APP_STATE 10     /**< App state change; source = app id, type = new, arg = old */
+
+/** Binary dump format */
+#define AKIRA_TRACE_DUMP_MAGIC "AETR"
+#define AKIRA_TRACE_DUMP_VERSION 1
+#define AKIRA_TRACE_DUMP_HDR_SIZE 16
+#define AKIRA_TRACE_DUMP_REC_SIZE 16
+
+    /*===========================================================================*/
+    /* Types                                                                     */
+    /*===========================================================================*/
+
+    /** One trace record */
+    typedef struct
+    {
+        uint32_t cycles; /**< k_cycle_get_32() */
+        uint8_t kind;    /**< AKIRA_TRACE_* */
+        uint8_t reserved;
+        uint16_t type;   /**< Event type or kind-specific */
+        uint32_t source; /**< Source ID */
+        uint32_t arg;    /**< Kind-specific argument */
+    } akira_trace_rec_t;
+
+#ifdef CONFIG_AKIRA_EVENT_TRACE
+
+    /** Trace ring; written through akira_trace() only */
+    struct akira_trace_ring
+    {
+        atomic_t head; /**< Records written since the last clear */
+        bool enabled;
+        akira_trace_rec_t recs[CONFIG_AKIRA_EVENT_TRACE_RECORDS];
+    };
+
+    extern struct akira_trace_ring akira_trace_ring;
+
+    /**
+     * @brief Append a record; safe from any context
+     */
+    static inline void akira_trace(uint8_t kind, uint16_t type, uint32_t source, uint32_t arg)
+    {
+        if (!akira_trace_ring.enabled)
+        {
+            return;
+        }
+
+        uint32_t i = (uint32_t)atomic_inc(&akira_trace_ring.head) &
+                     (CONFIG_AKIRA_EVENT_TRACE_RECORDS - 1);
+        akira_trace_rec_t *rec = &akira_trace_ring.recs[i];
+
+        rec->cycles = k_cycle_get_32();
+        rec->kind = kind;
+        rec->type = type;
+        rec->source = source;
+        rec->arg = arg;
+    }
+
+#define AKIRA_TRACE(kind, type, source, arg) \
+    akira_trace((kind), (uint16_t)(type), (uint32_t)(source), (uint32_t)(arg))
+
+#else
+
+#define AKIRA_TRACE(kind, type, source, arg) \
+    do                                       \
+    {                                        \
+    } while (0)
+
+#endif /* CONFIG_AKIRA_EVENT_TRACE */
+
+    /*===========================================================================*/
+    /* Trace API                                                                 */
+    /*===========================================================================*/
+
+    /**
+     * @brief Start or stop recording
+     */
+    void akira_trace_enable(bool enable);
+
+    /**
+     * @brief Whether records are being written
+     */
+    bool akira_trace_enabled(void);
+
+    /**
+     * @brief Drop every record
+     */
+    void akira_trace_clear(void);
+
+    /**
+     * @brief Buffer size that always fits a binary dump of the ring
+     */
+    size_t akira_trace_dump_size(void);
+
+    /**
+     * @brief Serialize the ring, oldest record first
+     *
+     * Little-endian: a 16-byte header ("AETR", version, flags, cycles per
+     * second, record count) followed by one 16-byte record each.
+     * Recording is paused while the ring is copied.
+     *
+     * @param buf Output buffer
+     * @param len Buffer size
+     * @return Bytes written, -ENOMEM if buf is too small
+     */
+    int akira_trace_dump(uint8_t *buf, size_t len);
+
+    /**
+     * @brief Write a binary dump to a file on the host (native_sim only)
+     * @param path Host file path
+     * @return 0 on success, negative on error
+     */
+    int akira_trace_save(const char *path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_KERNEL_TRACE_H */
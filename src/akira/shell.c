@@ -10,6 +10,9 @@
 #include <zephyr/kernel.h>
 #include "akira.h"
 #include "kernel/psram.h"
+#include "kernel/memprof.h"
+#include "kernel/reclaim.h"
+#include <stdlib.h>
 
 /*===========================================================================*/
 /* Shell Command Handlers                                                    */
@@ -79,6 +82,40 @@ static int cmd_akira_memory(const struct shell *sh, size_t argc, char **argv)
     return 0;
 }
 
+static int cmd_akira_reclaim(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    static const char *const domain_names[AKIRA_MEM_DOMAIN_COUNT] = {"heap", "pool", "psram"};
+    static const char *const level_names[] = {"none", "low", "critical"};
+
+    shell_print(sh, "%-6s %-8s %9s %6s %6s %7s %6s %9s", "domain", "level", "low/crit",
+                "lows", "crits", "rescued", "failed", "reclaimed");
+
+    for (int d = 0; d < AKIRA_MEM_DOMAIN_COUNT; d++)
+    {
+        akira_reclaim_stats_t st;
+
+        akira_reclaim_get_stats(d, &st);
+        shell_print(sh, "%-6s %-8s %4u%%/%2u%% %6u %6u %7u %6u %9zu", domain_names[d],
+                    level_names[st.level], st.low_pct, st.critical_pct, st.low_events,
+                    st.critical_events, st.rescued, st.failed, st.reclaimed);
+    }
+
+    akira_reclaimer_info_t info[CONFIG_AKIRA_MEM_RECLAIMERS];
+    int n = akira_reclaim_list(info, ARRAY_SIZE(info));
+
+    shell_print(sh, "--- Reclaimers (%d) ---", n);
+    for (int i = 0; i < n; i++)
+    {
+        shell_print(sh, "%-16s prio %4d, %u calls, %zu bytes", info[i].name, info[i].priority,
+                    info[i].calls, info[i].reclaimed);
+    }
+
+    return 0;
+}
+
 static int cmd_akira_psram(const struct shell *sh, size_t argc, char **argv)
 {
     ARG_UNUSED(argc);
@@ -112,6 +149,26 @@ static int cmd_akira_psram(const struct shell *sh, size_t argc, char **argv)
     shell_print(sh, "Frees:   %u", stats.free_count);
     shell_print(sh, "Failures: %u", stats.alloc_failures);
 
+    akira_tier_stats_t tiers;
+    akira_tier_get_stats(&tiers);
+
+    static const char *const hint_names[AKIRA_MEM_HINT_COUNT] = {"hot", "cold", "stream", "dma"};
+
+    shell_print(sh, "--- Tiers ---");
+    shell_print(sh, "Live:    SRAM %zu bytes, PSRAM %zu bytes",
+                tiers.live_bytes[AKIRA_MEM_TIER_SRAM], tiers.live_bytes[AKIRA_MEM_TIER_PSRAM]);
+    for (int h = 0; h < AKIRA_MEM_HINT_COUNT; h++)
+    {
+        shell_print(sh, "%-8s SRAM %u, PSRAM %u", hint_names[h],
+                    tiers.placed[h][AKIRA_MEM_TIER_SRAM], tiers.placed[h][AKIRA_MEM_TIER_PSRAM]);
+    }
+    shell_print(sh, "Misplaced: %u (%zu bytes), Fallbacks: %u, Rebalanced: %u, Failures: %u",
+                tiers.misplaced_count, tiers.misplaced_bytes, tiers.fallbacks,
+                tiers.rebalanced, tiers.failures);
+#ifdef CONFIG_AKIRA_PSRAM_EMULATE
+    shell_print(sh, "Emulated stall: %llu us", (unsigned long long)(tiers.stall_ns / 1000));
+#endif
+
     return 0;
 }
 
@@ -212,6 +269,196 @@ static int cmd_service_stop(const struct shell *sh, size_t argc, char **argv)
     return 0;
 }
 
+#ifdef CONFIG_AKIRA_MEM_PROFILER
+
+static void memprof_print_site(const struct shell *sh, const akira_memprof_site_t *s,
+                               uint32_t elapsed_ms)
+{
+    char sym[64] = "";
+
+    akira_memprof_symbolize(s->site, sym, sizeof(sym));
+    shell_print(sh, "0x%08lx %3u %8u %6u %8u %5u.%02u %8u  %s",
+                (unsigned long)s->site, s->tag, s->live_bytes, s->live_count,
+                s->peak_bytes,
+                s->live_bytes ? s->peak_bytes / s->live_bytes : 0,
+                s->live_bytes ? (s->peak_bytes % s->live_bytes) * 100 / s->live_bytes : 0,
+                elapsed_ms ? (uint32_t)((uint64_t)s->alloc_count * 1000 / elapsed_ms) : 0,
+                sym);
+}
+
+static int cmd_memprof_top(const struct shell *sh, size_t argc, char **argv)
+{
+    int max = argc > 1 ? atoi(argv[1]) : 10;
+    akira_memprof_site_t sites[32];
+
+    max = CLAMP(max, 1, (int)ARRAY_SIZE(sites));
+
+    uint32_t elapsed = akira_memprof_elapsed_ms();
+    int n = akira_memprof_top(sites, max);
+
+    shell_print(sh, "Top %d allocation sites over %u ms (site 0 = table overflow)", n, elapsed);
+    shell_print(sh, "%-10s %3s %8s %6s %8s %8s %8s  %s",
+                "Site", "Tag", "Live", "Blocks", "Peak", "Pk/Live", "Alloc/s", "Symbol");
+    for (int i = 0; i < n; i++)
+    {
+        memprof_print_site(sh, &sites[i], elapsed);
+    }
+    return 0;
+}
+
+static int cmd_memprof_leaks(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    akira_memprof_site_t sites[16];
+    int n = akira_memprof_check_leaks(sites, ARRAY_SIZE(sites));
+
+    shell_print(sh, "%d site(s) grew on the last %d checks", n, AKIRA_MEMPROF_LEAK_STREAK);
+    for (int i = 0; i < MIN(n, (int)ARRAY_SIZE(sites)); i++)
+    {
+        memprof_print_site(sh, &sites[i], akira_memprof_elapsed_ms());
+    }
+    return 0;
+}
+
+static int cmd_memprof_reset(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    akira_memprof_reset();
+    shell_print(sh, "Profiler counters reset");
+    return 0;
+}
+
+static int cmd_memprof_dump(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc > 1)
+    {
+        int ret = akira_memprof_save(argv[1]);
+        if (ret < 0)
+        {
+            shell_error(sh, "Failed to save dump: %d", ret);
+            return ret;
+        }
+        shell_print(sh, "Saved to %s", argv[1]);
+        return 0;
+    }
+
+    /* No host file system: print hex lines for tools/akira_memprof.py */
+    size_t len = akira_memprof_dump_size() + 8 * AKIRA_MEMPROF_DUMP_REC_SIZE;
+    uint8_t *buf = k_malloc(len);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    int n = akira_memprof_dump(buf, len);
+    for (int off = 0; off < n; off += AKIRA_MEMPROF_DUMP_REC_SIZE)
+    {
+        char line[2 * AKIRA_MEMPROF_DUMP_REC_SIZE + 1];
+        int chunk = MIN(n - off, AKIRA_MEMPROF_DUMP_REC_SIZE);
+
+        bin2hex(buf + off, chunk, line, sizeof(line));
+        shell_print(sh, "AMPF:%s", line);
+    }
+
+    k_free(buf);
+    return n < 0 ? n : 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_memprof,
+                               SHELL_CMD_ARG(top, NULL, "Top sites by live bytes [count]", cmd_memprof_top, 1, 1),
+                               SHELL_CMD(leaks, NULL, "Check for growing sites", cmd_memprof_leaks),
+                               SHELL_CMD(reset, NULL, "Reset rate and peak counters", cmd_memprof_reset),
+                               SHELL_CMD_ARG(dump, NULL, "Binary dump [host file]", cmd_memprof_dump, 1, 1),
+                               SHELL_SUBCMD_SET_END);
+
+#else
+/* SHELL_COND_CMD still references the set when the option is off */
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_memprof, SHELL_SUBCMD_SET_END);
+#endif /* CONFIG_AKIRA_MEM_PROFILER */
+
+#ifdef CONFIG_AKIRA_EVENT_TRACE
+
+static int cmd_trace_on(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    akira_trace_enable(true);
+    shell_print(sh, "Event trace on");
+    return 0;
+}
+
+static int cmd_trace_off(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    akira_trace_enable(false);
+    shell_print(sh, "Event trace off");
+    return 0;
+}
+
+static int cmd_trace_clear(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    akira_trace_clear();
+    shell_print(sh, "Event trace cleared");
+    return 0;
+}
+
+static int cmd_trace_dump(const struct shell *sh, size_t argc, char **argv)
+{
+    if (argc > 1)
+    {
+        int ret = akira_trace_save(argv[1]);
+        if (ret < 0)
+        {
+            shell_error(sh, "Failed to save trace: %d", ret);
+            return ret;
+        }
+        shell_print(sh, "Saved to %s", argv[1]);
+        return 0;
+    }
+
+    /* No host file system: print hex lines for tools/akira_trace.py */
+    size_t len = akira_trace_dump_size();
+    uint8_t *buf = k_malloc(len);
+    if (!buf)
+    {
+        return -ENOMEM;
+    }
+
+    int n = akira_trace_dump(buf, len);
+    for (int off = 0; off < n; off += 2 * AKIRA_TRACE_DUMP_REC_SIZE)
+    {
+        char line[4 * AKIRA_TRACE_DUMP_REC_SIZE + 1];
+        int chunk = MIN(n - off, 2 * AKIRA_TRACE_DUMP_REC_SIZE);
+
+        bin2hex(buf + off, chunk, line, sizeof(line));
+        shell_print(sh, "AETR:%s", line);
+    }
+
+    k_free(buf);
+    return n < 0 ? n : 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_trace,
+                               SHELL_CMD(on, NULL, "Start recording", cmd_trace_on),
+                               SHELL_CMD(off, NULL, "Stop recording", cmd_trace_off),
+                               SHELL_CMD(clear, NULL, "Drop all records", cmd_trace_clear),
+                               SHELL_CMD_ARG(dump, NULL, "Binary dump [host file]", cmd_trace_dump, 1, 1),
+                               SHELL_SUBCMD_SET_END);
+
+#else
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_trace, SHELL_SUBCMD_SET_END);
+#endif /* CONFIG_AKIRA_EVENT_TRACE */
+
 /*===========================================================================*/
 /* Shell Command Registration                                                */
 /*===========================================================================*/
@@ -229,6 +476,12 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_akira,
                                SHELL_CMD(uptime, NULL, "Show system uptime", cmd_akira_uptime),
                                SHELL_CMD(memory, NULL, "Show memory status", cmd_akira_memory),
                                SHELL_CMD(psram, NULL, "Show PSRAM status", cmd_akira_psram),
+                               SHELL_CMD(reclaim, NULL, "Show memory pressure and reclaimers",
+                                         cmd_akira_reclaim),
+                               SHELL_COND_CMD(CONFIG_AKIRA_MEM_PROFILER, memprof, &sub_memprof,
+                                              "Allocation-site profiler", NULL),
+                               SHELL_COND_CMD(CONFIG_AKIRA_EVENT_TRACE, trace, &sub_trace,
+                                              "Binary event trace", NULL),
                                SHELL_CMD(services, NULL, "Show services", cmd_akira_services),
                                SHELL_CMD(processes, NULL, "Show processes", cmd_akira_processes),
                                SHELL_CMD(timers, NULL, "Show timers", cmd_akira_timers),
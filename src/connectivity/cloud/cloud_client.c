@@ -10,6 +10,7 @@
 
 #include "cloud_client.h"
 #include "cloud_protocol.h"
+#include "akira/kernel/timer.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <string.h>
@@ -24,6 +25,9 @@ LOG_MODULE_REGISTER(cloud_client, CONFIG_AKIRA_LOG_LEVEL);
 #define WORKER_PRIORITY 5
 #define RX_QUEUE_ALIGN 4
 
+/* Heartbeats may run this fraction of a period late to share wakeups */
+#define HEARTBEAT_SLACK_DIV 4
+
 /*===========================================================================*/
 /* Private Types                                                             */
 /*===========================================================================*/
@@ -95,7 +99,7 @@ static struct
     bool worker_running;
 
     /* Heartbeat timer */
-    struct k_timer heartbeat_timer;
+    akira_timer_t *heartbeat_timer;
 
 } client;
 
@@ -110,7 +114,7 @@ static void worker_entry(void *p1, void *p2, void *p3);
 static void process_message(const cloud_message_t *msg, msg_source_t source);
 static void handle_ota_message(const cloud_message_t *msg, msg_source_t source);
 static void handle_app_message(const cloud_message_t *msg, msg_source_t source);
-static void heartbeat_handler(struct k_timer *timer);
+static void heartbeat_handler(akira_timer_t *timer, void *user_data);
 static int send_via_transport(const uint8_t *data, size_t len, msg_source_t dest);
 
 /*===========================================================================*/
@@ -144,9 +148,6 @@ int cloud_client_init(const cloud_client_config_t *config)
     k_mutex_init(&client.mutex);
     k_fifo_init(&client.rx_queue);
 
-    /* Initialize heartbeat timer */
-    k_timer_init(&client.heartbeat_timer, heartbeat_handler, NULL);
-
     /* Start worker thread */
     client.worker_running = true;
     k_thread_create(&client.worker_thread, worker_stack,
@@ -158,9 +159,20 @@ int cloud_client_init(const cloud_client_config_t *config)
     /* Start heartbeat if configured */
     if (client.config.heartbeat_interval_ms > 0)
     {
-        k_timer_start(&client.heartbeat_timer,
-                      K_MSEC(client.config.heartbeat_interval_ms),
-                      K_MSEC(client.config.heartbeat_interval_ms));
+        akira_timer_config_t heartbeat = {
+            .name = "cloud_heartbeat",
+            .mode = AKIRA_TIMER_PERIODIC,
+            .period_ms = client.config.heartbeat_interval_ms,
+            .slack_ms = client.config.heartbeat_interval_ms / HEARTBEAT_SLACK_DIV,
+            .callback = heartbeat_handler,
+            .start_immediately = true};
+
+        akira_timer_subsystem_init();
+        client.heartbeat_timer = akira_timer_create(&heartbeat);
+        if (!client.heartbeat_timer)
+        {
+            LOG_WRN("Heartbeat timer unavailable");
+        }
     }
 
     client.initialized = true;
@@ -183,7 +195,8 @@ int cloud_client_deinit(void)
     }
 
     /* Stop heartbeat */
-    k_timer_stop(&client.heartbeat_timer);
+    akira_timer_destroy(client.heartbeat_timer);
+    client.heartbeat_timer = NULL;
 
     /* Stop worker */
     client.worker_running = false;
@@ -861,9 +874,10 @@ static void handle_app_message(const cloud_message_t *msg, msg_source_t source)
     }
 }
 
-static void heartbeat_handler(struct k_timer *timer)
+static void heartbeat_handler(akira_timer_t *timer, void *user_data)
 {
     ARG_UNUSED(timer);
+    ARG_UNUSED(user_data);
     cloud_client_heartbeat();
 }
 
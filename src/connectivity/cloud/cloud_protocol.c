@@ -4,6 +4,7 @@
  */
 
 #include "cloud_protocol.h"
+#include "akira/kernel/memory.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <string.h>
@@ -84,7 +85,7 @@ int cloud_msg_parse(const uint8_t *buffer, size_t buffer_len, cloud_message_t *m
     /* Allocate and copy payload */
     if (msg->header.payload_len > 0)
     {
-        msg->payload = k_malloc(msg->header.payload_len);
+        msg->payload = akira_malloc(msg->header.payload_len);
         if (!msg->payload)
         {
             LOG_ERR("Failed to allocate payload");
@@ -104,7 +105,7 @@ void cloud_msg_free(cloud_message_t *msg)
 {
     if (msg && msg->payload)
     {
-        k_free(msg->payload);
+        akira_free(msg->payload);
         msg->payload = NULL;
         msg->header.payload_len = 0;
     }
@@ -4,6 +4,7 @@
  */
 
 #include "http_server.h"
+#include "kernel/arena.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/net/socket.h>
@@ -52,6 +53,9 @@ static struct
     int server_fd;
     bool running;
 
+    /* Request buffer and handler scratch memory, reset per request */
+    akira_arena_t arena;
+
     struct k_mutex mutex;
 } http_srv;
 
@@ -217,7 +221,7 @@ static http_route_t *find_route(http_method_t method, const char *path)
     return NULL;
 }
 
-static int handle_request(int client_fd, char *buffer, size_t len)
+static int handle_request(int client_fd, char *buffer, size_t len, akira_arena_t *arena)
 {
     /* Parse request line */
     char method_str[8] = {0};
@@ -267,6 +271,7 @@ static int handle_request(int client_fd, char *buffer, size_t len)
         .body = body,
         .body_len = body_len,
         .content_length = content_length,
+        .arena = arena,
     };
 
     /* Build response context */
@@ -378,6 +383,7 @@ static void server_thread_fn(void *p1, void *p2, void *p3)
     LOG_INF("HTTP server listening on port %d", HTTP_SERVER_PORT);
     http_srv.state = HTTP_SERVER_RUNNING;
     http_srv.running = true;
+    akira_arena_init(&http_srv.arena, HTTP_BUFFER_SIZE + 1024);
 
     /* Accept loop */
     while (http_srv.running)
@@ -401,20 +407,22 @@ static void server_thread_fn(void *p1, void *p2, void *p3)
         http_srv.stats.active_connections++;
 
         /* Read request */
-        char buffer[HTTP_BUFFER_SIZE];
-        ssize_t received = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+        char *buffer = akira_arena_alloc(&http_srv.arena, HTTP_BUFFER_SIZE);
+        ssize_t received = buffer ? recv(client_fd, buffer, HTTP_BUFFER_SIZE - 1, 0) : -1;
 
         if (received > 0)
         {
             buffer[received] = '\0';
             http_srv.stats.bytes_received += received;
-            handle_request(client_fd, buffer, received);
+            handle_request(client_fd, buffer, received, &http_srv.arena);
         }
 
         close(client_fd);
+        akira_arena_reset(&http_srv.arena);
         http_srv.stats.active_connections--;
     }
 
+    akira_arena_destroy(&http_srv.arena);
     close(http_srv.server_fd);
     http_srv.state = HTTP_SERVER_STOPPED;
 }
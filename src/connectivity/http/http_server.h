@@ -16,6 +16,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+struct akira_arena;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -77,6 +79,9 @@ extern "C"
 
         /* Headers access */
         const char *(*get_header)(const char *name);
+
+        /** Scratch memory freed when the request completes (see kernel/arena.h) */
+        struct akira_arena *arena;
     } http_request_t;
 
     /** HTTP response */
@@ -3,10 +3,16 @@
  * @brief Inter-Process Communication Message Bus Implementation
  * 
  * Provides asynchronous message passing for WASM apps and system services.
- * Uses Zephyr message queues for efficient delivery.
+ * Uses one Zephyr message queue per priority lane, drained in strict
+ * priority order by a dispatcher thread. Only headers travel
+ * through the queue; payloads live in reference-counted pool buffers that
+ * subscribers borrow instead of copying. The dispatcher fans each message
+ * out to bounded per-subscriber mailboxes, which are drained on the
+ * subscriber's own context so a slow handler only delays itself.
  */
 
 #include "message_bus.h"
+#include "akira/kernel/trace.h"
 #include <zephyr/kernel.h>
 #include <zephyr/sys/slist.h>
 #include <zephyr/logging/log.h>
@@ -14,67 +20,1046 @@
 
 LOG_MODULE_REGISTER(msg_bus, CONFIG_AKIRA_LOG_LEVEL);
 
-/* Message queue configuration */
-#define MSG_QUEUE_SIZE          32
+/* Message queue configuration: one lane per priority */
 #define MSG_QUEUE_ALIGN         4
+#define MSG_LANE_COUNT          (MSG_PRIORITY_URGENT + 1)
+
+/* Dispatcher thread */
+#define DISPATCH_STACK_SIZE     CONFIG_AKIRA_MSG_BUS_DISPATCH_STACK_SIZE
+#define DISPATCH_PRIORITY       CONFIG_AKIRA_MSG_BUS_DISPATCH_PRIORITY
+#define DISPATCH_URGENT_PRIORITY CONFIG_AKIRA_MSG_BUS_URGENT_PRIORITY
+
+/* Subscriber mailboxes */
+#define MAILBOX_MAX_DEPTH       CONFIG_AKIRA_MSG_BUS_MAILBOX_DEPTH
+#define MAILBOX_BATCH           8
+#define ENVELOPE_COUNT          CONFIG_AKIRA_MSG_BUS_ENVELOPES
+#define DELIVER_STACK_SIZE      CONFIG_AKIRA_MSG_BUS_DELIVER_STACK_SIZE
+#define DELIVER_PRIORITY        CONFIG_AKIRA_MSG_BUS_DELIVER_PRIORITY
+#define MAILBOX_BLOCK_MAX       K_MSEC(CONFIG_AKIRA_MSG_BUS_BLOCK_MAX_MS)
+
+/* Payload pool: variable-sized, reference-counted buffers */
+K_HEAP_DEFINE(msg_payload_pool, CONFIG_AKIRA_MSG_BUS_POOL_SIZE);
+
+/* Topic index configuration */
+#define TOPIC_MAX_NODES         CONFIG_AKIRA_MSG_BUS_TOPIC_NODES
+#define TOPIC_NODE_NONE         0xFFFF
+#define TOPIC_ROOT              0
 
 /* Pending reply tracking */
-#define MAX_PENDING_REPLIES     8
+#define MAX_PENDING_REPLIES     CONFIG_AKIRA_MSG_BUS_MAX_PENDING_REPLIES
+#define REPLY_SLOT_MASK         0xFFFF
+#define REPLY_LEASE_MS          CONFIG_AKIRA_MSG_BUS_REPLY_LEASE_MS
+
+/**
+ * @brief Topic trie node
+ *
+ * One node per filter level. Literal children are chained through
+ * next_sibling and identified by a hash of their segment; the '+' and '#'
+ * children hang off dedicated slots so a lookup never scans them. Hash
+ * collisions are resolved by re-checking the full filter at delivery.
+ */
+struct topic_node {
+	uint32_t hash;
+	uint16_t parent;
+	uint16_t first_child;
+	uint16_t next_sibling;     // Also links the free list
+	uint16_t plus_child;
+	uint16_t hash_child;
+	uint8_t seg_len;
+	bool in_use;
+	sys_slist_t subs;          // Subscribers whose filter ends here
+};
+
+/**
+ * @brief Dispatched message shared by every mailbox it is queued in
+ */
+struct msg_envelope {
+	atomic_t ref;
+	struct akira_message msg;
+};
+
+/**
+ * @brief Bounded per-subscriber mailbox
+ */
+struct msg_mailbox {
+	struct k_spinlock lock;
+	struct msg_envelope *slots[MAILBOX_MAX_DEPTH];
+	uint16_t head;
+	uint16_t count;
+	uint16_t depth;
+	msg_overflow_t overflow;
+	k_timeout_t block_timeout;
+	struct k_sem space;        // Signalled on pop (MSG_OVERFLOW_BLOCK)
+	struct k_sem avail;        // Signalled on push (manual drain)
+	struct k_work_q *work_q;   // NULL when drained manually
+	struct k_work work;
+	
+	/* Statistics */
+	uint32_t delivered;
+	uint32_t dropped;
+	uint32_t coalesced;
+	uint16_t max_lag;
+};
+
+/**
+ * @brief Subscriber slot
+ *
+ * A slot is referenced by its subscription, by the dispatcher while it is
+ * pushing into the mailbox and by every queued run of the drain work. It
+ * is only reused once all references are gone, so a handler may safely
+ * unsubscribe itself.
+ */
+struct bus_subscriber {
+	struct msg_subscriber info;
+	sys_snode_t node;          // Link in topic_node.subs
+	uint16_t trie_node;
+	bool in_use;
+	bool closing;
+	atomic_t refs;
+	struct msg_mailbox mbox;
+};
+
+/**
+ * @brief Reply slot state
+ */
+enum reply_state {
+	REPLY_FREE = 0,
+	REPLY_WAITING,
+	REPLY_DONE,
+	REPLY_CANCELLED,
+};
+
+/**
+ * @brief Outstanding request awaiting its reply
+ *
+ * Requests carry (generation << 16 | slot + 1) as correlation ID, so a
+ * reply finds its waiter without searching and a late reply to a slot
+ * that has since been reused is rejected. A slot nobody is waiting on
+ * is reclaimed once its lease runs out, so a sender that never collects
+ * its reply cannot leak it.
+ */
+struct reply_slot {
+	uint32_t msg_id;
+	uint16_t generation;
+	enum reply_state state;
+	bool waiter;               // A thread is blocked in reply_slot_wait()
+	int64_t claimed;           // Uptime (ms) the request was sent
+	struct k_sem sem;
+	struct msg_header reply_header;
+	struct msg_buf *reply_buf;  // Handed over by the replier
+};
+
+/**
+ * @brief Subscribers matched for a single message
+ */
+struct match_set {
+	uint16_t count;
+	struct bus_subscriber *subs[MSG_MAX_SUBSCRIBERS];
+};
+
+/**
+ * @brief Priority lane
+ */
+struct msg_lane {
+	struct k_msgq queue;
+	msg_drop_policy_t policy;
+	uint32_t dropped;
+};
+
+/* Lane storage: only headers and buffer pointers are queued */
+static char __aligned(MSG_QUEUE_ALIGN)
+	lane_buf_low[CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_LOW * sizeof(struct akira_message)];
+static char __aligned(MSG_QUEUE_ALIGN)
+	lane_buf_normal[CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_NORMAL * sizeof(struct akira_message)];
+static char __aligned(MSG_QUEUE_ALIGN)
+	lane_buf_high[CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_HIGH * sizeof(struct akira_message)];
+static char __aligned(MSG_QUEUE_ALIGN)
+	lane_buf_urgent[CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_URGENT * sizeof(struct akira_message)];
+
+#ifdef CONFIG_AKIRA_MSG_BUS_DISPATCH_THREAD
+static K_THREAD_STACK_DEFINE(dispatch_stack, DISPATCH_STACK_SIZE);
+#endif
+
+/* Shared delivery queue for subscribers without their own context */
+static K_THREAD_STACK_DEFINE(deliver_stack, DELIVER_STACK_SIZE);
+
+/* Envelopes for messages in flight between dispatcher and mailboxes */
+K_MEM_SLAB_DEFINE_STATIC(msg_envelope_slab, sizeof(struct msg_envelope),
+                         ENVELOPE_COUNT, 4);
 
 /* Message bus state */
 static struct {
 	bool initialized;
-	uint32_t next_msg_id;
+	atomic_t next_msg_id;
 	uint32_t next_subscriber_id;
 	
-	/* Message queue */
-	struct k_msgq msg_queue;
-	char __aligned(MSG_QUEUE_ALIGN) msg_queue_buf[MSG_QUEUE_SIZE * sizeof(struct akira_message)];
+	/* Priority lanes, drained highest first */
+	struct msg_lane lanes[MSG_LANE_COUNT];
+	struct k_sem dispatch_sem;
+	
+	/* Dispatcher thread */
+	struct k_thread dispatch_thread;
+	atomic_t urgent_boost;
+	
+	/* Default mailbox delivery context */
+	struct k_work_q deliver_q;
 	
 	/* Subscribers */
-	struct msg_subscriber subscribers[MSG_MAX_SUBSCRIBERS];
+	struct bus_subscriber subscribers[MSG_MAX_SUBSCRIBERS];
 	uint32_t subscriber_count;
 	struct k_mutex subscriber_mutex;
 	
-	/* Pending replies */
-	struct {
-		uint32_t msg_id;
-		struct k_sem sem;
-		struct akira_message *reply_buf;
-		bool received;
-	} pending_replies[MAX_PENDING_REPLIES];
+	/* Topic index */
+	struct topic_node nodes[TOPIC_MAX_NODES];
+	uint16_t free_node;
+	
+	/* Pending replies */
+	struct reply_slot pending_replies[MAX_PENDING_REPLIES];
+	struct k_spinlock reply_lock;
+	
+	/* Statistics */
+	uint32_t stats_sent;
+	uint32_t stats_received;
+	uint32_t stats_dropped;
+} bus_state;
+
+/**
+ * @brief Length of the topic level starting at p
+ */
+static size_t segment_len(const char *p)
+{
+	const char *slash = strchr(p, '/');
+	return slash ? (size_t)(slash - p) : strlen(p);
+}
+
+/**
+ * @brief FNV-1a hash of a topic level
+ */
+static uint32_t segment_hash(const char *seg, size_t len)
+{
+	uint32_t hash = 2166136261u;
+	
+	for (size_t i = 0; i < len; i++) {
+		hash ^= (uint8_t)seg[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+/**
+ * @brief Check if topic matches filter
+ *
+ * MQTT semantics: '+' matches exactly one level, '#' matches any remaining
+ * levels (including none) and must be last. A bare "*" filter is kept for
+ * compatibility and behaves like "#"; a "*" level behaves like "+".
+ */
+static bool topic_matches(const char *topic, const char *filter)
+{
+	if (strcmp(filter, "*") == 0) {
+		filter = "#";
+	}
+	
+	/* Wildcards never match system topics at the first level */
+	if (topic[0] == '$' && (filter[0] == '+' || filter[0] == '#' ||
+	                        filter[0] == '*')) {
+		return false;
+	}
+	
+	while (true) {
+		size_t flen = segment_len(filter);
+		size_t tlen = segment_len(topic);
+		
+		if (flen == 1 && filter[0] == '#') {
+			return true;
+		}
+		
+		bool single = flen == 1 && (filter[0] == '+' || filter[0] == '*');
+		if (!single && (flen != tlen || memcmp(filter, topic, flen) != 0)) {
+			return false;
+		}
+		
+		filter += flen;
+		topic += tlen;
+		
+		if (*filter == '\0' || *topic == '\0') {
+			/* "a/#" also matches "a" */
+			if (*topic == '\0' && strcmp(filter, "/#") == 0) {
+				return true;
+			}
+			return *filter == '\0' && *topic == '\0';
+		}
+		
+		filter++;
+		topic++;
+	}
+}
+
+/**
+ * @brief Validate a subscription filter
+ */
+static bool filter_valid(const char *filter)
+{
+	if (strcmp(filter, "*") == 0) {
+		return true;
+	}
+	
+	for (const char *p = filter; ; ) {
+		size_t len = segment_len(p);
+		bool has_wild = memchr(p, '+', len) || memchr(p, '#', len);
+		
+		/* Wildcards must occupy a whole level */
+		if (has_wild && len != 1) {
+			return false;
+		}
+		/* '#' must be the last level */
+		if (len == 1 && p[0] == '#' && p[1] != '\0') {
+			return false;
+		}
+		
+		p += len;
+		if (*p == '\0') {
+			return true;
+		}
+		p++;
+	}
+}
+
+static uint16_t node_alloc(uint16_t parent, uint32_t hash, size_t seg_len)
+{
+	uint16_t idx = bus_state.free_node;
+	if (idx == TOPIC_NODE_NONE) {
+		return TOPIC_NODE_NONE;
+	}
+	
+	struct topic_node *node = &bus_state.nodes[idx];
+	bus_state.free_node = node->next_sibling;
+	
+	node->hash = hash;
+	node->seg_len = seg_len;
+	node->parent = parent;
+	node->first_child = TOPIC_NODE_NONE;
+	node->next_sibling = TOPIC_NODE_NONE;
+	node->plus_child = TOPIC_NODE_NONE;
+	node->hash_child = TOPIC_NODE_NONE;
+	node->in_use = true;
+	sys_slist_init(&node->subs);
+	
+	return idx;
+}
+
+static uint16_t find_literal_child(const struct topic_node *node,
+                                   uint32_t hash, size_t len)
+{
+	uint16_t idx = node->first_child;
+	
+	while (idx != TOPIC_NODE_NONE) {
+		const struct topic_node *child = &bus_state.nodes[idx];
+		if (child->hash == hash && child->seg_len == len) {
+			return idx;
+		}
+		idx = child->next_sibling;
+	}
+	return TOPIC_NODE_NONE;
+}
+
+/**
+ * @brief Release empty nodes from idx up towards the root
+ */
+static void trie_prune(uint16_t idx)
+{
+	while (idx != TOPIC_ROOT) {
+		struct topic_node *node = &bus_state.nodes[idx];
+		
+		if (!sys_slist_is_empty(&node->subs) ||
+		    node->first_child != TOPIC_NODE_NONE ||
+		    node->plus_child != TOPIC_NODE_NONE ||
+		    node->hash_child != TOPIC_NODE_NONE) {
+			return;
+		}
+		
+		struct topic_node *parent = &bus_state.nodes[node->parent];
+		if (parent->plus_child == idx) {
+			parent->plus_child = TOPIC_NODE_NONE;
+		} else if (parent->hash_child == idx) {
+			parent->hash_child = TOPIC_NODE_NONE;
+		} else {
+			uint16_t *link = &parent->first_child;
+			while (*link != idx) {
+				link = &bus_state.nodes[*link].next_sibling;
+			}
+			*link = node->next_sibling;
+		}
+		
+		uint16_t parent_idx = node->parent;
+		node->in_use = false;
+		node->next_sibling = bus_state.free_node;
+		bus_state.free_node = idx;
+		idx = parent_idx;
+	}
+}
+
+/**
+ * @brief Find or create the trie node for a filter
+ */
+static uint16_t trie_insert(const char *filter)
+{
+	uint16_t idx = TOPIC_ROOT;
+	
+	if (strcmp(filter, "*") == 0) {
+		filter = "#";
+	}
+	
+	for (const char *p = filter; ; ) {
+		size_t len = segment_len(p);
+		struct topic_node *node = &bus_state.nodes[idx];
+		uint16_t *slot = NULL;
+		uint16_t child;
+		
+		if (len == 1 && (p[0] == '+' || p[0] == '*')) {
+			slot = &node->plus_child;
+			child = *slot;
+		} else if (len == 1 && p[0] == '#') {
+			slot = &node->hash_child;
+			child = *slot;
+		} else {
+			child = find_literal_child(node, segment_hash(p, len), len);
+		}
+		
+		if (child == TOPIC_NODE_NONE) {
+			child = node_alloc(idx, segment_hash(p, len), len);
+			if (child == TOPIC_NODE_NONE) {
+				trie_prune(idx);
+				return TOPIC_NODE_NONE;
+			}
+			if (slot) {
+				*slot = child;
+			} else {
+				bus_state.nodes[child].next_sibling = node->first_child;
+				node->first_child = child;
+			}
+		}
+		
+		idx = child;
+		p += len;
+		if (*p == '\0') {
+			return idx;
+		}
+		p++;
+	}
+}
+
+static void collect_node(uint16_t idx, struct match_set *set)
+{
+	struct bus_subscriber *sub;
+	
+	SYS_SLIST_FOR_EACH_CONTAINER(&bus_state.nodes[idx].subs, sub, node) {
+		if (set->count < MSG_MAX_SUBSCRIBERS) {
+			set->subs[set->count++] = sub;
+		}
+	}
+}
+
+/**
+ * @brief Collect subscribers whose filter matches the remaining levels
+ * @param level Start of the current topic level, NULL when exhausted
+ */
+static void trie_collect(uint16_t idx, const char *level, bool first,
+                         struct match_set *set)
+{
+	const struct topic_node *node = &bus_state.nodes[idx];
+	bool system = first && level && level[0] == '$';
+	
+	/* '#' matches the parent level and everything below it */
+	if (node->hash_child != TOPIC_NODE_NONE && !system) {
+		collect_node(node->hash_child, set);
+	}
+	
+	if (!level) {
+		collect_node(idx, set);
+		return;
+	}
+	
+	size_t len = segment_len(level);
+	const char *next = level[len] == '/' ? &level[len + 1] : NULL;
+	
+	if (node->plus_child != TOPIC_NODE_NONE && !system) {
+		trie_collect(node->plus_child, next, false, set);
+	}
+	
+	uint16_t child = find_literal_child(node, segment_hash(level, len), len);
+	if (child != TOPIC_NODE_NONE) {
+		trie_collect(child, next, false, set);
+	}
+}
+
+static struct bus_subscriber *find_subscriber(uint32_t id)
+{
+	for (int i = 0; i < MSG_MAX_SUBSCRIBERS; i++) {
+		if (bus_state.subscribers[i].in_use &&
+		    !bus_state.subscribers[i].closing &&
+		    bus_state.subscribers[i].info.id == id) {
+			return &bus_state.subscribers[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Resolve the subscribers a message should be delivered to
+ */
+static void match_subscribers(const struct akira_message *msg,
+                              struct match_set *set)
+{
+	set->count = 0;
+	
+	/* Point-to-point: exactly one recipient */
+	if (msg->header.recipient_id != 0) {
+		struct bus_subscriber *sub = find_subscriber(msg->header.recipient_id);
+		if (sub && (msg->header.topic[0] == '\0' ||
+		            topic_matches(msg->header.topic, sub->info.topic_filter))) {
+			set->subs[set->count++] = sub;
+		}
+		return;
+	}
+	
+	/* Topic-less broadcast reaches everyone */
+	if (msg->header.topic[0] == '\0') {
+		for (int i = 0; i < MSG_MAX_SUBSCRIBERS; i++) {
+			if (bus_state.subscribers[i].in_use &&
+			    !bus_state.subscribers[i].closing) {
+				set->subs[set->count++] = &bus_state.subscribers[i];
+			}
+		}
+		return;
+	}
+	
+	trie_collect(TOPIC_ROOT, msg->header.topic, true, set);
+	
+	/* Drop hash collisions */
+	uint16_t kept = 0;
+	for (uint16_t i = 0; i < set->count; i++) {
+		if (topic_matches(msg->header.topic, set->subs[i]->info.topic_filter)) {
+			set->subs[kept++] = set->subs[i];
+		}
+	}
+	set->count = kept;
+}
+
+static void envelope_unref(struct msg_envelope *env)
+{
+	/* atomic_dec() returns the previous value */
+	if (atomic_dec(&env->ref) == 1) {
+		msg_buf_unref(env->msg.buf);
+		k_mem_slab_free(&msg_envelope_slab, env);
+	}
+}
+
+/**
+ * @brief Drop a slot reference, recycling the slot on the last one
+ */
+static void subscriber_put(struct bus_subscriber *sub)
+{
+	if (atomic_dec(&sub->refs) != 1) {
+		return;
+	}
+	
+	struct msg_mailbox *mbox = &sub->mbox;
+	
+	while (mbox->count > 0) {
+		envelope_unref(mbox->slots[mbox->head]);
+		mbox->head = (mbox->head + 1) % MAILBOX_MAX_DEPTH;
+		mbox->count--;
+	}
+	
+	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
+	sub->in_use = false;
+	k_mutex_unlock(&bus_state.subscriber_mutex);
+}
+
+/**
+ * @brief Schedule the subscriber's drain work
+ */
+static void mailbox_kick(struct bus_subscriber *sub)
+{
+	struct msg_mailbox *mbox = &sub->mbox;
+	
+	if (!mbox->work_q) {
+		k_sem_give(&mbox->avail);
+		return;
+	}
+	
+	/* Every newly queued run owns a slot reference */
+	atomic_inc(&sub->refs);
+	if (k_work_submit_to_queue(mbox->work_q, &mbox->work) <= 0) {
+		atomic_dec(&sub->refs);
+	}
+}
+
+static void mailbox_drop(struct msg_mailbox *mbox)
+{
+	mbox->dropped++;
+	bus_state.stats_dropped++;
+}
+
+/**
+ * @brief Replace a queued message for the same topic, in place
+ *
+ * Called with the mailbox lock held.
+ * @return The envelope that was replaced, or NULL if none was queued
+ */
+static struct msg_envelope *mailbox_coalesce(struct msg_mailbox *mbox,
+                                             struct msg_envelope *env)
+{
+	for (uint16_t i = 0; i < mbox->count; i++) {
+		uint16_t idx = (mbox->head + i) % MAILBOX_MAX_DEPTH;
+		struct msg_envelope *queued = mbox->slots[idx];
+		
+		if (strcmp(queued->msg.header.topic, env->msg.header.topic) == 0) {
+			atomic_inc(&env->ref);
+			mbox->slots[idx] = env;
+			mbox->coalesced++;
+			return queued;
+		}
+	}
+	
+	return NULL;
+}
+
+/**
+ * @brief Queue an envelope in a subscriber mailbox
+ *
+ * MSG_OVERFLOW_COALESCE subscribers never hold two messages for the same
+ * topic: a newer one always replaces the queued one in place. Otherwise
+ * the subscriber's overflow policy applies once the mailbox is full.
+ * Called from the dispatcher without subscriber_mutex held, since
+ * MSG_OVERFLOW_BLOCK may wait for the subscriber to catch up. That wait
+ * is capped at CONFIG_AKIRA_MSG_BUS_BLOCK_MAX_MS so one stalled
+ * subscriber cannot hold up delivery to everyone else; past it the
+ * message is dropped and counted like any other overflow.
+ */
+static void mailbox_push(struct bus_subscriber *sub, struct msg_envelope *env)
+{
+	struct msg_mailbox *mbox = &sub->mbox;
+	bool waited = false;
+	
+	while (true) {
+		k_spinlock_key_t key = k_spin_lock(&mbox->lock);
+		
+		if (mbox->overflow == MSG_OVERFLOW_COALESCE) {
+			struct msg_envelope *stale = mailbox_coalesce(mbox, env);
+			
+			if (stale) {
+				k_spin_unlock(&mbox->lock, key);
+				envelope_unref(stale);
+				return;
+			}
+		}
+		
+		if (mbox->count < mbox->depth) {
+			uint16_t tail = (mbox->head + mbox->count) % MAILBOX_MAX_DEPTH;
+			atomic_inc(&env->ref);
+			mbox->slots[tail] = env;
+			mbox->count++;
+			if (mbox->count > mbox->max_lag) {
+				mbox->max_lag = mbox->count;
+			}
+			k_spin_unlock(&mbox->lock, key);
+			mailbox_kick(sub);
+			return;
+		}
+		
+		struct msg_envelope *victim = NULL;
+		
+		switch (mbox->overflow) {
+		case MSG_OVERFLOW_COALESCE:
+			/* Only reached with no queued entry for this topic:
+			 * make room like drop-oldest */
+			/* fall through */
+		case MSG_OVERFLOW_DROP_OLDEST:
+			victim = mbox->slots[mbox->head];
+			mbox->head = (mbox->head + 1) % MAILBOX_MAX_DEPTH;
+			mbox->count--;
+			mailbox_drop(mbox);
+			k_spin_unlock(&mbox->lock, key);
+			envelope_unref(victim);
+			continue;
+		case MSG_OVERFLOW_BLOCK:
+			if (!waited) {
+				k_sem_reset(&mbox->space);
+				k_spin_unlock(&mbox->lock, key);
+				waited = true;
+				if (k_sem_take(&mbox->space, mbox->block_timeout) == 0) {
+					continue;
+				}
+				LOG_WRN("Subscriber %u stalled, dropping message",
+				        sub->info.id);
+				key = k_spin_lock(&mbox->lock);
+			}
+			break;
+		case MSG_OVERFLOW_DROP_NEWEST:
+		default:
+			break;
+		}
+		
+		mailbox_drop(mbox);
+		k_spin_unlock(&mbox->lock, key);
+		return;
+	}
+}
+
+/**
+ * @brief Deliver up to max queued messages to the subscriber's handler
+ * @return Number of messages delivered
+ */
+static int mailbox_drain(struct bus_subscriber *sub, int max)
+{
+	struct msg_mailbox *mbox = &sub->mbox;
+	int delivered = 0;
+	
+	while (delivered < max && !sub->closing) {
+		k_spinlock_key_t key = k_spin_lock(&mbox->lock);
+		
+		if (mbox->count == 0) {
+			k_spin_unlock(&mbox->lock, key);
+			break;
+		}
+		
+		struct msg_envelope *env = mbox->slots[mbox->head];
+		mbox->head = (mbox->head + 1) % MAILBOX_MAX_DEPTH;
+		mbox->count--;
+		mbox->delivered++;
+		k_spin_unlock(&mbox->lock, key);
+		k_sem_give(&mbox->space);
+		
+		sub->info.handler(&env->msg, sub->info.user_data);
+		envelope_unref(env);
+		delivered++;
+	}
+	
+	return delivered;
+}
+
+static void mailbox_work_handler(struct k_work *work)
+{
+	struct msg_mailbox *mbox = CONTAINER_OF(work, struct msg_mailbox, work);
+	struct bus_subscriber *sub = CONTAINER_OF(mbox, struct bus_subscriber, mbox);
+	
+	/* Bounded batches keep the shared delivery queue fair */
+	if (mailbox_drain(sub, MAILBOX_BATCH) == MAILBOX_BATCH && mbox->count > 0) {
+		mailbox_kick(sub);
+	}
+	
+	subscriber_put(sub);
+}
+
+/**
+ * @brief Wake the dispatcher, boosting it for urgent traffic
+ */
+static void wake_dispatcher(msg_priority_t priority)
+{
+#ifdef CONFIG_AKIRA_MSG_BUS_DISPATCH_THREAD
+	/*
+	 * Urgent fast path: run the dispatcher above normal application
+	 * threads until the urgent lane is empty, so the message is delivered
+	 * as soon as the publisher's context allows instead of at the next
+	 * scheduling point of a low-priority dispatcher.
+	 */
+	if (priority == MSG_PRIORITY_URGENT && !k_is_in_isr() &&
+	    atomic_cas(&bus_state.urgent_boost, 0, 1)) {
+		k_thread_priority_set(&bus_state.dispatch_thread,
+		                      DISPATCH_URGENT_PRIORITY);
+	}
+#endif
+	k_sem_give(&bus_state.dispatch_sem);
+}
+
+/**
+ * @brief Queue a built message, releasing its payload on failure
+ */
+static int enqueue_message(struct akira_message *msg)
+{
+	if ((unsigned int)msg->header.priority >= MSG_LANE_COUNT) {
+		msg->header.priority = MSG_PRIORITY_URGENT;
+	}
+	
+	struct msg_lane *lane = &bus_state.lanes[msg->header.priority];
+	int ret = k_msgq_put(&lane->queue, msg, K_NO_WAIT);
+	
+	if (ret != 0 && lane->policy == MSG_DROP_OLDEST) {
+		/* Evict the stalest entry to make room for fresh data */
+		struct akira_message stale;
+		if (k_msgq_get(&lane->queue, &stale, K_NO_WAIT) == 0) {
+			msg_buf_unref(stale.buf);
+			lane->dropped++;
+			bus_state.stats_dropped++;
+		}
+		ret = k_msgq_put(&lane->queue, msg, K_NO_WAIT);
+	}
+	
+	if (ret != 0) {
+		lane->dropped++;
+		bus_state.stats_dropped++;
+		msg_buf_unref(msg->buf);
+		LOG_WRN("Lane %d full, dropping message", msg->header.priority);
+		return -EAGAIN;
+	}
+	
+	bus_state.stats_sent++;
+	AKIRA_TRACE(AKIRA_TRACE_MSG_SEND, msg->header.priority, msg->header.sender_id,
+	            msg->header.msg_id);
+	wake_dispatcher(msg->header.priority);
+	return 0;
+}
+
+/**
+ * @brief Take the next message in strict priority order
+ */
+static bool dequeue_message(struct akira_message *msg)
+{
+	for (int prio = MSG_PRIORITY_URGENT; prio >= MSG_PRIORITY_LOW; prio--) {
+		if (k_msgq_get(&bus_state.lanes[prio].queue, msg, K_NO_WAIT) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Fan one message out to the mailboxes of its subscribers
+ */
+static void dispatch_message(struct akira_message *msg, struct match_set *matches)
+{
+	bus_state.stats_received++;
+	AKIRA_TRACE(AKIRA_TRACE_MSG_DISPATCH, msg->header.priority, msg->header.sender_id,
+	            msg->header.msg_id);
+	
+	struct msg_envelope *env;
+	if (k_mem_slab_alloc(&msg_envelope_slab, (void **)&env, K_NO_WAIT) != 0) {
+		bus_state.stats_dropped++;
+		msg_buf_unref(msg->buf);
+		LOG_WRN("No envelope for message %u, dropping", msg->header.msg_id);
+		return;
+	}
+	
+	/* The envelope takes over the bus reference on the payload */
+	atomic_set(&env->ref, 1);
+	env->msg = *msg;
+	
+	/* Resolve recipients and pin their slots */
+	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
+	
+	match_subscribers(msg, matches);
+	
+	uint16_t kept = 0;
+	for (uint16_t i = 0; i < matches->count; i++) {
+		struct bus_subscriber *sub = matches->subs[i];
+		
+		/* Check priority filter */
+		if (msg->header.priority < sub->info.min_priority) {
+			continue;
+		}
+		
+		atomic_inc(&sub->refs);
+		matches->subs[kept++] = sub;
+	}
+	matches->count = kept;
+	
+	k_mutex_unlock(&bus_state.subscriber_mutex);
+	
+	/* Hand off; slow subscribers only fill their own mailbox */
+	for (uint16_t i = 0; i < matches->count; i++) {
+		mailbox_push(matches->subs[i], env);
+		subscriber_put(matches->subs[i]);
+	}
+	
+	envelope_unref(env);
+}
+
+#ifdef CONFIG_AKIRA_MSG_BUS_DISPATCH_THREAD
+static void dispatch_entry(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+	
+	struct akira_message msg;
+	struct match_set matches;
+	
+	while (true) {
+		k_sem_take(&bus_state.dispatch_sem, K_FOREVER);
+		
+		/* Lanes are re-checked from the top after every message */
+		while (dequeue_message(&msg)) {
+			dispatch_message(&msg, &matches);
+		}
+		
+		/* Urgent lane drained: drop back to the normal priority */
+		if (atomic_cas(&bus_state.urgent_boost, 1, 0)) {
+			k_thread_priority_set(&bus_state.dispatch_thread,
+			                      DISPATCH_PRIORITY);
+			
+			/* An urgent message may have slipped in before the reset */
+			if (k_msgq_num_used_get(&bus_state.lanes[MSG_PRIORITY_URGENT].queue) > 0 &&
+			    atomic_cas(&bus_state.urgent_boost, 0, 1)) {
+				k_thread_priority_set(&bus_state.dispatch_thread,
+				                      DISPATCH_URGENT_PRIORITY);
+			}
+		}
+	}
+}
+#endif
+
+/**
+ * @brief Copy a caller payload into a fresh pool buffer
+ */
+static int copy_to_buf(const void *payload, size_t len, struct msg_buf **out)
+{
+	*out = NULL;
+	
+	if (len == 0) {
+		return 0;
+	}
+	
+	struct msg_buf *buf = msg_buf_alloc(len, K_NO_WAIT);
+	if (!buf) {
+		bus_state.stats_dropped++;
+		LOG_WRN("Payload pool exhausted (%zu bytes)", len);
+		return -ENOMEM;
+	}
+	
+	memcpy(buf->data, payload, len);
+	buf->len = len;
+	*out = buf;
+	return 0;
+}
+
+/**
+ * @brief Allocate a non-zero message ID
+ */
+static uint32_t alloc_msg_id(void)
+{
+	uint32_t id;
+	
+	do {
+		id = (uint32_t)atomic_inc(&bus_state.next_msg_id);
+	} while (id == 0);
 	
-	/* Statistics */
-	uint32_t stats_sent;
-	uint32_t stats_received;
-	uint32_t stats_dropped;
-} bus_state;
+	return id;
+}
 
 /**
- * @brief Check if topic matches filter (supports * wildcard)
+ * @brief Return a slot to the pool, invalidating its correlation ID
  */
-static bool topic_matches(const char *topic, const char *filter)
+static void reply_slot_release(struct reply_slot *slot)
+{
+	msg_buf_unref(slot->reply_buf);
+	slot->reply_buf = NULL;
+	slot->msg_id = 0;
+	slot->generation++;
+	slot->waiter = false;
+	slot->state = REPLY_FREE;
+}
+
+/**
+ * @brief Free slots whose sender has stopped caring about the reply
+ *
+ * A slot without a waiter whose lease has expired belongs to a request
+ * that was never collected or cancelled. Call with reply_lock held.
+ */
+static void reply_slot_reclaim(void)
 {
-	// TODO: Implement topic matching with wildcards
-	// - Exact match
-	// - * matches any single level
-	// - # matches any remaining levels
+	int64_t now = k_uptime_get();
 	
-	/* Simple exact match for now */
-	return strcmp(topic, filter) == 0 || strcmp(filter, "*") == 0;
+	for (int i = 0; i < MAX_PENDING_REPLIES; i++) {
+		struct reply_slot *slot = &bus_state.pending_replies[i];
+		
+		if (slot->state != REPLY_FREE && !slot->waiter &&
+		    now - slot->claimed >= REPLY_LEASE_MS) {
+			reply_slot_release(slot);
+		}
+	}
+}
+
+/**
+ * @brief Claim a reply slot for a request
+ *
+ * Probing starts at msg_id so msg_bus_wait_reply() usually finds the slot
+ * on the first try. Must be called with reply_lock held.
+ */
+static struct reply_slot *reply_slot_claim(uint32_t msg_id)
+{
+	for (int pass = 0; pass < 2; pass++) {
+		for (int i = 0; i < MAX_PENDING_REPLIES; i++) {
+			struct reply_slot *slot =
+				&bus_state.pending_replies[(msg_id + i) % MAX_PENDING_REPLIES];
+			
+			if (slot->state == REPLY_FREE) {
+				slot->msg_id = msg_id;
+				slot->state = REPLY_WAITING;
+				slot->waiter = false;
+				slot->claimed = k_uptime_get();
+				slot->reply_buf = NULL;
+				k_sem_reset(&slot->sem);
+				return slot;
+			}
+		}
+		
+		/* Full: take back slots abandoned by their senders and retry */
+		reply_slot_reclaim();
+	}
+	return NULL;
 }
 
 /**
- * @brief Find free pending reply slot
+ * @brief Find the slot of an outstanding request. Call with reply_lock held.
  */
-static int find_free_reply_slot(void)
+static struct reply_slot *reply_slot_find(uint32_t msg_id)
 {
 	for (int i = 0; i < MAX_PENDING_REPLIES; i++) {
-		if (bus_state.pending_replies[i].msg_id == 0) {
-			return i;
+		struct reply_slot *slot =
+			&bus_state.pending_replies[(msg_id + i) % MAX_PENDING_REPLIES];
+		
+		if (slot->state != REPLY_FREE && slot->msg_id == msg_id) {
+			return slot;
 		}
 	}
-	return -1;
+	return NULL;
+}
+
+static uint32_t reply_correlation_id(const struct reply_slot *slot)
+{
+	uint32_t idx = slot - bus_state.pending_replies;
+	return ((uint32_t)slot->generation << 16) | (idx + 1);
+}
+
+/**
+ * @brief Wait on a claimed slot and collect the reply
+ */
+static int reply_slot_wait(struct reply_slot *slot, struct akira_message *reply,
+                           k_timeout_t timeout)
+{
+	k_sem_take(&slot->sem, timeout);
+	
+	k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+	
+	/* A reply racing the timeout still counts */
+	int ret;
+	if (slot->state == REPLY_DONE) {
+		reply->header = slot->reply_header;
+		reply->buf = slot->reply_buf;
+		reply->payload = slot->reply_buf ? slot->reply_buf->data : NULL;
+		slot->reply_buf = NULL;
+		ret = 0;
+	} else if (slot->state == REPLY_CANCELLED) {
+		ret = -ECANCELED;
+	} else {
+		ret = -ETIMEDOUT;
+	}
+	
+	reply_slot_release(slot);
+	k_spin_unlock(&bus_state.reply_lock, key);
+	
+	return ret;
 }
 
 int msg_bus_init(void)
@@ -85,65 +1070,195 @@ int msg_bus_init(void)
 	
 	LOG_INF("Initializing message bus");
 	
-	// TODO: Full initialization
-	// 1. Initialize message queue
-	// 2. Initialize subscriber mutex
-	// 3. Initialize reply semaphores
-	// 4. Start processing thread (optional)
+	static char *const lane_bufs[MSG_LANE_COUNT] = {
+		lane_buf_low, lane_buf_normal, lane_buf_high, lane_buf_urgent,
+	};
+	static const uint32_t lane_depths[MSG_LANE_COUNT] = {
+		CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_LOW,
+		CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_NORMAL,
+		CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_HIGH,
+		CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_URGENT,
+	};
 	
-	k_msgq_init(&bus_state.msg_queue, bus_state.msg_queue_buf,
-	            sizeof(struct akira_message), MSG_QUEUE_SIZE);
+	for (int i = 0; i < MSG_LANE_COUNT; i++) {
+		k_msgq_init(&bus_state.lanes[i].queue, lane_bufs[i],
+		            sizeof(struct akira_message), lane_depths[i]);
+		/* Bulk lanes prefer fresh data, control lanes never lose queued work */
+		bus_state.lanes[i].policy = (i <= MSG_PRIORITY_NORMAL) ?
+		                            MSG_DROP_OLDEST : MSG_DROP_NEWEST;
+		bus_state.lanes[i].dropped = 0;
+	}
+	k_sem_init(&bus_state.dispatch_sem, 0, K_SEM_MAX_LIMIT);
 	
 	k_mutex_init(&bus_state.subscriber_mutex);
 	
+	/* Topic index: root node plus a free list of the rest */
+	for (int i = 0; i < TOPIC_MAX_NODES; i++) {
+		bus_state.nodes[i].in_use = false;
+		bus_state.nodes[i].next_sibling =
+			(i + 1 < TOPIC_MAX_NODES) ? i + 1 : TOPIC_NODE_NONE;
+	}
+	bus_state.free_node = 0;
+	node_alloc(TOPIC_NODE_NONE, 0, 0);
+	
 	/* Initialize reply slots */
 	for (int i = 0; i < MAX_PENDING_REPLIES; i++) {
 		k_sem_init(&bus_state.pending_replies[i].sem, 0, 1);
 		bus_state.pending_replies[i].msg_id = 0;
+		bus_state.pending_replies[i].state = REPLY_FREE;
 	}
 	
-	bus_state.next_msg_id = 1;
+	atomic_set(&bus_state.next_msg_id, 1);
 	bus_state.next_subscriber_id = 1;
 	bus_state.initialized = true;
 	
+	k_work_queue_init(&bus_state.deliver_q);
+	k_work_queue_start(&bus_state.deliver_q, deliver_stack,
+	                   K_THREAD_STACK_SIZEOF(deliver_stack), DELIVER_PRIORITY,
+	                   &(struct k_work_queue_config){ .name = "msg_deliver" });
+	
+#ifdef CONFIG_AKIRA_MSG_BUS_DISPATCH_THREAD
+	atomic_set(&bus_state.urgent_boost, 0);
+	k_thread_create(&bus_state.dispatch_thread, dispatch_stack,
+	                K_THREAD_STACK_SIZEOF(dispatch_stack), dispatch_entry,
+	                NULL, NULL, NULL, DISPATCH_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&bus_state.dispatch_thread, "msg_dispatch");
+#endif
+	
 	LOG_INF("Message bus initialized");
 	return 0;
 }
 
+__weak uint32_t msg_bus_clock(void)
+{
+	return k_cycle_get_32();
+}
+
+struct msg_buf *msg_buf_alloc(size_t size, k_timeout_t timeout)
+{
+	if (size == 0 || size > MSG_MAX_PAYLOAD_SIZE) {
+		return NULL;
+	}
+	
+	struct msg_buf *buf = k_heap_alloc(&msg_payload_pool,
+	                                   sizeof(struct msg_buf) + size, timeout);
+	if (!buf) {
+		return NULL;
+	}
+	
+	atomic_set(&buf->ref, 1);
+	buf->size = size;
+	buf->len = 0;
+	return buf;
+}
+
+struct msg_buf *msg_buf_ref(struct msg_buf *buf)
+{
+	if (buf) {
+		atomic_inc(&buf->ref);
+	}
+	return buf;
+}
+
+void msg_buf_unref(struct msg_buf *buf)
+{
+	if (!buf) {
+		return;
+	}
+	
+	/* atomic_dec() returns the previous value */
+	if (atomic_dec(&buf->ref) == 1) {
+		k_heap_free(&msg_payload_pool, buf);
+	}
+}
+
 int msg_bus_subscribe(const char *topic, msg_handler_t handler, void *user_data)
+{
+	return msg_bus_subscribe_mailbox(topic, handler, user_data, NULL);
+}
+
+int msg_bus_subscribe_mailbox(const char *topic, msg_handler_t handler,
+                              void *user_data,
+                              const struct msg_mailbox_config *config)
 {
 	if (!bus_state.initialized) {
 		return -ENODEV;
 	}
 	
-	if (!topic || !handler) {
+	if (!topic || !handler || topic[0] == '\0' ||
+	    strlen(topic) >= MSG_MAX_TOPIC_LEN || !filter_valid(topic)) {
+		return -EINVAL;
+	}
+	
+	if (config && (config->depth > MAILBOX_MAX_DEPTH ||
+	               (unsigned int)config->overflow > MSG_OVERFLOW_COALESCE)) {
 		return -EINVAL;
 	}
 	
 	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
 	
-	if (bus_state.subscriber_count >= MSG_MAX_SUBSCRIBERS) {
+	struct bus_subscriber *sub = NULL;
+	for (int i = 0; i < MSG_MAX_SUBSCRIBERS; i++) {
+		if (!bus_state.subscribers[i].in_use) {
+			sub = &bus_state.subscribers[i];
+			break;
+		}
+	}
+	
+	if (!sub) {
 		k_mutex_unlock(&bus_state.subscriber_mutex);
 		LOG_ERR("Max subscribers reached");
 		return -ENOMEM;
 	}
 	
+	uint16_t node = trie_insert(topic);
+	if (node == TOPIC_NODE_NONE) {
+		k_mutex_unlock(&bus_state.subscriber_mutex);
+		LOG_ERR("Topic index full");
+		return -ENOMEM;
+	}
+	
 	// TODO: Check for duplicate subscriptions
 	
-	struct msg_subscriber *sub = &bus_state.subscribers[bus_state.subscriber_count];
-	sub->id = bus_state.next_subscriber_id++;
-	sub->handler = handler;
-	sub->user_data = user_data;
-	strncpy(sub->topic_filter, topic, MSG_MAX_TOPIC_LEN - 1);
-	sub->topic_filter[MSG_MAX_TOPIC_LEN - 1] = '\0';
-	sub->min_priority = MSG_PRIORITY_LOW;
+	sub->info.id = bus_state.next_subscriber_id++;
+	sub->info.handler = handler;
+	sub->info.user_data = user_data;
+	strncpy(sub->info.topic_filter, topic, MSG_MAX_TOPIC_LEN - 1);
+	sub->info.topic_filter[MSG_MAX_TOPIC_LEN - 1] = '\0';
+	sub->info.min_priority = MSG_PRIORITY_LOW;
+	sub->trie_node = node;
+	sub->closing = false;
+	atomic_set(&sub->refs, 1);
+	
+	/* Mailbox */
+	struct msg_mailbox *mbox = &sub->mbox;
+	memset(mbox, 0, sizeof(*mbox));
+	mbox->depth = (config && config->depth) ? config->depth : MAILBOX_MAX_DEPTH;
+	mbox->overflow = config ? config->overflow : MSG_OVERFLOW_DROP_OLDEST;
+	mbox->block_timeout = config ? config->block_timeout : K_NO_WAIT;
+	/* The dispatcher is shared: never let one mailbox stall it for long */
+	if (mbox->block_timeout.ticks < 0 ||
+	    mbox->block_timeout.ticks > MAILBOX_BLOCK_MAX.ticks) {
+		mbox->block_timeout = MAILBOX_BLOCK_MAX;
+	}
+	if (config && config->manual) {
+		mbox->work_q = NULL;
+	} else {
+		mbox->work_q = (config && config->work_q) ? config->work_q : &bus_state.deliver_q;
+	}
+	k_sem_init(&mbox->space, 0, mbox->depth);
+	k_sem_init(&mbox->avail, 0, K_SEM_MAX_LIMIT);
+	k_work_init(&mbox->work, mailbox_work_handler);
+	
+	sub->in_use = true;
+	sys_slist_append(&bus_state.nodes[node].subs, &sub->node);
 	
 	bus_state.subscriber_count++;
 	
 	k_mutex_unlock(&bus_state.subscriber_mutex);
 	
-	LOG_INF("Subscribed to topic '%s' (id=%d)", topic, sub->id);
-	return sub->id;
+	LOG_INF("Subscribed to topic '%s' (id=%d)", topic, sub->info.id);
+	return sub->info.id;
 }
 
 int msg_bus_unsubscribe(int subscriber_id)
@@ -154,26 +1269,93 @@ int msg_bus_unsubscribe(int subscriber_id)
 	
 	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
 	
-	// TODO: Implement unsubscribe
-	// 1. Find subscriber by ID
-	// 2. Remove from list (compact array)
-	// 3. Update count
+	struct bus_subscriber *sub = find_subscriber((uint32_t)subscriber_id);
+	if (!sub) {
+		k_mutex_unlock(&bus_state.subscriber_mutex);
+		return -ENOENT;
+	}
+	
+	sys_slist_find_and_remove(&bus_state.nodes[sub->trie_node].subs, &sub->node);
+	trie_prune(sub->trie_node);
+	sub->closing = true;
+	bus_state.subscriber_count--;
 	
-	for (uint32_t i = 0; i < bus_state.subscriber_count; i++) {
-		if (bus_state.subscribers[i].id == (uint32_t)subscriber_id) {
-			/* Compact array */
-			for (uint32_t j = i; j < bus_state.subscriber_count - 1; j++) {
-				bus_state.subscribers[j] = bus_state.subscribers[j + 1];
-			}
-			bus_state.subscriber_count--;
-			k_mutex_unlock(&bus_state.subscriber_mutex);
-			LOG_INF("Unsubscribed id=%d", subscriber_id);
-			return 0;
-		}
+	k_mutex_unlock(&bus_state.subscriber_mutex);
+	
+	/* Release a manual drainer blocked on this mailbox */
+	k_sem_give(&sub->mbox.avail);
+	
+	/* Slot is recycled once in-flight deliveries have let go */
+	subscriber_put(sub);
+	
+	LOG_INF("Unsubscribed id=%d", subscriber_id);
+	return 0;
+}
+
+int msg_bus_mailbox_process(int subscriber_id, k_timeout_t timeout)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
+	
+	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
+	struct bus_subscriber *sub = find_subscriber((uint32_t)subscriber_id);
+	if (sub && sub->mbox.work_q) {
+		sub = NULL;
+	}
+	if (sub) {
+		atomic_inc(&sub->refs);
+	}
+	k_mutex_unlock(&bus_state.subscriber_mutex);
+	
+	if (!sub) {
+		return -ENOENT;
+	}
+	
+	int ret = 0;
+	if (sub->mbox.count == 0 && k_sem_take(&sub->mbox.avail, timeout) != 0) {
+		ret = -EAGAIN;
+	} else {
+		ret = mailbox_drain(sub, MAILBOX_MAX_DEPTH);
+	}
+	
+	subscriber_put(sub);
+	return ret;
+}
+
+int msg_bus_subscriber_stats(int subscriber_id, struct msg_sub_stats *stats)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
+	
+	if (!stats) {
+		return -EINVAL;
 	}
 	
+	k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
+	
+	struct bus_subscriber *sub = find_subscriber((uint32_t)subscriber_id);
+	if (!sub) {
+		k_mutex_unlock(&bus_state.subscriber_mutex);
+		return -ENOENT;
+	}
+	
+	struct msg_mailbox *mbox = &sub->mbox;
+	k_spinlock_key_t key = k_spin_lock(&mbox->lock);
+	
+	stats->delivered = mbox->delivered;
+	stats->dropped = mbox->dropped;
+	stats->coalesced = mbox->coalesced;
+	stats->lag = mbox->count;
+	stats->max_lag = mbox->max_lag;
+	stats->oldest_age_ms = mbox->count > 0 ?
+		k_uptime_get_32() - mbox->slots[mbox->head]->msg.header.timestamp : 0;
+	
+	k_spin_unlock(&mbox->lock, key);
 	k_mutex_unlock(&bus_state.subscriber_mutex);
-	return -ENOENT;
+	
+	return 0;
 }
 
 int msg_bus_publish(const char *topic, const void *payload, size_t len,
@@ -187,33 +1369,48 @@ int msg_bus_publish(const char *topic, const void *payload, size_t len,
 		return -EINVAL;
 	}
 	
-	// TODO: Implement publish
-	// 1. Build message
-	// 2. Queue message
-	// 3. Optionally trigger immediate processing for high priority
+	struct msg_buf *buf;
+	int ret = copy_to_buf(payload, len, &buf);
+	if (ret < 0) {
+		return ret;
+	}
+	
+	return msg_bus_publish_buf(topic, buf, priority);
+}
+
+int msg_bus_publish_buf(const char *topic, struct msg_buf *buf,
+                        msg_priority_t priority)
+{
+	if (!bus_state.initialized) {
+		msg_buf_unref(buf);
+		return -ENODEV;
+	}
+	
+	if (!topic) {
+		msg_buf_unref(buf);
+		return -EINVAL;
+	}
 	
+	/* Only the header and a buffer pointer travel through the queue */
 	struct akira_message msg = {0};
-	msg.header.msg_id = bus_state.next_msg_id++;
+	msg.header.msg_id = alloc_msg_id();
 	msg.header.sender_id = 0;  // TODO: Get caller ID
 	msg.header.recipient_id = 0;  // Broadcast
 	strncpy(msg.header.topic, topic, MSG_MAX_TOPIC_LEN - 1);
 	msg.header.priority = priority;
 	msg.header.timestamp = k_uptime_get_32();
-	msg.header.payload_len = len;
+	msg.header.timestamp_hr = msg_bus_clock();
+	msg.header.payload_len = buf ? buf->len : 0;
+	msg.buf = buf;
+	msg.payload = buf ? buf->data : NULL;
 	
-	if (len > 0) {
-		memcpy(msg.payload, payload, len);
-	}
-	
-	int ret = k_msgq_put(&bus_state.msg_queue, &msg, K_NO_WAIT);
-	if (ret != 0) {
-		bus_state.stats_dropped++;
-		LOG_WRN("Message queue full, dropping message");
-		return -EAGAIN;
+	int ret = enqueue_message(&msg);
+	if (ret < 0) {
+		return ret;
 	}
 	
-	bus_state.stats_sent++;
-	LOG_DBG("Published to '%s' (id=%d, len=%zu)", topic, msg.header.msg_id, len);
+	LOG_DBG("Published to '%s' (id=%d, len=%u)", topic, msg.header.msg_id,
+	        msg.header.payload_len);
 	
 	return msg.header.msg_id;
 }
@@ -229,39 +1426,91 @@ int msg_bus_send(uint32_t recipient_id, const void *payload, size_t len,
 		return -EINVAL;
 	}
 	
-	// TODO: Implement point-to-point send
-	// 1. Build message with recipient
-	// 2. For SYNC, set up reply waiter
-	// 3. Queue message
-	// 4. For SYNC, wait for reply
+	struct msg_buf *buf;
+	int ret = copy_to_buf(payload, len, &buf);
+	if (ret < 0) {
+		return ret;
+	}
+	
+	return msg_bus_send_buf(recipient_id, buf, delivery);
+}
+
+int msg_bus_send_buf(uint32_t recipient_id, struct msg_buf *buf,
+                     msg_delivery_t delivery)
+{
+	if (!bus_state.initialized) {
+		msg_buf_unref(buf);
+		return -ENODEV;
+	}
 	
 	struct akira_message msg = {0};
-	msg.header.msg_id = bus_state.next_msg_id++;
+	msg.header.msg_id = alloc_msg_id();
 	msg.header.sender_id = 0;  // TODO: Get caller ID
 	msg.header.recipient_id = recipient_id;
 	msg.header.topic[0] = '\0';  // P2P, no topic
 	msg.header.priority = MSG_PRIORITY_NORMAL;
 	msg.header.timestamp = k_uptime_get_32();
-	msg.header.payload_len = len;
+	msg.header.timestamp_hr = msg_bus_clock();
+	msg.header.payload_len = buf ? buf->len : 0;
+	msg.buf = buf;
+	msg.payload = buf ? buf->data : NULL;
 	
-	if (len > 0) {
-		memcpy(msg.payload, payload, len);
+	/* For SYNC, register the waiter before the request can be answered */
+	struct reply_slot *slot = NULL;
+	if (delivery == MSG_DELIVER_SYNC) {
+		k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+		slot = reply_slot_claim(msg.header.msg_id);
+		if (slot) {
+			msg.header.correlation_id = reply_correlation_id(slot);
+		}
+		k_spin_unlock(&bus_state.reply_lock, key);
+		
+		if (!slot) {
+			msg_buf_unref(buf);
+			LOG_WRN("No free reply slot");
+			return -ENOMEM;
+		}
+		
+		msg.header.flags |= MSG_FLAG_REQUEST;
+		msg.header.priority = MSG_PRIORITY_HIGH;
 	}
 	
-	int ret = k_msgq_put(&bus_state.msg_queue, &msg, K_NO_WAIT);
-	if (ret != 0) {
-		bus_state.stats_dropped++;
-		return -EAGAIN;
+	int ret = enqueue_message(&msg);
+	if (ret < 0) {
+		if (slot) {
+			k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+			reply_slot_release(slot);
+			k_spin_unlock(&bus_state.reply_lock, key);
+		}
+		return ret;
 	}
 	
-	bus_state.stats_sent++;
+	return msg.header.msg_id;
+}
+
+int msg_bus_request(uint32_t recipient_id, const void *payload, size_t len,
+                    struct akira_message *reply, k_timeout_t timeout)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
 	
-	if (delivery == MSG_DELIVER_SYNC) {
-		// TODO: Wait for reply
-		LOG_WRN("Synchronous delivery not fully implemented");
+	if (!reply || (len > 0 && !payload) || len > MSG_MAX_PAYLOAD_SIZE) {
+		return -EINVAL;
 	}
 	
-	return msg.header.msg_id;
+	struct msg_buf *buf;
+	int ret = copy_to_buf(payload, len, &buf);
+	if (ret < 0) {
+		return ret;
+	}
+	
+	ret = msg_bus_send_buf(recipient_id, buf, MSG_DELIVER_SYNC);
+	if (ret < 0) {
+		return ret;
+	}
+	
+	return msg_bus_wait_reply(ret, reply, timeout);
 }
 
 int msg_bus_wait_reply(int msg_id, struct akira_message *reply, k_timeout_t timeout)
@@ -270,14 +1519,50 @@ int msg_bus_wait_reply(int msg_id, struct akira_message *reply, k_timeout_t time
 		return -EINVAL;
 	}
 	
-	// TODO: Implement reply waiting
-	// 1. Find pending reply slot for msg_id
-	// 2. Wait on semaphore
-	// 3. Copy reply to output buffer
-	// 4. Clean up slot
+	k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+	struct reply_slot *slot = reply_slot_find((uint32_t)msg_id);
+	if (!slot || slot->waiter) {
+		k_spin_unlock(&bus_state.reply_lock, key);
+		return slot ? -EBUSY : -ENOENT;
+	}
+	slot->waiter = true;
+	k_spin_unlock(&bus_state.reply_lock, key);
+	
+	return reply_slot_wait(slot, reply, timeout);
+}
+
+int msg_bus_cancel_reply(int msg_id)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
+	
+	k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+	
+	struct reply_slot *slot = reply_slot_find((uint32_t)msg_id);
+	if (!slot) {
+		k_spin_unlock(&bus_state.reply_lock, key);
+		return -ENOENT;
+	}
+	
+	/* Nobody to wake: free the slot (and any uncollected reply) now */
+	if (!slot->waiter) {
+		reply_slot_release(slot);
+		k_spin_unlock(&bus_state.reply_lock, key);
+		return 0;
+	}
+	
+	if (slot->state != REPLY_WAITING) {
+		k_spin_unlock(&bus_state.reply_lock, key);
+		return -ENOENT;
+	}
+	
+	slot->state = REPLY_CANCELLED;
+	k_spin_unlock(&bus_state.reply_lock, key);
 	
-	LOG_WRN("msg_bus_wait_reply not implemented");
-	return -ENOTSUP;
+	/* Waiter wakes, sees the cancellation and frees the slot */
+	k_sem_give(&slot->sem);
+	return 0;
 }
 
 int msg_bus_reply(const struct akira_message *original, const void *payload, size_t len)
@@ -286,14 +1571,66 @@ int msg_bus_reply(const struct akira_message *original, const void *payload, siz
 		return -EINVAL;
 	}
 	
-	// TODO: Implement reply
-	// 1. Build reply message
-	// 2. Set recipient to original sender
-	// 3. Find pending reply slot
-	// 4. Copy reply and signal semaphore
+	if ((len > 0 && !payload) || len > MSG_MAX_PAYLOAD_SIZE) {
+		return -EINVAL;
+	}
+	
+	struct msg_buf *buf;
+	int ret = copy_to_buf(payload, len, &buf);
+	if (ret < 0) {
+		return ret;
+	}
+	
+	return msg_bus_reply_buf(original, buf);
+}
+
+int msg_bus_reply_buf(const struct akira_message *original, struct msg_buf *buf)
+{
+	if (!bus_state.initialized || !original ||
+	    !(original->header.flags & MSG_FLAG_REQUEST)) {
+		msg_buf_unref(buf);
+		return -EINVAL;
+	}
+	
+	uint32_t corr = original->header.correlation_id;
+	uint32_t idx = (corr & REPLY_SLOT_MASK) - 1;
 	
-	LOG_WRN("msg_bus_reply not implemented");
-	return -ENOTSUP;
+	if (idx >= MAX_PENDING_REPLIES) {
+		msg_buf_unref(buf);
+		return -EINVAL;
+	}
+	
+	struct reply_slot *slot = &bus_state.pending_replies[idx];
+	
+	k_spinlock_key_t key = k_spin_lock(&bus_state.reply_lock);
+	
+	/* Caller gave up (timeout/cancel) or the slot was reused */
+	if (slot->state != REPLY_WAITING || reply_correlation_id(slot) != corr) {
+		k_spin_unlock(&bus_state.reply_lock, key);
+		msg_buf_unref(buf);
+		return -ENOENT;
+	}
+	
+	/* Hand the buffer straight to the waiter, no queue round trip */
+	struct msg_header *hdr = &slot->reply_header;
+	memset(hdr, 0, sizeof(*hdr));
+	hdr->msg_id = alloc_msg_id();
+	hdr->sender_id = original->header.recipient_id;
+	hdr->recipient_id = original->header.sender_id;
+	memcpy(hdr->topic, original->header.topic, MSG_MAX_TOPIC_LEN);
+	hdr->priority = original->header.priority;
+	hdr->timestamp = k_uptime_get_32();
+	hdr->timestamp_hr = msg_bus_clock();
+	hdr->payload_len = buf ? buf->len : 0;
+	hdr->flags = MSG_FLAG_REPLY;
+	hdr->correlation_id = corr;
+	slot->reply_buf = buf;
+	slot->state = REPLY_DONE;
+	
+	k_spin_unlock(&bus_state.reply_lock, key);
+	
+	k_sem_give(&slot->sem);
+	return 0;
 }
 
 int msg_bus_process(void)
@@ -303,47 +1640,52 @@ int msg_bus_process(void)
 	}
 	
 	struct akira_message msg;
+	struct match_set matches;
 	int processed = 0;
 	
-	while (k_msgq_get(&bus_state.msg_queue, &msg, K_NO_WAIT) == 0) {
-		bus_state.stats_received++;
-		
-		/* Deliver to matching subscribers */
-		k_mutex_lock(&bus_state.subscriber_mutex, K_FOREVER);
-		
-		for (uint32_t i = 0; i < bus_state.subscriber_count; i++) {
-			struct msg_subscriber *sub = &bus_state.subscribers[i];
-			
-			/* Check recipient for P2P messages */
-			if (msg.header.recipient_id != 0 && 
-			    msg.header.recipient_id != sub->id) {
-				continue;
-			}
-			
-			/* Check topic for pub/sub messages */
-			if (msg.header.topic[0] != '\0' &&
-			    !topic_matches(msg.header.topic, sub->topic_filter)) {
-				continue;
-			}
-			
-			/* Check priority filter */
-			if (msg.header.priority < sub->min_priority) {
-				continue;
-			}
-			
-			/* Deliver message */
-			if (sub->handler) {
-				sub->handler(&msg, sub->user_data);
-			}
-		}
-		
-		k_mutex_unlock(&bus_state.subscriber_mutex);
+	while (dequeue_message(&msg)) {
+		dispatch_message(&msg, &matches);
 		processed++;
 	}
 	
 	return processed;
 }
 
+int msg_bus_set_lane_policy(msg_priority_t priority, msg_drop_policy_t policy)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
+	
+	if ((unsigned int)priority >= MSG_LANE_COUNT ||
+	    (policy != MSG_DROP_NEWEST && policy != MSG_DROP_OLDEST)) {
+		return -EINVAL;
+	}
+	
+	bus_state.lanes[priority].policy = policy;
+	return 0;
+}
+
+int msg_bus_lane_stats(msg_priority_t priority, uint32_t *pending,
+                       uint32_t *dropped)
+{
+	if (!bus_state.initialized) {
+		return -ENODEV;
+	}
+	
+	if ((unsigned int)priority >= MSG_LANE_COUNT) {
+		return -EINVAL;
+	}
+	
+	if (pending) {
+		*pending = k_msgq_num_used_get(&bus_state.lanes[priority].queue);
+	}
+	if (dropped) {
+		*dropped = bus_state.lanes[priority].dropped;
+	}
+	return 0;
+}
+
 void msg_bus_stats(uint32_t *sent, uint32_t *received, uint32_t *dropped)
 {
 	if (sent) {
@@ -17,10 +17,86 @@
 extern "C" {
 #endif
 
+/* Configuration defaults */
+#ifndef CONFIG_AKIRA_MSG_BUS_MAX_PAYLOAD
+#define CONFIG_AKIRA_MSG_BUS_MAX_PAYLOAD 4096
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_POOL_SIZE
+#define CONFIG_AKIRA_MSG_BUS_POOL_SIZE 16384
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_MAX_SUBSCRIBERS
+#define CONFIG_AKIRA_MSG_BUS_MAX_SUBSCRIBERS 64
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_TOPIC_NODES
+#define CONFIG_AKIRA_MSG_BUS_TOPIC_NODES 128
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_LOW
+#define CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_LOW 16
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_NORMAL
+#define CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_NORMAL 16
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_HIGH
+#define CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_HIGH 8
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_URGENT
+#define CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_URGENT 8
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_MAX_PENDING_REPLIES
+#define CONFIG_AKIRA_MSG_BUS_MAX_PENDING_REPLIES 32
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_MAILBOX_DEPTH
+#define CONFIG_AKIRA_MSG_BUS_MAILBOX_DEPTH 8
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_ENVELOPES
+#define CONFIG_AKIRA_MSG_BUS_ENVELOPES 64
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_DELIVER_STACK_SIZE
+#define CONFIG_AKIRA_MSG_BUS_DELIVER_STACK_SIZE 2048
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_DELIVER_PRIORITY
+#define CONFIG_AKIRA_MSG_BUS_DELIVER_PRIORITY 8
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_DISPATCH_STACK_SIZE
+#define CONFIG_AKIRA_MSG_BUS_DISPATCH_STACK_SIZE 2048
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_DISPATCH_PRIORITY
+#define CONFIG_AKIRA_MSG_BUS_DISPATCH_PRIORITY 7
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_URGENT_PRIORITY
+#define CONFIG_AKIRA_MSG_BUS_URGENT_PRIORITY 1
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_BLOCK_MAX_MS
+#define CONFIG_AKIRA_MSG_BUS_BLOCK_MAX_MS 10
+#endif
+
+#ifndef CONFIG_AKIRA_MSG_BUS_REPLY_LEASE_MS
+#define CONFIG_AKIRA_MSG_BUS_REPLY_LEASE_MS 30000
+#endif
+
 /**
  * @brief Maximum message payload size
+ *
+ * Upper bound for a single payload buffer. Payloads are allocated from the
+ * bus payload pool on demand, so this no longer reserves any memory.
  */
-#define MSG_MAX_PAYLOAD_SIZE    256
+#define MSG_MAX_PAYLOAD_SIZE    CONFIG_AKIRA_MSG_BUS_MAX_PAYLOAD
 
 /**
  * @brief Maximum topic name length
@@ -28,9 +104,9 @@ extern "C" {
 #define MSG_MAX_TOPIC_LEN       32
 
 /**
- * @brief Maximum subscribers per topic
+ * @brief Maximum subscribers on the bus
  */
-#define MSG_MAX_SUBSCRIBERS     16
+#define MSG_MAX_SUBSCRIBERS     CONFIG_AKIRA_MSG_BUS_MAX_SUBSCRIBERS
 
 /**
  * @brief Message priority levels
@@ -47,10 +123,34 @@ typedef enum {
  */
 typedef enum {
 	MSG_DELIVER_ASYNC = 0,    // Queue for later delivery
-	MSG_DELIVER_SYNC  = 1,    // Block until delivered
+	MSG_DELIVER_SYNC  = 1,    // Request: collect reply with msg_bus_wait_reply()
 	MSG_DELIVER_FIRE_FORGET = 2  // No delivery confirmation
 } msg_delivery_t;
 
+/**
+ * @brief Message header flags
+ */
+#define MSG_FLAG_REQUEST        0x01  // Sender waits for msg_bus_reply()
+#define MSG_FLAG_REPLY          0x02  // Reply to a request
+
+/**
+ * @brief Lane overflow policy
+ */
+typedef enum {
+	MSG_DROP_NEWEST = 0,      // Reject the incoming message
+	MSG_DROP_OLDEST = 1       // Evict the oldest queued message
+} msg_drop_policy_t;
+
+/**
+ * @brief Subscriber mailbox overflow policy
+ */
+typedef enum {
+	MSG_OVERFLOW_DROP_OLDEST = 0,  // Evict the oldest queued message
+	MSG_OVERFLOW_DROP_NEWEST = 1,  // Discard the incoming message
+	MSG_OVERFLOW_BLOCK       = 2,  // Stall the dispatcher up to block_timeout, then drop
+	MSG_OVERFLOW_COALESCE    = 3   // Keep only the newest message per topic
+} msg_overflow_t;
+
 /**
  * @brief Message header
  */
@@ -60,17 +160,38 @@ struct msg_header {
 	uint32_t recipient_id;     // Recipient ID (0 = broadcast)
 	char topic[MSG_MAX_TOPIC_LEN];  // Topic string
 	msg_priority_t priority;
-	uint32_t timestamp;        // System uptime when sent
+	uint32_t timestamp;        // System uptime when sent (ms)
+	uint32_t timestamp_hr;     // msg_bus_clock() when sent
 	uint16_t payload_len;
 	uint8_t flags;
+	uint32_t correlation_id;   // Links a reply to its request
+};
+
+/**
+ * @brief Reference-counted payload buffer
+ *
+ * Allocated from the message bus payload pool. Publishing a buffer hands
+ * the caller's reference over to the bus; the buffer is returned to the
+ * pool when the last reference is dropped.
+ */
+struct msg_buf {
+	atomic_t ref;
+	uint16_t size;             // Usable capacity of data[]
+	uint16_t len;              // Bytes of data[] in use
+	uint8_t data[];
 };
 
 /**
  * @brief Complete message structure
+ *
+ * Messages only carry a view of their payload. Inside a handler, payload
+ * is borrowed and valid until the handler returns; call msg_buf_ref() on
+ * buf to keep it longer.
  */
 struct akira_message {
 	struct msg_header header;
-	uint8_t payload[MSG_MAX_PAYLOAD_SIZE];
+	const uint8_t *payload;    // Borrowed view of buf->data (NULL if empty)
+	struct msg_buf *buf;       // Backing buffer (NULL if empty)
 };
 
 /**
@@ -85,25 +206,104 @@ struct msg_subscriber {
 	uint32_t id;
 	msg_handler_t handler;
 	void *user_data;
-	char topic_filter[MSG_MAX_TOPIC_LEN];  // Supports wildcards
+	char topic_filter[MSG_MAX_TOPIC_LEN];  // Supports + and # wildcards
 	msg_priority_t min_priority;
 };
 
+/**
+ * @brief Subscriber mailbox configuration
+ */
+struct msg_mailbox_config {
+	uint16_t depth;              // Mailbox slots (0 = CONFIG_AKIRA_MSG_BUS_MAILBOX_DEPTH)
+	msg_overflow_t overflow;     // Policy when the mailbox is full
+	k_timeout_t block_timeout;   // Wait limit for MSG_OVERFLOW_BLOCK (capped at CONFIG_AKIRA_MSG_BUS_BLOCK_MAX_MS)
+	struct k_work_q *work_q;     // Drain context (NULL = shared bus queue)
+	bool manual;                 // Drained by msg_bus_mailbox_process()
+};
+
+/**
+ * @brief Per-subscriber delivery statistics
+ */
+struct msg_sub_stats {
+	uint32_t delivered;          // Messages handed to the handler
+	uint32_t dropped;            // Messages lost to overflow
+	uint32_t coalesced;          // Messages replaced by a newer one
+	uint16_t lag;                // Messages currently queued
+	uint16_t max_lag;            // Highest queue fill seen
+	uint32_t oldest_age_ms;      // Age of the oldest queued message
+};
+
 /**
  * @brief Initialize message bus
  * @return 0 on success
  */
 int msg_bus_init(void);
 
+/**
+ * @brief High-resolution clock stamped into msg_header.timestamp_hr
+ *
+ * Defaults to k_cycle_get_32(). Defined weak so a board or benchmark can
+ * provide a better source (on native_sim the cycle counter does not
+ * advance while code runs).
+ *
+ * @return Current clock value
+ */
+uint32_t msg_bus_clock(void);
+
+/**
+ * @brief Allocate payload buffer from the bus pool
+ * @param size Required capacity in bytes
+ * @param timeout How long to wait for pool space
+ * @return Buffer holding one reference, or NULL
+ */
+struct msg_buf *msg_buf_alloc(size_t size, k_timeout_t timeout);
+
+/**
+ * @brief Take an additional reference on a payload buffer
+ * @param buf Buffer
+ * @return buf
+ */
+struct msg_buf *msg_buf_ref(struct msg_buf *buf);
+
+/**
+ * @brief Drop a reference, freeing the buffer on the last one
+ * @param buf Buffer (NULL is ignored)
+ */
+void msg_buf_unref(struct msg_buf *buf);
+
 /**
  * @brief Subscribe to topic
- * @param topic Topic pattern (supports * wildcard)
+ *
+ * Filters use MQTT semantics: "sensors/+/temp" matches one level in place
+ * of '+', "system/#" matches "system" and everything below it. A bare "*"
+ * matches every topic.
+ *
+ * @param topic Topic pattern
  * @param handler Callback function
  * @param user_data User context
  * @return Subscriber ID or negative error
  */
 int msg_bus_subscribe(const char *topic, msg_handler_t handler, void *user_data);
 
+/**
+ * @brief Subscribe to topic with a configured mailbox
+ *
+ * Every subscriber owns a bounded mailbox filled by the dispatcher. The
+ * handler runs on config->work_q (or the shared "msg_deliver" queue), or
+ * on whichever thread calls msg_bus_mailbox_process() when config->manual
+ * is set. msg_bus_subscribe() uses the defaults: full depth, drop-oldest,
+ * shared delivery queue.
+ *
+ * @param topic Topic pattern
+ * @param handler Callback function
+ * @param user_data User context
+ * @param config Mailbox configuration (NULL for defaults)
+ * @return Subscriber ID or negative error
+ */
+int msg_bus_subscribe_mailbox(const char *topic, msg_handler_t handler,
+                              void *user_data,
+                              const struct msg_mailbox_config *config);
+
 /**
  * @brief Unsubscribe from topic
  * @param subscriber_id ID returned from subscribe
@@ -122,8 +322,27 @@ int msg_bus_unsubscribe(int subscriber_id);
 int msg_bus_publish(const char *topic, const void *payload, size_t len,
                     msg_priority_t priority);
 
+/**
+ * @brief Publish payload buffer to topic without copying
+ *
+ * Ownership of the caller's reference passes to the bus, also on error.
+ *
+ * @param topic Target topic
+ * @param buf Payload buffer (buf->len bytes are published)
+ * @param priority Message priority
+ * @return Message ID or negative error
+ */
+int msg_bus_publish_buf(const char *topic, struct msg_buf *buf,
+                        msg_priority_t priority);
+
 /**
  * @brief Send point-to-point message
+ *
+ * With MSG_DELIVER_SYNC a reply slot is reserved before the message is
+ * queued; the caller must then collect the reply with msg_bus_wait_reply()
+ * (or give up with msg_bus_cancel_reply()). A slot that is neither waited
+ * on nor cancelled is reclaimed after CONFIG_AKIRA_MSG_BUS_REPLY_LEASE_MS.
+ *
  * @param recipient_id Target recipient
  * @param payload Message data
  * @param len Payload length
@@ -133,35 +352,132 @@ int msg_bus_publish(const char *topic, const void *payload, size_t len,
 int msg_bus_send(uint32_t recipient_id, const void *payload, size_t len,
                  msg_delivery_t delivery);
 
+/**
+ * @brief Send payload buffer point-to-point without copying
+ *
+ * Ownership of the caller's reference passes to the bus, also on error.
+ *
+ * @param recipient_id Target recipient
+ * @param buf Payload buffer (buf->len bytes are sent)
+ * @param delivery Delivery mode
+ * @return Message ID or negative error
+ */
+int msg_bus_send_buf(uint32_t recipient_id, struct msg_buf *buf,
+                     msg_delivery_t delivery);
+
+/**
+ * @brief Send a request and wait for its reply
+ *
+ * Equivalent to msg_bus_send(MSG_DELIVER_SYNC) followed by
+ * msg_bus_wait_reply().
+ *
+ * @param recipient_id Target recipient
+ * @param payload Request data
+ * @param len Request length
+ * @param reply Output for the reply (release reply->buf with msg_buf_unref())
+ * @param timeout How long to wait for the reply
+ * @return 0 on success, -ETIMEDOUT, -ECANCELED or other negative error
+ */
+int msg_bus_request(uint32_t recipient_id, const void *payload, size_t len,
+                    struct akira_message *reply, k_timeout_t timeout);
+
 /**
  * @brief Wait for reply to message
- * @param msg_id Original message ID
- * @param reply Output buffer for reply
- * @param timeout Timeout in milliseconds
- * @return 0 on success, -ETIMEDOUT on timeout
+ *
+ * The reply payload is handed over by reference: on success the caller
+ * owns reply->buf and must release it with msg_buf_unref(). The reply
+ * slot is freed in every case.
+ *
+ * @param msg_id ID returned by msg_bus_send() with MSG_DELIVER_SYNC
+ * @param reply Output for the reply
+ * @param timeout How long to wait
+ * @return 0 on success, -ETIMEDOUT on timeout, -ECANCELED if cancelled,
+ *         -EBUSY if another thread is already waiting for this reply
  */
 int msg_bus_wait_reply(int msg_id, struct akira_message *reply, k_timeout_t timeout);
 
+/**
+ * @brief Cancel an outstanding request
+ *
+ * Wakes the waiter with -ECANCELED; a later reply is discarded. Without
+ * a waiter the slot, and any reply not yet collected, is freed at once.
+ *
+ * @param msg_id ID returned by msg_bus_send() with MSG_DELIVER_SYNC
+ * @return 0 on success, -ENOENT if no such request is pending
+ */
+int msg_bus_cancel_reply(int msg_id);
+
 /**
  * @brief Reply to received message
- * @param original Original message
+ * @param original Request message (must carry MSG_FLAG_REQUEST)
  * @param payload Reply data
  * @param len Reply length
- * @return 0 on success
+ * @return 0 on success, -ENOENT if the requester is no longer waiting
  */
 int msg_bus_reply(const struct akira_message *original, const void *payload, size_t len);
 
 /**
- * @brief Process pending messages (called from main loop)
+ * @brief Reply with a payload buffer without copying
+ *
+ * The buffer is handed directly to the waiting requester. Ownership of
+ * the caller's reference passes to the bus, also on error.
+ *
+ * @param original Request message (must carry MSG_FLAG_REQUEST)
+ * @param buf Reply payload (NULL for an empty reply)
+ * @return 0 on success, -ENOENT if the requester is no longer waiting
+ */
+int msg_bus_reply_buf(const struct akira_message *original, struct msg_buf *buf);
+
+/**
+ * @brief Process pending messages in priority order
+ *
+ * Only needed when the dispatcher thread is disabled; otherwise messages
+ * are dispatched from the "msg_dispatch" thread as soon as they arrive.
+ * Either way, handlers run from the subscriber mailboxes.
+ *
  * @return Number of messages processed
  */
 int msg_bus_process(void);
 
+/**
+ * @brief Drain a manually processed mailbox
+ * @param subscriber_id Subscriber created with config->manual set
+ * @param timeout How long to wait for a message if the mailbox is empty
+ * @return Number of messages delivered, -EAGAIN on timeout
+ */
+int msg_bus_mailbox_process(int subscriber_id, k_timeout_t timeout);
+
+/**
+ * @brief Get per-subscriber mailbox statistics
+ * @param subscriber_id ID returned from subscribe
+ * @param stats Output statistics
+ * @return 0 on success
+ */
+int msg_bus_subscriber_stats(int subscriber_id, struct msg_sub_stats *stats);
+
+/**
+ * @brief Set overflow policy for a priority lane
+ * @param priority Lane to configure
+ * @param policy What to drop when the lane is full
+ * @return 0 on success
+ */
+int msg_bus_set_lane_policy(msg_priority_t priority, msg_drop_policy_t policy);
+
+/**
+ * @brief Get per-lane statistics
+ * @param priority Lane to query
+ * @param pending Output for messages waiting in the lane
+ * @param dropped Output for messages dropped by the lane
+ * @return 0 on success
+ */
+int msg_bus_lane_stats(msg_priority_t priority, uint32_t *pending,
+                       uint32_t *dropped);
+
 /**
  * @brief Get message bus statistics
  * @param sent Output for messages sent
  * @param received Output for messages received
- * @param dropped Output for messages dropped
+ * @param dropped Output for messages dropped (lanes and mailboxes)
  */
 void msg_bus_stats(uint32_t *sent, uint32_t *received, uint32_t *dropped);
 
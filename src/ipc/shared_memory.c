@@ -9,12 +9,62 @@
 #include "shared_memory.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/barrier.h>
 #include <string.h>
 
 LOG_MODULE_REGISTER(shmem, CONFIG_AKIRA_LOG_LEVEL);
 
 /* Shared memory pool size */
-#define SHMEM_POOL_SIZE     (64 * 1024)  // 64KB total
+#define SHMEM_POOL_SIZE     (CONFIG_AKIRA_SHMEM_POOL_SIZE * 1024)
+
+/*
+ * Pool allocator: two-level segregated fit (TLSF).
+ *
+ * Every block starts with a header holding its size and the offset of
+ * the physically preceding block, so both neighbours are reachable in
+ * O(1) and free blocks are merged as soon as they are released. Free
+ * blocks are kept in size-class lists: the first level splits sizes by
+ * power of two, the second level splits each power of two into
+ * POOL_SL_COUNT linear steps. Two bitmaps record which lists are
+ * non-empty, so finding a fitting block is a pair of find-first-set
+ * operations rather than a list walk.
+ *
+ * Offsets instead of pointers keep headers at 8 bytes on 64-bit hosts.
+ */
+#define POOL_ALIGN          8
+#define POOL_SL_LOG2        3
+#define POOL_SL_COUNT       (1U << POOL_SL_LOG2)
+#define POOL_FL_SHIFT       (POOL_SL_LOG2 + 3)       /* log2(POOL_ALIGN) */
+#define POOL_SMALL_BLOCK    (1U << POOL_FL_SHIFT)
+#define POOL_FL_COUNT       20
+#define POOL_NIL            UINT32_MAX
+
+#define BLOCK_HDR_SIZE      offsetof(struct pool_block, next_free)
+#define BLOCK_MIN_SIZE      sizeof(struct pool_block)
+#define BLOCK_FREE          0x1U
+#define BLOCK_SIZE_MASK     (~(uint32_t)(POOL_ALIGN - 1))
+
+BUILD_ASSERT(SHMEM_POOL_SIZE % POOL_ALIGN == 0, "pool size must be 8-byte aligned");
+BUILD_ASSERT(SHMEM_POOL_SIZE < (POOL_SMALL_BLOCK << (POOL_FL_COUNT - 1)),
+             "raise POOL_FL_COUNT for this pool size");
+
+struct pool_block {
+	uint32_t prev_phys;     // Offset of the previous block, POOL_NIL if first
+	uint32_t size;          // Block size including header | BLOCK_FREE
+	/* Only valid while the block is free */
+	uint32_t next_free;
+	uint32_t prev_free;
+};
+
+struct pool_ctl {
+	uint32_t fl_bitmap;
+	uint32_t sl_bitmap[POOL_FL_COUNT];
+	uint32_t heads[POOL_FL_COUNT][POOL_SL_COUNT];
+	size_t used;
+	size_t peak_used;
+	uint32_t free_blocks;
+	uint32_t failures;
+};
 
 /* Per-app permission entry */
 struct shmem_perm_entry {
@@ -24,6 +74,17 @@ struct shmem_perm_entry {
 
 #define SHMEM_MAX_PERM_ENTRIES  8
 
+/* Seqlock reads spin this often before waiting for a preempted writer */
+#define SHMEM_SEQ_SPIN          8
+
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+/* WASM instance with the region attached as its shared heap */
+struct shmem_wasm_map {
+	wasm_module_inst_t inst;
+	shmem_perm_t perm;
+};
+#endif
+
 /* Shared memory region */
 struct shmem_region {
 	bool in_use;
@@ -38,6 +99,16 @@ struct shmem_region {
 	struct k_mutex lock;
 	bool is_locked;
 	uint32_t lock_owner;
+	shmem_flags_t flags;
+	atomic_t seq;               // Odd while a seqlock update is in progress
+	atomic_t seq_retries;
+	struct k_mutex write_lock;  // Serializes seqlock writers only
+	k_tid_t writer;             // Thread holding write_lock, NULL if none
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	wasm_shared_heap_t wasm_heap;
+	struct shmem_wasm_map wasm_maps[SHMEM_MAX_WASM_MAPS];
+	uint32_t wasm_map_count;
+#endif
 };
 
 /* Subsystem state */
@@ -47,8 +118,8 @@ static struct {
 	struct k_mutex global_mutex;
 	
 	/* Memory pool */
-	uint8_t pool[SHMEM_POOL_SIZE];
-	size_t pool_used;
+	uint8_t pool[SHMEM_POOL_SIZE] __aligned(POOL_ALIGN);
+	struct pool_ctl ctl;
 } shmem_state;
 
 /**
@@ -110,42 +181,306 @@ static bool check_permission(struct shmem_region *region, uint32_t app_id,
 	return (region->default_perm & required) == required;
 }
 
+static inline struct pool_block *block_at(uint32_t off)
+{
+	return (struct pool_block *)&shmem_state.pool[off];
+}
+
+static inline uint32_t block_off(const struct pool_block *block)
+{
+	return (uint32_t)((const uint8_t *)block - shmem_state.pool);
+}
+
+static inline uint32_t block_size(const struct pool_block *block)
+{
+	return block->size & BLOCK_SIZE_MASK;
+}
+
+static inline bool block_is_free(const struct pool_block *block)
+{
+	return (block->size & BLOCK_FREE) != 0;
+}
+
+static inline struct pool_block *block_next_phys(const struct pool_block *block)
+{
+	uint32_t next = block_off(block) + block_size(block);
+
+	return next < SHMEM_POOL_SIZE ? block_at(next) : NULL;
+}
+
+/**
+ * @brief Map a block size to its free-list indices
+ */
+static void mapping_insert(uint32_t size, uint32_t *fl, uint32_t *sl)
+{
+	if (size < POOL_SMALL_BLOCK) {
+		*fl = 0;
+		*sl = size / (POOL_SMALL_BLOCK / POOL_SL_COUNT);
+	} else {
+		uint32_t msb = find_msb_set(size) - 1;
+
+		*sl = (size >> (msb - POOL_SL_LOG2)) ^ POOL_SL_COUNT;
+		*fl = msb - (POOL_FL_SHIFT - 1);
+	}
+}
+
+/**
+ * @brief Map a request to the first list whose blocks are all large enough
+ */
+static void mapping_search(uint32_t size, uint32_t *fl, uint32_t *sl)
+{
+	if (size >= POOL_SMALL_BLOCK) {
+		size += (1U << (find_msb_set(size) - 1 - POOL_SL_LOG2)) - 1;
+	}
+	mapping_insert(size, fl, sl);
+}
+
+static void free_list_insert(struct pool_block *block)
+{
+	struct pool_ctl *ctl = &shmem_state.ctl;
+	uint32_t fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+
+	uint32_t off = block_off(block);
+	uint32_t head = ctl->heads[fl][sl];
+
+	block->next_free = head;
+	block->prev_free = POOL_NIL;
+	if (head != POOL_NIL) {
+		block_at(head)->prev_free = off;
+	}
+	ctl->heads[fl][sl] = off;
+	ctl->fl_bitmap |= BIT(fl);
+	ctl->sl_bitmap[fl] |= BIT(sl);
+	ctl->free_blocks++;
+}
+
+static void free_list_remove(struct pool_block *block)
+{
+	struct pool_ctl *ctl = &shmem_state.ctl;
+	uint32_t fl, sl;
+
+	mapping_insert(block_size(block), &fl, &sl);
+
+	if (block->prev_free != POOL_NIL) {
+		block_at(block->prev_free)->next_free = block->next_free;
+	} else {
+		ctl->heads[fl][sl] = block->next_free;
+		if (block->next_free == POOL_NIL) {
+			ctl->sl_bitmap[fl] &= ~BIT(sl);
+			if (ctl->sl_bitmap[fl] == 0) {
+				ctl->fl_bitmap &= ~BIT(fl);
+			}
+		}
+	}
+	if (block->next_free != POOL_NIL) {
+		block_at(block->next_free)->prev_free = block->prev_free;
+	}
+	ctl->free_blocks--;
+}
+
+/**
+ * @brief Find a free block of at least size bytes, or NULL
+ */
+static struct pool_block *free_list_find(uint32_t size)
+{
+	struct pool_ctl *ctl = &shmem_state.ctl;
+	uint32_t fl, sl;
+
+	mapping_search(size, &fl, &sl);
+	if (fl >= POOL_FL_COUNT) {
+		return NULL;
+	}
+
+	uint32_t sl_map = ctl->sl_bitmap[fl] & (~0U << sl);
+	if (sl_map == 0) {
+		uint32_t fl_map = (fl + 1 < 32) ? ctl->fl_bitmap & (~0U << (fl + 1)) : 0;
+		if (fl_map == 0) {
+			return NULL;
+		}
+		fl = find_lsb_set(fl_map) - 1;
+		sl_map = ctl->sl_bitmap[fl];
+	}
+	sl = find_lsb_set(sl_map) - 1;
+
+	return block_at(ctl->heads[fl][sl]);
+}
+
+/**
+ * @brief Split size bytes off the front of block, returning the remainder
+ *
+ * The caller guarantees the remainder is at least BLOCK_MIN_SIZE.
+ */
+static struct pool_block *block_split(struct pool_block *block, uint32_t size)
+{
+	uint32_t rest_size = block_size(block) - size;
+	struct pool_block *rest = block_at(block_off(block) + size);
+
+	rest->prev_phys = block_off(block);
+	rest->size = rest_size;
+	block->size = size | (block->size & BLOCK_FREE);
+
+	struct pool_block *next = block_next_phys(rest);
+	if (next) {
+		next->prev_phys = block_off(rest);
+	}
+	return rest;
+}
+
+/**
+ * @brief Merge block with its (free, already unlisted) physical successor
+ */
+static void block_absorb(struct pool_block *block, struct pool_block *next)
+{
+	block->size += block_size(next);
+
+	struct pool_block *after = block_next_phys(block);
+	if (after) {
+		after->prev_phys = block_off(block);
+	}
+}
+
+static void pool_reset(void)
+{
+	struct pool_ctl *ctl = &shmem_state.ctl;
+
+	memset(ctl, 0, sizeof(*ctl));
+	memset(ctl->heads, 0xff, sizeof(ctl->heads));
+
+	struct pool_block *block = block_at(0);
+	block->prev_phys = POOL_NIL;
+	block->size = SHMEM_POOL_SIZE | BLOCK_FREE;
+	free_list_insert(block);
+}
+
 /**
  * @brief Allocate from pool
+ *
+ * O(1) in the number of free blocks. align must be a power of two of at
+ * least POOL_ALIGN.
  */
-static void *pool_alloc(size_t size)
+static void *pool_alloc(size_t size, size_t align)
 {
-	// TODO: Implement proper memory allocator
-	// - First fit or best fit algorithm
-	// - Track free blocks
-	// - Support deallocation
-	
-	/* Simple bump allocator for now */
-	size_t aligned_size = (size + 7) & ~7;  // 8-byte alignment
-	
-	if (shmem_state.pool_used + aligned_size > SHMEM_POOL_SIZE) {
+	struct pool_ctl *ctl = &shmem_state.ctl;
+
+	if (size == 0 || size > SHMEM_POOL_SIZE || align > SHMEM_POOL_SIZE) {
+		ctl->failures++;
 		return NULL;
 	}
-	
-	void *ptr = &shmem_state.pool[shmem_state.pool_used];
-	shmem_state.pool_used += aligned_size;
-	
-	return ptr;
+
+	uint32_t need = ROUND_UP(size, POOL_ALIGN) + BLOCK_HDR_SIZE;
+	if (need < BLOCK_MIN_SIZE) {
+		need = BLOCK_MIN_SIZE;
+	}
+
+	/* Over-allocate so an aligned start with a splittable gap always fits */
+	uint32_t slack = (align > POOL_ALIGN) ? align + BLOCK_MIN_SIZE : 0;
+	struct pool_block *block = free_list_find(need + slack);
+	if (!block) {
+		ctl->failures++;
+		return NULL;
+	}
+	free_list_remove(block);
+
+	if (align > POOL_ALIGN) {
+		uintptr_t data = (uintptr_t)block + BLOCK_HDR_SIZE;
+		uint32_t gap = ROUND_UP(data, align) - data;
+
+		if (gap != 0 && gap < BLOCK_MIN_SIZE) {
+			gap += align;
+		}
+		if (gap != 0) {
+			/* The lead fragment's predecessor is in use, no merge needed */
+			struct pool_block *lead = block;
+			block = block_split(lead, gap);
+			free_list_insert(lead);
+		}
+	}
+
+	if (block_size(block) - need >= BLOCK_MIN_SIZE) {
+		struct pool_block *rest = block_split(block, need);
+		rest->size |= BLOCK_FREE;
+		free_list_insert(rest);
+	}
+
+	block->size &= ~BLOCK_FREE;
+	ctl->used += block_size(block);
+	if (ctl->used > ctl->peak_used) {
+		ctl->peak_used = ctl->used;
+	}
+
+	return (uint8_t *)block + BLOCK_HDR_SIZE;
 }
 
 /**
- * @brief Free to pool
+ * @brief Free to pool, merging with free neighbours
  */
-static void pool_free(void *ptr, size_t size)
+static void pool_free(void *ptr)
 {
-	// TODO: Implement proper deallocation
-	// - Mark block as free
-	// - Coalesce adjacent free blocks
-	
-	(void)ptr;
-	(void)size;
-	
-	LOG_WRN("pool_free not implemented (memory leak)");
+	struct pool_ctl *ctl = &shmem_state.ctl;
+	uint8_t *p = ptr;
+
+	if (!p || p < shmem_state.pool + BLOCK_HDR_SIZE ||
+	    p >= shmem_state.pool + SHMEM_POOL_SIZE) {
+		LOG_ERR("pool_free: %p is not in the pool", ptr);
+		return;
+	}
+
+	struct pool_block *block = (struct pool_block *)(p - BLOCK_HDR_SIZE);
+	if (block_is_free(block)) {
+		LOG_ERR("pool_free: double free of %p", ptr);
+		return;
+	}
+
+	ctl->used -= block_size(block);
+	block->size |= BLOCK_FREE;
+
+	struct pool_block *next = block_next_phys(block);
+	if (next && block_is_free(next)) {
+		free_list_remove(next);
+		block_absorb(block, next);
+	}
+
+	if (block->prev_phys != POOL_NIL) {
+		struct pool_block *prev = block_at(block->prev_phys);
+		if (block_is_free(prev)) {
+			free_list_remove(prev);
+			block_absorb(prev, block);
+			block = prev;
+		}
+	}
+
+	free_list_insert(block);
+}
+
+static void pool_get_stats(struct shmem_pool_stats *stats)
+{
+	struct pool_ctl *ctl = &shmem_state.ctl;
+	uint32_t largest = 0;
+
+	/* Largest block lives in the highest non-empty list */
+	if (ctl->fl_bitmap) {
+		uint32_t fl = find_msb_set(ctl->fl_bitmap) - 1;
+		uint32_t sl = find_msb_set(ctl->sl_bitmap[fl]) - 1;
+
+		for (uint32_t off = ctl->heads[fl][sl]; off != POOL_NIL;
+		     off = block_at(off)->next_free) {
+			if (block_size(block_at(off)) > largest) {
+				largest = block_size(block_at(off));
+			}
+		}
+	}
+
+	stats->total = SHMEM_POOL_SIZE;
+	stats->used = ctl->used;
+	stats->peak_used = ctl->peak_used;
+	stats->free = SHMEM_POOL_SIZE - ctl->used;
+	stats->largest_free = largest > BLOCK_HDR_SIZE ? largest - BLOCK_HDR_SIZE : 0;
+	stats->free_blocks = ctl->free_blocks;
+	stats->failures = ctl->failures;
+	stats->fragmentation = stats->free ?
+		100 - (uint8_t)(((uint64_t)largest * 100) / stats->free) : 0;
 }
 
 int shmem_init(void)
@@ -161,9 +496,10 @@ int shmem_init(void)
 	for (int i = 0; i < SHMEM_MAX_REGIONS; i++) {
 		shmem_state.regions[i].in_use = false;
 		k_mutex_init(&shmem_state.regions[i].lock);
+		k_mutex_init(&shmem_state.regions[i].write_lock);
 	}
 	
-	shmem_state.pool_used = 0;
+	pool_reset();
 	shmem_state.initialized = true;
 	
 	LOG_INF("Shared memory initialized (pool: %d bytes)", SHMEM_POOL_SIZE);
@@ -171,15 +507,34 @@ int shmem_init(void)
 }
 
 shmem_handle_t shmem_create(const char *name, size_t size, shmem_perm_t default_perm)
+{
+	return shmem_create_aligned(name, size, CONFIG_AKIRA_SHMEM_MIN_ALIGN, default_perm);
+}
+
+shmem_handle_t shmem_create_aligned(const char *name, size_t size, size_t align,
+                                    shmem_perm_t default_perm)
+{
+	return shmem_create_ex(name, size, align, SHMEM_FLAG_NONE, default_perm);
+}
+
+shmem_handle_t shmem_create_ex(const char *name, size_t size, size_t align,
+                               shmem_flags_t flags, shmem_perm_t default_perm)
 {
 	if (!shmem_state.initialized) {
 		return -ENODEV;
 	}
 	
-	if (!name || size == 0) {
+	if (!name || size == 0 || !IS_POWER_OF_TWO(align)) {
 		return -EINVAL;
 	}
 	
+	if (align < CONFIG_AKIRA_SHMEM_MIN_ALIGN) {
+		align = CONFIG_AKIRA_SHMEM_MIN_ALIGN;
+	}
+	if (align < POOL_ALIGN) {
+		align = POOL_ALIGN;
+	}
+	
 	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
 	
 	/* Check if name already exists */
@@ -205,7 +560,7 @@ shmem_handle_t shmem_create(const char *name, size_t size, shmem_perm_t default_
 	}
 	
 	/* Allocate memory */
-	void *data = pool_alloc(size);
+	void *data = pool_alloc(size, align);
 	if (!data) {
 		k_mutex_unlock(&shmem_state.global_mutex);
 		LOG_ERR("Failed to allocate %zu bytes", size);
@@ -224,6 +579,14 @@ shmem_handle_t shmem_create(const char *name, size_t size, shmem_perm_t default_
 	region->default_perm = default_perm;
 	region->perm_count = 0;
 	region->is_locked = false;
+	region->flags = flags;
+	atomic_set(&region->seq, 0);
+	atomic_set(&region->seq_retries, 0);
+	region->writer = NULL;
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	region->wasm_heap = NULL;
+	region->wasm_map_count = 0;
+#endif
 	
 	memset(data, 0, size);
 	
@@ -274,14 +637,25 @@ int shmem_close(shmem_handle_t handle)
 	
 	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
 	
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	/* References held by WASM mappings are dropped by shmem_unmap_wasm() */
+	if (region->ref_count <= region->wasm_map_count) {
+		k_mutex_unlock(&shmem_state.global_mutex);
+		return -EBUSY;
+	}
+#endif
+	
 	if (region->ref_count > 0) {
 		region->ref_count--;
 	}
 	
 	/* Auto-destroy when last reference is closed */
 	if (region->ref_count == 0) {
-		pool_free(region->data, region->size);
+		pool_free(region->data);
 		region->in_use = false;
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+		region->wasm_heap = NULL;
+#endif
 		LOG_INF("Destroyed shared memory '%s'", region->name);
 	}
 	
@@ -303,8 +677,20 @@ int shmem_destroy(shmem_handle_t handle)
 	
 	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
 	
-	pool_free(region->data, region->size);
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	if (region->wasm_map_count > 0) {
+		k_mutex_unlock(&shmem_state.global_mutex);
+		LOG_WRN("Region '%s' is mapped by %u WASM apps", region->name,
+		        region->wasm_map_count);
+		return -EBUSY;
+	}
+#endif
+	
+	pool_free(region->data);
 	region->in_use = false;
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	region->wasm_heap = NULL;
+#endif
 	
 	k_mutex_unlock(&shmem_state.global_mutex);
 	
@@ -319,12 +705,7 @@ void *shmem_map(shmem_handle_t handle)
 		return NULL;
 	}
 	
-	// TODO: For WASM, need to map into linear memory
-	// - Use WAMR's wasm_runtime_module_malloc()
-	// - Copy data into WASM space
-	// - Return WASM-accessible pointer
-	
-	LOG_WRN("shmem_map: Direct pointer (not WASM-safe)");
+	/* Native pointer; WASM apps use shmem_map_wasm() */
 	return region->data;
 }
 
@@ -340,6 +721,207 @@ int shmem_unmap(shmem_handle_t handle)
 	return 0;
 }
 
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+/**
+ * @brief Find the region an instance has mapped, if any
+ */
+static struct shmem_region *find_wasm_mapping(wasm_module_inst_t inst, uint32_t *index)
+{
+	for (int i = 0; i < SHMEM_MAX_REGIONS; i++) {
+		struct shmem_region *region = &shmem_state.regions[i];
+		if (!region->in_use) {
+			continue;
+		}
+		for (uint32_t j = 0; j < region->wasm_map_count; j++) {
+			if (region->wasm_maps[j].inst == inst) {
+				*index = j;
+				return region;
+			}
+		}
+	}
+	return NULL;
+}
+
+int shmem_map_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst,
+                   shmem_perm_t perm, uint32_t *app_addr)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !module_inst || !app_addr || perm == SHMEM_PERM_NONE) {
+		return -EINVAL;
+	}
+	
+	if (region->size % SHMEM_WASM_PAGE_SIZE != 0) {
+		LOG_ERR("Region '%s' size %zu is not a multiple of %d", region->name,
+		        region->size, SHMEM_WASM_PAGE_SIZE);
+		return -EINVAL;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	
+	int ret = 0;
+	uint32_t index;
+	
+	if (!check_permission(region, get_current_app_id(), perm)) {
+		LOG_WRN("WASM map of '%s' denied", region->name);
+		ret = -EACCES;
+		goto out;
+	}
+	
+	/* Direct stores would bypass the sequence counter */
+	if ((region->flags & SHMEM_FLAG_SEQLOCK) && (perm & SHMEM_PERM_WRITE)) {
+		ret = -EPERM;
+		goto out;
+	}
+	
+	/* One shared heap per instance: refuse a second region */
+	if (find_wasm_mapping(module_inst, &index)) {
+		ret = -EBUSY;
+		goto out;
+	}
+	
+	if (region->wasm_map_count >= SHMEM_MAX_WASM_MAPS) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	
+	/*
+	 * Wrap the region itself, WAMR does not copy or manage a
+	 * pre-allocated heap. WAMR has no call to free a shared heap, so
+	 * the descriptor is kept for later mappings of the same region and
+	 * forgotten when the region is freed. The region cannot be freed
+	 * while any instance still has the descriptor attached.
+	 */
+	if (!region->wasm_heap) {
+		SharedHeapInitArgs args = {
+			.size = region->size,
+			.pre_allocated_addr = region->data,
+		};
+		region->wasm_heap = wasm_runtime_create_shared_heap(&args);
+		if (!region->wasm_heap) {
+			LOG_ERR("Failed to create shared heap for '%s'", region->name);
+			ret = -ENOMEM;
+			goto out;
+		}
+	}
+	
+	if (!wasm_runtime_attach_shared_heap(module_inst, region->wasm_heap)) {
+		LOG_ERR("Failed to attach '%s' to WASM instance", region->name);
+		ret = -EIO;
+		goto out;
+	}
+	
+	*app_addr = (uint32_t)wasm_runtime_addr_native_to_app(module_inst, region->data);
+	
+	region->wasm_maps[region->wasm_map_count].inst = module_inst;
+	region->wasm_maps[region->wasm_map_count].perm = perm;
+	region->wasm_map_count++;
+	region->ref_count++;
+	
+	LOG_DBG("Mapped '%s' into WASM at 0x%08x", region->name, *app_addr);
+	
+out:
+	k_mutex_unlock(&shmem_state.global_mutex);
+	return ret;
+}
+
+/**
+ * @brief Detach a mapping and drop its reference. Call with global_mutex held.
+ */
+static void wasm_map_remove(struct shmem_region *region, uint32_t index)
+{
+	wasm_runtime_detach_shared_heap(region->wasm_maps[index].inst);
+	region->wasm_maps[index] = region->wasm_maps[--region->wasm_map_count];
+	
+	if (--region->ref_count == 0) {
+		pool_free(region->data);
+		region->in_use = false;
+		region->wasm_heap = NULL;
+		LOG_INF("Destroyed shared memory '%s'", region->name);
+	}
+}
+
+int shmem_unmap_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !module_inst) {
+		return -EINVAL;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	
+	uint32_t index;
+	if (find_wasm_mapping(module_inst, &index) != region) {
+		k_mutex_unlock(&shmem_state.global_mutex);
+		return -ENOENT;
+	}
+	
+	wasm_map_remove(region, index);
+	
+	k_mutex_unlock(&shmem_state.global_mutex);
+	return 0;
+}
+
+int shmem_unmap_wasm_all(wasm_module_inst_t module_inst)
+{
+	if (!shmem_state.initialized || !module_inst) {
+		return 0;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	
+	int count = 0;
+	uint32_t index;
+	struct shmem_region *region;
+	
+	while ((region = find_wasm_mapping(module_inst, &index)) != NULL) {
+		LOG_DBG("Unmapping '%s' from stopped WASM instance", region->name);
+		wasm_map_remove(region, index);
+		count++;
+	}
+	
+	k_mutex_unlock(&shmem_state.global_mutex);
+	return count;
+}
+
+bool shmem_is_mapped_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !module_inst) {
+		return false;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	uint32_t index;
+	bool mapped = find_wasm_mapping(module_inst, &index) == region;
+	k_mutex_unlock(&shmem_state.global_mutex);
+	
+	return mapped;
+}
+
+int shmem_check_wasm_access(shmem_handle_t handle, wasm_module_inst_t module_inst,
+                            shmem_perm_t required)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !module_inst) {
+		return -EINVAL;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	
+	uint32_t index;
+	int ret = 0;
+	
+	if (find_wasm_mapping(module_inst, &index) != region) {
+		ret = -ENOENT;
+	} else if ((region->wasm_maps[index].perm & required) != required) {
+		ret = -EACCES;
+	}
+	
+	k_mutex_unlock(&shmem_state.global_mutex);
+	return ret;
+}
+#endif
+
 int shmem_get_info(shmem_handle_t handle, struct shmem_info *info)
 {
 	struct shmem_region *region = get_region(handle);
@@ -352,6 +934,25 @@ int shmem_get_info(shmem_handle_t handle, struct shmem_info *info)
 	info->owner_id = region->owner_id;
 	info->ref_count = region->ref_count;
 	info->default_perm = region->default_perm;
+	info->flags = region->flags;
+	info->seq_retries = (uint32_t)atomic_get(&region->seq_retries);
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	pool_get_stats(&info->pool);
+	k_mutex_unlock(&shmem_state.global_mutex);
+	
+	return 0;
+}
+
+int shmem_get_pool_stats(struct shmem_pool_stats *stats)
+{
+	if (!shmem_state.initialized || !stats) {
+		return -EINVAL;
+	}
+	
+	k_mutex_lock(&shmem_state.global_mutex, K_FOREVER);
+	pool_get_stats(stats);
+	k_mutex_unlock(&shmem_state.global_mutex);
 	
 	return 0;
 }
@@ -418,6 +1019,66 @@ int shmem_unlock(shmem_handle_t handle)
 	return k_mutex_unlock(&region->lock);
 }
 
+/**
+ * @brief Copy a seqlock region without taking a lock
+ */
+static ssize_t seqlock_copy(struct shmem_region *region, size_t offset,
+                            void *data, size_t len)
+{
+	for (int tries = 0;; tries++) {
+		atomic_val_t start = atomic_get(&region->seq);
+		
+		if ((start & 1) == 0) {
+			memcpy(data, (uint8_t *)region->data + offset, len);
+			/* Order the copy before re-reading the sequence */
+			barrier_dmem_fence_full();
+			if (atomic_get(&region->seq) == start) {
+				return len;
+			}
+		}
+		
+		atomic_inc(&region->seq_retries);
+		
+		/*
+		 * A writer preempted by this (higher priority) reader would never
+		 * finish while we spin; block on it once, which also lends it our
+		 * priority.
+		 */
+		if (tries >= SHMEM_SEQ_SPIN) {
+			/* An ISR may have interrupted the writer itself */
+			if (k_is_in_isr()) {
+				return -EBUSY;
+			}
+			k_mutex_lock(&region->write_lock, K_FOREVER);
+			k_mutex_unlock(&region->write_lock);
+			tries = 0;
+		}
+	}
+}
+
+/*
+ * write_lock is recursive, but seq must move exactly once on each side
+ * of an update, so a thread already inside one may not start another.
+ */
+static int seqlock_write_enter(struct shmem_region *region)
+{
+	if (region->writer == k_current_get()) {
+		return -EDEADLK;
+	}
+	
+	k_mutex_lock(&region->write_lock, K_FOREVER);
+	region->writer = k_current_get();
+	atomic_inc(&region->seq);
+	return 0;
+}
+
+static void seqlock_write_exit(struct shmem_region *region)
+{
+	atomic_inc(&region->seq);
+	region->writer = NULL;
+	k_mutex_unlock(&region->write_lock);
+}
+
 ssize_t shmem_read(shmem_handle_t handle, size_t offset, void *data, size_t len)
 {
 	struct shmem_region *region = get_region(handle);
@@ -436,6 +1097,10 @@ ssize_t shmem_read(shmem_handle_t handle, size_t offset, void *data, size_t len)
 	size_t available = region->size - offset;
 	size_t to_read = (len < available) ? len : available;
 	
+	if (region->flags & SHMEM_FLAG_SEQLOCK) {
+		return seqlock_copy(region, offset, data, to_read);
+	}
+	
 	memcpy(data, (uint8_t *)region->data + offset, to_read);
 	
 	return to_read;
@@ -459,7 +1124,60 @@ ssize_t shmem_write(shmem_handle_t handle, size_t offset, const void *data, size
 	size_t available = region->size - offset;
 	size_t to_write = (len < available) ? len : available;
 	
+	if (region->flags & SHMEM_FLAG_SEQLOCK) {
+		int ret = seqlock_write_enter(region);
+		if (ret < 0) {
+			return ret;
+		}
+		memcpy((uint8_t *)region->data + offset, data, to_write);
+		seqlock_write_exit(region);
+		return to_write;
+	}
+	
 	memcpy((uint8_t *)region->data + offset, data, to_write);
 	
 	return to_write;
 }
+
+ssize_t shmem_read_snapshot(shmem_handle_t handle, size_t offset, void *data, size_t len)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !data || !(region->flags & SHMEM_FLAG_SEQLOCK)) {
+		return -EINVAL;
+	}
+	
+	return shmem_read(handle, offset, data, len);
+}
+
+void *shmem_write_begin(shmem_handle_t handle)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !(region->flags & SHMEM_FLAG_SEQLOCK)) {
+		return NULL;
+	}
+	
+	if (!check_permission(region, get_current_app_id(), SHMEM_PERM_WRITE)) {
+		return NULL;
+	}
+	
+	if (seqlock_write_enter(region) < 0) {
+		return NULL;
+	}
+	return region->data;
+}
+
+int shmem_write_end(shmem_handle_t handle)
+{
+	struct shmem_region *region = get_region(handle);
+	if (!region || !(region->flags & SHMEM_FLAG_SEQLOCK)) {
+		return -EINVAL;
+	}
+	
+	/* Only the thread that called shmem_write_begin() may publish */
+	if (region->writer != k_current_get()) {
+		return -EPERM;
+	}
+	
+	seqlock_write_exit(region);
+	return 0;
+}
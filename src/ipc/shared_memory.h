@@ -15,6 +15,10 @@
 #include <sys/types.h>
 #include <zephyr/kernel.h>
 
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+#include <wasm_export.h>
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -30,6 +34,26 @@ extern "C"
  */
 #define SHMEM_MAX_NAME_LEN 32
 
+#ifndef CONFIG_AKIRA_SHMEM_POOL_SIZE
+#define CONFIG_AKIRA_SHMEM_POOL_SIZE 64
+#endif
+
+#ifndef CONFIG_AKIRA_SHMEM_MIN_ALIGN
+#define CONFIG_AKIRA_SHMEM_MIN_ALIGN 8
+#endif
+
+/**
+ * @brief Granularity of regions mapped into WASM linear memory
+ *
+ * WAMR only accepts pre-allocated shared heaps sized in whole system pages.
+ */
+#define SHMEM_WASM_PAGE_SIZE 4096
+
+/**
+ * @brief Maximum WASM instances mapping one region at the same time
+ */
+#define SHMEM_MAX_WASM_MAPS 4
+
 	/**
 	 * @brief Shared memory permissions
 	 */
@@ -41,11 +65,36 @@ extern "C"
 		SHMEM_PERM_RW = 0x03
 	} shmem_perm_t;
 
+	/**
+	 * @brief Region creation flags
+	 */
+	typedef enum
+	{
+		SHMEM_FLAG_NONE = 0x00,
+		/* Readers copy lock-free snapshots, writers bump a sequence */
+		SHMEM_FLAG_SEQLOCK = 0x01
+	} shmem_flags_t;
+
 	/**
 	 * @brief Shared memory region handle
 	 */
 	typedef int shmem_handle_t;
 
+	/**
+	 * @brief Shared memory pool statistics
+	 */
+	struct shmem_pool_stats
+	{
+		size_t total;         // Pool size in bytes
+		size_t used;          // Bytes held by regions, including headers
+		size_t peak_used;     // Highest value of used
+		size_t free;          // Bytes available in free blocks
+		size_t largest_free;  // Largest single allocation that would succeed
+		uint32_t free_blocks; // Number of free blocks
+		uint32_t failures;    // Allocations that could not be satisfied
+		uint8_t fragmentation; // 100 - largest_free * 100 / free (percent)
+	};
+
 	/**
 	 * @brief Shared memory region info
 	 */
@@ -56,6 +105,9 @@ extern "C"
 		uint32_t owner_id;
 		uint32_t ref_count;
 		shmem_perm_t default_perm;
+		shmem_flags_t flags;
+		uint32_t seq_retries;         // Seqlock reads that had to retry
+		struct shmem_pool_stats pool; // Pool state at the time of the call
 	};
 
 	/**
@@ -73,6 +125,36 @@ extern "C"
 	 */
 	shmem_handle_t shmem_create(const char *name, size_t size, shmem_perm_t default_perm);
 
+	/**
+	 * @brief Create shared memory region with explicit alignment
+	 * @param name Region name
+	 * @param size Size in bytes
+	 * @param align Data alignment (power of two, at least
+	 *              CONFIG_AKIRA_SHMEM_MIN_ALIGN)
+	 * @param default_perm Default permissions for other apps
+	 * @return Handle or negative error
+	 */
+	shmem_handle_t shmem_create_aligned(const char *name, size_t size, size_t align,
+										shmem_perm_t default_perm);
+
+	/**
+	 * @brief Create shared memory region with flags
+	 *
+	 * With SHMEM_FLAG_SEQLOCK, shmem_write() and shmem_write_begin()/
+	 * shmem_write_end() advance a sequence counter around every update,
+	 * and shmem_read() returns a consistent snapshot without blocking
+	 * other readers. Suited to small, read-mostly state.
+	 *
+	 * @param name Region name
+	 * @param size Size in bytes
+	 * @param align Data alignment (power of two)
+	 * @param flags Creation flags
+	 * @param default_perm Default permissions for other apps
+	 * @return Handle or negative error
+	 */
+	shmem_handle_t shmem_create_ex(const char *name, size_t size, size_t align,
+								   shmem_flags_t flags, shmem_perm_t default_perm);
+
 	/**
 	 * @brief Open existing shared memory region
 	 * @param name Region name
@@ -83,8 +165,12 @@ extern "C"
 
 	/**
 	 * @brief Close shared memory handle
+	 *
+	 * References held by WASM mappings are not released here; those go
+	 * away with shmem_unmap_wasm().
+	 *
 	 * @param handle Region handle
-	 * @return 0 on success
+	 * @return 0 on success, -EBUSY if only mapping references remain
 	 */
 	int shmem_close(shmem_handle_t handle);
 
@@ -109,6 +195,65 @@ extern "C"
 	 */
 	int shmem_unmap(shmem_handle_t handle);
 
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	/**
+	 * @brief Map shared memory into a WASM instance's address space
+	 *
+	 * The region is attached to the instance as a WAMR shared heap, so
+	 * the app reads and writes it in place. Permissions are checked here,
+	 * once: WAMR cannot make the window read-only, so an app mapped with
+	 * SHMEM_PERM_READ is trusted not to write. An instance can map one
+	 * region at a time, and a mapped region cannot be destroyed.
+	 *
+	 * @param handle Region handle (size must be a multiple of
+	 *               SHMEM_WASM_PAGE_SIZE)
+	 * @param module_inst Target WASM instance
+	 * @param perm Access the app asks for
+	 * @param app_addr Output for the region's address in the app
+	 * @return 0 on success, -EACCES, -EBUSY or other negative error
+	 */
+	int shmem_map_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst,
+					   shmem_perm_t perm, uint32_t *app_addr);
+
+	/**
+	 * @brief Remove a region from a WASM instance's address space
+	 * @param handle Region handle
+	 * @param module_inst Instance passed to shmem_map_wasm()
+	 * @return 0 on success, -ENOENT if not mapped
+	 */
+	int shmem_unmap_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst);
+
+	/**
+	 * @brief Remove every mapping held by a WASM instance
+	 *
+	 * Must be called before the instance is torn down, otherwise its
+	 * mapped regions can never be destroyed.
+	 *
+	 * @param module_inst Instance being stopped
+	 * @return Number of mappings removed
+	 */
+	int shmem_unmap_wasm_all(wasm_module_inst_t module_inst);
+
+	/**
+	 * @brief Check whether an instance has a region mapped
+	 * @param handle Region handle
+	 * @param module_inst WASM instance
+	 * @return true if the region is mapped into the instance
+	 */
+	bool shmem_is_mapped_wasm(shmem_handle_t handle, wasm_module_inst_t module_inst);
+
+	/**
+	 * @brief Check that an instance mapped a region with enough access
+	 * @param handle Region handle
+	 * @param module_inst WASM instance
+	 * @param required Access the operation needs
+	 * @return 0 if allowed, -ENOENT if not mapped, -EACCES if the
+	 *         mapping lacks the permission
+	 */
+	int shmem_check_wasm_access(shmem_handle_t handle, wasm_module_inst_t module_inst,
+	                            shmem_perm_t required);
+#endif
+
 	/**
 	 * @brief Get region info
 	 * @param handle Region handle
@@ -117,6 +262,13 @@ extern "C"
 	 */
 	int shmem_get_info(shmem_handle_t handle, struct shmem_info *info);
 
+	/**
+	 * @brief Get shared memory pool statistics
+	 * @param stats Output for pool statistics
+	 * @return 0 on success
+	 */
+	int shmem_get_pool_stats(struct shmem_pool_stats *stats);
+
 	/**
 	 * @brief Set app permissions for region
 	 * @param handle Region handle
@@ -161,6 +313,41 @@ extern "C"
 	 */
 	ssize_t shmem_write(shmem_handle_t handle, size_t offset, const void *data, size_t len);
 
+	/**
+	 * @brief Copy a consistent snapshot out of a seqlock region
+	 *
+	 * Retries while a writer is active; never takes a lock unless the
+	 * writer has been preempted for longer than a few retries.
+	 *
+	 * @param handle Region handle (created with SHMEM_FLAG_SEQLOCK)
+	 * @param offset Offset in region
+	 * @param data Output buffer
+	 * @param len Bytes to read
+	 * @return Bytes read, -EBUSY if called from an ISR that interrupted
+	 *         the writer, or other negative error
+	 */
+	ssize_t shmem_read_snapshot(shmem_handle_t handle, size_t offset, void *data, size_t len);
+
+	/**
+	 * @brief Start an in-place update of a seqlock region
+	 *
+	 * Serializes against other writers. Readers retry until
+	 * shmem_write_end() is called, so keep the update short.
+	 *
+	 * @param handle Region handle (created with SHMEM_FLAG_SEQLOCK)
+	 * @return Pointer to region data, or NULL on error or if the calling
+	 *         thread is already inside an update of this region
+	 */
+	void *shmem_write_begin(shmem_handle_t handle);
+
+	/**
+	 * @brief Publish an in-place update started with shmem_write_begin()
+	 * @param handle Region handle
+	 * @return 0 on success, -EPERM if the calling thread did not start
+	 *         the update
+	 */
+	int shmem_write_end(shmem_handle_t handle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,437 @@
+/**
+ * @file shmem_ring.c
+ * @brief Lock-free record rings in shared memory
+ *
+ * Region layout:
+ *
+ *   struct ring_hdr     magic, geometry, head and tail on separate lines
+ *   atomic_t seq[cap]   per-slot commit marks (MPSC only)
+ *   records[cap]        record_size bytes each
+ *
+ * head and tail are free-running counters; a slot is (counter & mask).
+ * In MPSC mode producers claim slots by advancing head with CAS and mark
+ * every filled slot with seq = position + 1, so the consumer can tell a
+ * claimed-but-unwritten slot from a committed one without any producer
+ * waiting for another. In SPSC mode head itself is the commit point.
+ *
+ * Wakeup state (semaphore, waiter count) is kept on the native side,
+ * never in memory an app can write. The same goes for the geometry: it
+ * is read from the header once, validated and cached in ring_ctx, so an
+ * app rewriting record_size, capacity or mode later cannot steer native
+ * copies out of the region. head and tail do live in app memory and are
+ * only ever used masked by the cached capacity.
+ */
+
+#include "shmem_ring.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/logging/log.h>
+#include <string.h>
+
+LOG_MODULE_REGISTER(shmem_ring, CONFIG_AKIRA_LOG_LEVEL);
+
+#define RING_MAGIC          0x52494e47  /* "RING" */
+#define RING_MAX_CAPACITY   (1U << 20)
+
+struct ring_hdr {
+	uint32_t magic;
+	uint32_t record_size;
+	uint32_t capacity;
+	uint32_t mode;
+	atomic_t head __aligned(SHMEM_RING_CACHE_LINE);    // Written by producers
+	atomic_t tail __aligned(SHMEM_RING_CACHE_LINE);    // Written by the consumer
+} __aligned(SHMEM_RING_CACHE_LINE);
+
+/* Native-side state, shared by every open handle of the same region */
+struct ring_ctx {
+	struct ring_hdr *hdr;
+	atomic_t *seq;
+	uint8_t *records;
+	uint32_t mask;
+	uint32_t record_size;
+	shmem_ring_mode_t mode;
+	uint32_t opens;
+	struct k_sem notify;
+	atomic_t waiters;
+	atomic_t full;
+};
+
+static struct ring_ctx rings[SHMEM_MAX_REGIONS];
+static K_MUTEX_DEFINE(rings_mutex);
+
+static size_t ring_seq_size(shmem_ring_mode_t mode, uint32_t capacity)
+{
+	return (mode == SHMEM_RING_MPSC) ? capacity * sizeof(atomic_t) : 0;
+}
+
+static size_t ring_records_offset(shmem_ring_mode_t mode, uint32_t capacity)
+{
+	return ROUND_UP(sizeof(struct ring_hdr) + ring_seq_size(mode, capacity),
+	                sizeof(uint64_t));
+}
+
+static struct ring_ctx *get_ring(shmem_ring_t ring)
+{
+	if (ring < 0 || ring >= SHMEM_MAX_REGIONS || !rings[ring].hdr) {
+		return NULL;
+	}
+	return &rings[ring];
+}
+
+static inline void *slot_ptr(struct ring_ctx *ctx, uint32_t pos)
+{
+	return ctx->records + (size_t)(pos & ctx->mask) * ctx->record_size;
+}
+
+/**
+ * @brief Attach native state to an opened region
+ */
+static int ring_attach(shmem_handle_t shm)
+{
+	k_mutex_lock(&rings_mutex, K_FOREVER);
+
+	struct ring_ctx *ctx = &rings[shm];
+	if (ctx->hdr) {
+		ctx->opens++;
+		k_mutex_unlock(&rings_mutex);
+		return shm;
+	}
+
+	struct ring_hdr *hdr = shmem_map(shm);
+	struct shmem_info info;
+
+	if (!hdr || shmem_get_info(shm, &info) < 0 || info.size < sizeof(*hdr)) {
+		k_mutex_unlock(&rings_mutex);
+		return -EINVAL;
+	}
+
+	/* Snapshot the geometry: the header may be written by an app */
+	volatile struct ring_hdr *vhdr = hdr;
+	uint32_t magic = vhdr->magic;
+	uint32_t record_size = vhdr->record_size;
+	uint32_t capacity = vhdr->capacity;
+	uint32_t mode = vhdr->mode;
+
+	if (magic != RING_MAGIC || record_size == 0 || record_size > UINT16_MAX ||
+	    !IS_POWER_OF_TWO(capacity) || capacity > RING_MAX_CAPACITY ||
+	    mode > SHMEM_RING_MPSC ||
+	    ring_records_offset(mode, capacity) + (size_t)capacity * record_size > info.size) {
+		k_mutex_unlock(&rings_mutex);
+		LOG_ERR("Region %d does not hold a valid ring", shm);
+		return -EINVAL;
+	}
+
+	ctx->hdr = hdr;
+	ctx->seq = (atomic_t *)(hdr + 1);
+	ctx->records = (uint8_t *)hdr + ring_records_offset(mode, capacity);
+	ctx->mask = capacity - 1;
+	ctx->record_size = record_size;
+	ctx->mode = (shmem_ring_mode_t)mode;
+	ctx->opens = 1;
+	k_sem_init(&ctx->notify, 0, 1);
+	atomic_set(&ctx->waiters, 0);
+	atomic_set(&ctx->full, 0);
+
+	k_mutex_unlock(&rings_mutex);
+	return shm;
+}
+
+shmem_ring_t shmem_ring_create(const char *name, size_t record_size,
+                               uint32_t capacity, shmem_ring_mode_t mode,
+                               shmem_perm_t default_perm)
+{
+	if (!name || record_size == 0 || record_size > UINT16_MAX ||
+	    capacity == 0 || capacity > RING_MAX_CAPACITY ||
+	    (mode != SHMEM_RING_SPSC && mode != SHMEM_RING_MPSC)) {
+		return -EINVAL;
+	}
+
+	/* Keep every record word aligned */
+	record_size = ROUND_UP(record_size, sizeof(uint32_t));
+	capacity = 1U << find_msb_set(capacity - 1);
+
+	size_t size = ring_records_offset(mode, capacity) + (size_t)capacity * record_size;
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+	size = ROUND_UP(size, SHMEM_WASM_PAGE_SIZE);
+#endif
+
+	shmem_handle_t shm = shmem_create_aligned(name, size, SHMEM_RING_CACHE_LINE,
+	                                          default_perm);
+	if (shm < 0) {
+		return shm;
+	}
+
+	struct ring_hdr *hdr = shmem_map(shm);
+	hdr->magic = RING_MAGIC;
+	hdr->record_size = record_size;
+	hdr->capacity = capacity;
+	hdr->mode = mode;
+	atomic_set(&hdr->head, 0);
+	atomic_set(&hdr->tail, 0);
+	/* seq[] starts zeroed: slot p is committed once seq == p + 1 */
+
+	int ret = ring_attach(shm);
+	if (ret < 0) {
+		shmem_destroy(shm);
+		return ret;
+	}
+
+	LOG_INF("Created ring '%s' (%u x %u bytes, %s)", name, capacity,
+	        (uint32_t)record_size, mode == SHMEM_RING_MPSC ? "MPSC" : "SPSC");
+	return shm;
+}
+
+shmem_ring_t shmem_ring_open(const char *name, shmem_perm_t requested_perm)
+{
+	shmem_handle_t shm = shmem_open(name, requested_perm);
+	if (shm < 0) {
+		return shm;
+	}
+
+	int ret = ring_attach(shm);
+	if (ret < 0) {
+		shmem_close(shm);
+	}
+	return ret;
+}
+
+int shmem_ring_close(shmem_ring_t ring)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&rings_mutex, K_FOREVER);
+	if (--ctx->opens == 0) {
+		ctx->hdr = NULL;
+	}
+	k_mutex_unlock(&rings_mutex);
+
+	return shmem_close(ring);
+}
+
+int shmem_ring_reserve(shmem_ring_t ring, uint32_t max,
+                       struct shmem_ring_batch *batch)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !batch || max == 0) {
+		return -EINVAL;
+	}
+
+	uint32_t cap = ctx->mask + 1;
+	uint32_t head, n;
+
+	do {
+		head = (uint32_t)atomic_get(&ctx->hdr->head);
+		uint32_t used = head - (uint32_t)atomic_get(&ctx->hdr->tail);
+
+		/* Clamp against a corrupted tail as well as a full ring */
+		n = (used < cap) ? cap - used : 0;
+		n = MIN(n, max);
+		n = MIN(n, cap - (head & ctx->mask));
+		if (n == 0) {
+			atomic_inc(&ctx->full);
+			return -EAGAIN;
+		}
+		/* A single producer owns head; it is only published on commit */
+		if (ctx->mode == SHMEM_RING_SPSC) {
+			break;
+		}
+	} while (!atomic_cas(&ctx->hdr->head, (atomic_val_t)head,
+	                     (atomic_val_t)(head + n)));
+
+	batch->records = slot_ptr(ctx, head);
+	batch->count = n;
+	batch->index = head;
+	return n;
+}
+
+int shmem_ring_commit(shmem_ring_t ring, const struct shmem_ring_batch *batch)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !batch || batch->count == 0) {
+		return -EINVAL;
+	}
+
+	if (ctx->mode == SHMEM_RING_SPSC) {
+		uint32_t tail = (uint32_t)atomic_get(&ctx->hdr->tail);
+
+		if (batch->index != (uint32_t)atomic_get(&ctx->hdr->head) ||
+		    batch->index + batch->count - tail > ctx->mask + 1) {
+			return -EINVAL;
+		}
+		/* atomic_set is a full barrier: records are visible first */
+		atomic_set(&ctx->hdr->head, (atomic_val_t)(batch->index + batch->count));
+	} else {
+		uint32_t head = (uint32_t)atomic_get(&ctx->hdr->head);
+		uint32_t tail = (uint32_t)atomic_get(&ctx->hdr->tail);
+
+		/* The batch must lie inside the claimed, unconsumed window */
+		if (batch->index - tail > ctx->mask || head - batch->index < batch->count) {
+			return -EINVAL;
+		}
+		for (uint32_t i = 0; i < batch->count; i++) {
+			uint32_t pos = batch->index + i;
+			atomic_set(&ctx->seq[pos & ctx->mask], (atomic_val_t)(pos + 1));
+		}
+	}
+
+	if (atomic_get(&ctx->waiters) > 0) {
+		k_sem_give(&ctx->notify);
+	}
+	return 0;
+}
+
+/**
+ * @brief Count committed records readable in one contiguous run
+ */
+static uint32_t ring_readable(struct ring_ctx *ctx, uint32_t tail, uint32_t max)
+{
+	uint32_t cap = ctx->mask + 1;
+	uint32_t limit = MIN(max, cap - (tail & ctx->mask));
+
+	if (ctx->mode == SHMEM_RING_SPSC) {
+		uint32_t used = (uint32_t)atomic_get(&ctx->hdr->head) - tail;
+		return MIN(MIN(used, cap), limit);
+	}
+
+	uint32_t n = 0;
+	while (n < limit &&
+	       (uint32_t)atomic_get(&ctx->seq[(tail + n) & ctx->mask]) == tail + n + 1) {
+		n++;
+	}
+	return n;
+}
+
+int shmem_ring_peek(shmem_ring_t ring, uint32_t max,
+                    struct shmem_ring_batch *batch, k_timeout_t timeout)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !batch || max == 0) {
+		return -EINVAL;
+	}
+
+	uint32_t tail = (uint32_t)atomic_get(&ctx->hdr->tail);
+	uint32_t n = ring_readable(ctx, tail, max);
+
+	if (n == 0 && !K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		k_timepoint_t end = sys_timepoint_calc(timeout);
+
+		atomic_inc(&ctx->waiters);
+		/* Re-check after announcing ourselves so a commit is not missed */
+		while ((n = ring_readable(ctx, tail, max)) == 0) {
+			if (k_sem_take(&ctx->notify, sys_timepoint_timeout(end)) != 0) {
+				break;
+			}
+		}
+		atomic_dec(&ctx->waiters);
+	}
+
+	if (n == 0) {
+		return -EAGAIN;
+	}
+
+	batch->records = slot_ptr(ctx, tail);
+	batch->count = n;
+	batch->index = tail;
+	return n;
+}
+
+int shmem_ring_release(shmem_ring_t ring, const struct shmem_ring_batch *batch)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !batch || batch->count == 0) {
+		return -EINVAL;
+	}
+
+	if (batch->index != (uint32_t)atomic_get(&ctx->hdr->tail) ||
+	    batch->count > ctx->mask + 1) {
+		return -EINVAL;
+	}
+
+	/* Never move tail past what producers have committed */
+	if (ring_readable(ctx, batch->index, batch->count) < batch->count) {
+		return -EINVAL;
+	}
+
+	atomic_set(&ctx->hdr->tail, (atomic_val_t)(batch->index + batch->count));
+	return 0;
+}
+
+int shmem_ring_put(shmem_ring_t ring, const void *record)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	struct shmem_ring_batch batch;
+
+	if (!ctx || !record) {
+		return -EINVAL;
+	}
+
+	int ret = shmem_ring_reserve(ring, 1, &batch);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memcpy(batch.records, record, ctx->record_size);
+	return shmem_ring_commit(ring, &batch);
+}
+
+int shmem_ring_get(shmem_ring_t ring, void *record, k_timeout_t timeout)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	struct shmem_ring_batch batch;
+
+	if (!ctx || !record) {
+		return -EINVAL;
+	}
+
+	int ret = shmem_ring_peek(ring, 1, &batch, timeout);
+	if (ret < 0) {
+		return ret;
+	}
+
+	memcpy(record, batch.records, ctx->record_size);
+	return shmem_ring_release(ring, &batch);
+}
+
+int shmem_ring_get_stats(shmem_ring_t ring, struct shmem_ring_stats *stats)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !stats) {
+		return -EINVAL;
+	}
+
+	stats->capacity = ctx->mask + 1;
+	stats->record_size = ctx->record_size;
+	stats->used = MIN((uint32_t)atomic_get(&ctx->hdr->head) -
+	                  (uint32_t)atomic_get(&ctx->hdr->tail), ctx->mask + 1);
+	stats->full = (uint32_t)atomic_get(&ctx->full);
+	return 0;
+}
+
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+uint32_t shmem_ring_batch_app_addr(wasm_module_inst_t module_inst,
+                                   const struct shmem_ring_batch *batch)
+{
+	if (!module_inst || !batch || !batch->records) {
+		return 0;
+	}
+	return (uint32_t)wasm_runtime_addr_native_to_app(module_inst, batch->records);
+}
+
+int shmem_ring_batch_from_app(shmem_ring_t ring, uint32_t count, uint32_t index,
+                              struct shmem_ring_batch *batch)
+{
+	struct ring_ctx *ctx = get_ring(ring);
+	if (!ctx || !batch || count == 0 ||
+	    (index & ctx->mask) + count > ctx->mask + 1) {
+		return -EINVAL;
+	}
+
+	batch->records = slot_ptr(ctx, index);
+	batch->count = count;
+	batch->index = index;
+	return 0;
+}
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @file shmem_ring.h
+ * @brief Lock-free record rings in shared memory
+ *
+ * Fixed-size record queues between threads and WASM apps, stored in a
+ * shared memory region so both sides work on the records in place.
+ * Producers reserve a batch of slots, fill them and commit; the consumer
+ * peeks at committed records and releases them. Index updates are
+ * lock-free: a single producer just publishes its head, multiple producers
+ * claim slots with compare-and-swap and mark each slot when it is filled.
+ * There is always exactly one consumer.
+ */
+
+#ifndef AKIRA_SHMEM_RING_H
+#define AKIRA_SHMEM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+#include "shared_memory.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Cache line size used to keep producer and consumer indices apart
+ */
+#if defined(CONFIG_DCACHE_LINE_SIZE) && (CONFIG_DCACHE_LINE_SIZE > 0)
+#define SHMEM_RING_CACHE_LINE   CONFIG_DCACHE_LINE_SIZE
+#else
+#define SHMEM_RING_CACHE_LINE   64
+#endif
+
+/**
+ * @brief Ring handle (same value as the underlying shmem handle)
+ */
+typedef int shmem_ring_t;
+
+/**
+ * @brief Producer model
+ */
+typedef enum {
+	SHMEM_RING_SPSC = 0,    // One producer, one consumer
+	SHMEM_RING_MPSC = 1     // Any number of producers, one consumer
+} shmem_ring_mode_t;
+
+/**
+ * @brief A run of contiguous records
+ *
+ * Filled by shmem_ring_reserve()/shmem_ring_peek() and handed back
+ * unchanged to shmem_ring_commit()/shmem_ring_release().
+ */
+struct shmem_ring_batch {
+	void *records;          // First record, count records follow
+	uint32_t count;         // Number of records in the batch
+	uint32_t index;         // Ring position of the first record
+};
+
+/**
+ * @brief Ring statistics
+ */
+struct shmem_ring_stats {
+	uint32_t capacity;      // Records the ring can hold
+	uint32_t record_size;   // Bytes per record
+	uint32_t used;          // Records reserved or waiting to be consumed
+	uint32_t full;          // Reservations refused because the ring was full
+};
+
+/**
+ * @brief Create a ring in a new shared memory region
+ * @param name Region name
+ * @param record_size Bytes per record
+ * @param capacity Number of records (rounded up to a power of two)
+ * @param mode Producer model
+ * @param default_perm Default permissions for other apps
+ * @return Ring handle or negative error
+ */
+shmem_ring_t shmem_ring_create(const char *name, size_t record_size,
+                               uint32_t capacity, shmem_ring_mode_t mode,
+                               shmem_perm_t default_perm);
+
+/**
+ * @brief Open an existing ring
+ * @param name Region name
+ * @param requested_perm SHMEM_PERM_WRITE to produce, SHMEM_PERM_READ to consume
+ * @return Ring handle or negative error
+ */
+shmem_ring_t shmem_ring_open(const char *name, shmem_perm_t requested_perm);
+
+/**
+ * @brief Close a ring handle
+ * @param ring Ring handle
+ * @return 0 on success
+ */
+int shmem_ring_close(shmem_ring_t ring);
+
+/**
+ * @brief Reserve up to max contiguous slots for writing
+ *
+ * Fewer slots than requested are returned when the ring is nearly full or
+ * the reservation would wrap; call again for the rest.
+ *
+ * @param ring Ring handle
+ * @param max Maximum number of records wanted
+ * @param batch Output for the reserved slots
+ * @return Number of slots reserved, -EAGAIN if the ring is full
+ */
+int shmem_ring_reserve(shmem_ring_t ring, uint32_t max,
+                       struct shmem_ring_batch *batch);
+
+/**
+ * @brief Publish a reserved batch to the consumer
+ *
+ * Wakes the consumer if it is waiting in shmem_ring_peek(). In SPSC mode
+ * batches must be committed in the order they were reserved.
+ *
+ * @param ring Ring handle
+ * @param batch Batch from shmem_ring_reserve()
+ * @return 0 on success
+ */
+int shmem_ring_commit(shmem_ring_t ring, const struct shmem_ring_batch *batch);
+
+/**
+ * @brief Get up to max contiguous committed records
+ * @param ring Ring handle
+ * @param max Maximum number of records wanted
+ * @param batch Output for the readable records
+ * @param timeout How long to wait for the ring to become non-empty
+ * @return Number of records available, -EAGAIN on timeout
+ */
+int shmem_ring_peek(shmem_ring_t ring, uint32_t max,
+                    struct shmem_ring_batch *batch, k_timeout_t timeout);
+
+/**
+ * @brief Return consumed records to the producers
+ * @param ring Ring handle
+ * @param batch Batch from shmem_ring_peek()
+ * @return 0 on success, -EINVAL if the batch is not at the read position
+ *         or covers records that have not been committed
+ */
+int shmem_ring_release(shmem_ring_t ring, const struct shmem_ring_batch *batch);
+
+/**
+ * @brief Copy one record into the ring
+ * @param ring Ring handle
+ * @param record Record data (record_size bytes)
+ * @return 0 on success, -EAGAIN if the ring is full
+ */
+int shmem_ring_put(shmem_ring_t ring, const void *record);
+
+/**
+ * @brief Copy one record out of the ring
+ * @param ring Ring handle
+ * @param record Output buffer (record_size bytes)
+ * @param timeout How long to wait for a record
+ * @return 0 on success, -EAGAIN on timeout
+ */
+int shmem_ring_get(shmem_ring_t ring, void *record, k_timeout_t timeout);
+
+/**
+ * @brief Get ring statistics
+ * @param ring Ring handle
+ * @param stats Output statistics
+ * @return 0 on success
+ */
+int shmem_ring_get_stats(shmem_ring_t ring, struct shmem_ring_stats *stats);
+
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+/**
+ * @brief Translate a batch for a WASM endpoint
+ *
+ * The ring's region must be mapped into the instance with
+ * shmem_map_wasm(); records are then accessed in place by the app.
+ *
+ * @param module_inst WASM instance
+ * @param batch Batch from reserve or peek
+ * @return App address of batch->records, 0 if not mapped
+ */
+uint32_t shmem_ring_batch_app_addr(wasm_module_inst_t module_inst,
+                                   const struct shmem_ring_batch *batch);
+
+/**
+ * @brief Rebuild a batch handed back by a WASM endpoint
+ *
+ * Only count and index are taken from the app; the record pointer is
+ * recomputed so a corrupted batch cannot point outside the ring.
+ *
+ * @param ring Ring handle
+ * @param count Record count from the app
+ * @param index Ring position from the app
+ * @param batch Output batch
+ * @return 0 on success, -EINVAL if the batch does not fit the ring
+ */
+int shmem_ring_batch_from_app(shmem_ring_t ring, uint32_t count, uint32_t index,
+                              struct shmem_ring_batch *batch);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AKIRA_SHMEM_RING_H */
@@ -2,8 +2,14 @@
  * @file scheduler.c
  * @brief WASM App/Container Scheduler Implementation
  * 
- * Priority-based cooperative scheduler for WASM applications.
+ * Priority-based scheduler for WASM applications.
  * Provides fair CPU time distribution with power awareness.
+ *
+ * Each task runs on its own thread, but only the task picked by
+ * scheduler_run() is let through at a time. Its slice is fuel measured
+ * in hardware cycles; once burnt, the next scheduler_safepoint() parks
+ * the task and hands the CPU back, and the task resumes from that point
+ * when it is picked again.
  */
 
 #include "scheduler.h"
@@ -16,6 +22,13 @@ LOG_MODULE_REGISTER(scheduler, CONFIG_AKIRA_LOG_LEVEL);
 /* Default time slice */
 #define DEFAULT_TIME_SLICE_MS   10
 
+/* Task threads; only the dispatched one is ever runnable */
+#define DEFAULT_STACK_SIZE      4096
+#define TASK_THREAD_PRIORITY    10
+
+/* One ready list per priority level */
+#define SCHED_NUM_PRIORITIES    (SCHED_PRIORITY_REALTIME + 1)
+
 /* Task control block */
 struct task_cb {
 	bool in_use;
@@ -27,8 +40,10 @@ struct task_cb {
 	uint32_t time_slice_ms;
 	uint32_t app_id;
 	
-	/* Runtime tracking */
-	uint64_t start_time;
+	/* Runtime tracking, in hardware cycles */
+	uint32_t slice_start;
+	uint32_t slice_cycles;
+	uint32_t last_run;
 	uint64_t total_runtime;
 	uint32_t slice_count;
 	uint32_t preemption_count;
@@ -36,6 +51,15 @@ struct task_cb {
 	
 	/* Blocking */
 	const char *block_reason;
+	
+	/* Ready list link, unlinked while not ready */
+	sys_dnode_t ready_node;
+	
+	/* Execution context, created on first dispatch */
+	struct k_thread thread;
+	k_thread_stack_t *stack;
+	uint32_t stack_size;
+	struct k_sem run_sem;       /* Given to let the task run a slice */
 };
 
 /* Scheduler state */
@@ -45,6 +69,8 @@ static struct {
 	struct task_cb tasks[SCHED_MAX_TASKS];
 	task_handle_t current_task;
 	struct k_mutex mutex;
+	struct k_sem switch_sem;    /* Given when the running task gives up the CPU */
+	bool parked;                /* The running task has given switch_sem */
 	
 	/* Timing */
 	uint64_t last_tick;
@@ -53,8 +79,9 @@ static struct {
 	/* Power awareness */
 	bool power_aware;
 	
-	/* Ready queue (simple priority array) */
-	task_handle_t ready_queue[SCHED_MAX_TASKS];
+	/* Ready queue: FIFO per priority, bit N set while ready[N] is non-empty */
+	sys_dlist_t ready[SCHED_NUM_PRIORITIES];
+	uint32_t ready_prios;
 	int ready_count;
 } sched_state;
 
@@ -86,33 +113,17 @@ static task_handle_t find_free_slot(void)
 }
 
 /**
- * @brief Add task to ready queue
+ * @brief Add task to the tail of its priority's ready list
  */
 static void add_to_ready_queue(task_handle_t handle)
 {
-	if (sched_state.ready_count >= SCHED_MAX_TASKS) {
-		return;
-	}
-	
 	struct task_cb *task = get_task(handle);
-	if (!task) return;
-	
-	/* Insert in priority order (higher priority first) */
-	int insert_pos = sched_state.ready_count;
-	for (int i = 0; i < sched_state.ready_count; i++) {
-		struct task_cb *other = get_task(sched_state.ready_queue[i]);
-		if (other && task->priority > other->priority) {
-			insert_pos = i;
-			break;
-		}
-	}
-	
-	/* Shift elements */
-	for (int i = sched_state.ready_count; i > insert_pos; i--) {
-		sched_state.ready_queue[i] = sched_state.ready_queue[i - 1];
+	if (!task || sys_dnode_is_linked(&task->ready_node)) {
+		return;
 	}
 	
-	sched_state.ready_queue[insert_pos] = handle;
+	sys_dlist_append(&sched_state.ready[task->priority], &task->ready_node);
+	sched_state.ready_prios |= BIT(task->priority);
 	sched_state.ready_count++;
 }
 
@@ -121,82 +132,121 @@ static void add_to_ready_queue(task_handle_t handle)
  */
 static void remove_from_ready_queue(task_handle_t handle)
 {
-	for (int i = 0; i < sched_state.ready_count; i++) {
-		if (sched_state.ready_queue[i] == handle) {
-			/* Shift elements */
-			for (int j = i; j < sched_state.ready_count - 1; j++) {
-				sched_state.ready_queue[j] = sched_state.ready_queue[j + 1];
-			}
-			sched_state.ready_count--;
-			return;
-		}
+	struct task_cb *task = get_task(handle);
+	if (!task || !sys_dnode_is_linked(&task->ready_node)) {
+		return;
 	}
+	
+	sys_dlist_remove(&task->ready_node);
+	if (sys_dlist_is_empty(&sched_state.ready[task->priority])) {
+		sched_state.ready_prios &= ~BIT(task->priority);
+	}
+	sched_state.ready_count--;
 }
 
 /**
  * @brief Select next task to run
+ *
+ * Head of the highest non-empty priority list. Tasks go back to the
+ * tail of their list after running, which gives round-robin within a
+ * priority level.
  */
 static task_handle_t select_next_task(void)
 {
-	// Priority-based round-robin scheduler with power awareness
-	// 1. Select highest priority ready task
-	// 2. Within same priority, round-robin
-	// 3. Consider power state if enabled
-	
-	if (sched_state.ready_count == 0) {
+	if (!sched_state.ready_prios) {
 		return -1;
 	}
 	
-	// Find highest priority task
-	int best_priority = -1;
-	for (int i = 0; i < sched_state.ready_count; i++) {
-		struct task_cb *task = get_task(sched_state.ready_queue[i]);
-		if (task && task->priority > best_priority) {
-			best_priority = task->priority;
-		}
+	int priority = find_msb_set(sched_state.ready_prios) - 1;
+	sys_dnode_t *node = sys_dlist_peek_head(&sched_state.ready[priority]);
+	struct task_cb *task = CONTAINER_OF(node, struct task_cb, ready_node);
+	
+	return task - sched_state.tasks;
+}
+
+/**
+ * @brief Task whose thread is the caller, if it is the running one
+ */
+static struct task_cb *self_task(void)
+{
+	struct task_cb *task = get_task(sched_state.current_task);
+	
+	if (task && task->stack && k_current_get() == &task->thread) {
+		return task;
 	}
+	return NULL;
+}
+
+/**
+ * @brief Hand the CPU back to scheduler_run() and wait to be picked again
+ *
+ * Called on the task's thread with the mutex held; releases it.
+ */
+static void task_park(struct task_cb *task)
+{
+	task->last_run = k_cycle_get_32() - task->slice_start;
+	task->total_runtime += task->last_run;
+	sched_state.parked = true;
 	
-	// Round-robin among tasks with highest priority
-	// Find first task with highest priority after current position
-	task_handle_t selected = -1;
-	bool found_current = false;
-	
-	for (int pass = 0; pass < 2 && selected < 0; pass++) {
-		for (int i = 0; i < sched_state.ready_count; i++) {
-			task_handle_t handle = sched_state.ready_queue[i];
-			struct task_cb *task = get_task(handle);
-			
-			if (!task || task->priority != best_priority) {
-				continue;
-			}
-			
-			// In first pass, look for task after current
-			if (pass == 0) {
-				if (!found_current) {
-					if (handle == sched_state.current_task) {
-						found_current = true;
-					}
-					continue;
-				}
-			}
-			
-			selected = handle;
-			break;
-		}
+	/* Give before unlocking: destroy may abort us as soon as we do */
+	k_sem_give(&sched_state.switch_sem);
+	k_mutex_unlock(&sched_state.mutex);
+	k_sem_take(&task->run_sem, K_FOREVER);
+}
+
+static void task_thread_entry(void *p1, void *p2, void *p3)
+{
+	struct task_cb *task = p1;
+	
+	k_sem_take(&task->run_sem, K_FOREVER);
+	
+	task->entry(task->arg);
+	
+	/* Entry returned: the task is done */
+	k_mutex_lock(&sched_state.mutex, K_FOREVER);
+	task->last_run = k_cycle_get_32() - task->slice_start;
+	task->total_runtime += task->last_run;
+	task->state = TASK_STATE_TERMINATED;
+	sched_state.parked = true;
+	k_sem_give(&sched_state.switch_sem);
+	k_mutex_unlock(&sched_state.mutex);
+}
+
+/**
+ * @brief Create the task's thread; it waits for its first slice
+ */
+static int task_thread_start(struct task_cb *task)
+{
+	task->stack = k_thread_stack_alloc(task->stack_size, 0);
+	if (!task->stack) {
+		return -ENOMEM;
 	}
 	
-	// If no task found, pick first with highest priority
-	if (selected < 0) {
-		for (int i = 0; i < sched_state.ready_count; i++) {
-			struct task_cb *task = get_task(sched_state.ready_queue[i]);
-			if (task && task->priority == best_priority) {
-				selected = sched_state.ready_queue[i];
-				break;
-			}
-		}
+	k_sem_init(&task->run_sem, 0, 1);
+	k_thread_create(&task->thread, task->stack, task->stack_size,
+	                task_thread_entry, task, NULL, NULL,
+	                TASK_THREAD_PRIORITY, 0, K_NO_WAIT);
+	k_thread_name_set(&task->thread, task->name);
+	
+	return 0;
+}
+
+/**
+ * @brief Release the thread of a task that is not running
+ */
+static void task_thread_release(struct task_cb *task)
+{
+	if (!task->stack) {
+		return;
 	}
 	
-	return selected;
+	if (task->state == TASK_STATE_TERMINATED) {
+		k_thread_join(&task->thread, K_FOREVER);
+	} else {
+		k_thread_abort(&task->thread);
+	}
+	k_thread_stack_free(task->stack);
+	task->stack = NULL;
 }
 
 int scheduler_init(void)
@@ -208,12 +258,18 @@ int scheduler_init(void)
 	LOG_INF("Initializing scheduler");
 	
 	k_mutex_init(&sched_state.mutex);
+	k_sem_init(&sched_state.switch_sem, 0, 1);
 	
 	for (int i = 0; i < SCHED_MAX_TASKS; i++) {
 		sched_state.tasks[i].in_use = false;
 	}
 	
+	for (int i = 0; i < SCHED_NUM_PRIORITIES; i++) {
+		sys_dlist_init(&sched_state.ready[i]);
+	}
+	
 	sched_state.current_task = -1;
+	sched_state.ready_prios = 0;
 	sched_state.ready_count = 0;
 	sched_state.running = false;
 	sched_state.power_aware = false;
@@ -228,7 +284,8 @@ int scheduler_init(void)
 
 task_handle_t scheduler_create_task(const struct task_config *config)
 {
-	if (!sched_state.initialized || !config || !config->entry) {
+	if (!sched_state.initialized || !config || !config->entry ||
+	    (unsigned int)config->priority >= SCHED_NUM_PRIORITIES) {
 		return -EINVAL;
 	}
 	
@@ -255,12 +312,18 @@ task_handle_t scheduler_create_task(const struct task_config *config)
 	task->state = TASK_STATE_INACTIVE;
 	task->time_slice_ms = config->time_slice_ms > 0 ? 
 	                      config->time_slice_ms : DEFAULT_TIME_SLICE_MS;
+	task->slice_cycles = k_ms_to_cyc_ceil32(task->time_slice_ms);
+	task->stack_size = config->stack_size > 0 ?
+	                   config->stack_size : DEFAULT_STACK_SIZE;
+	task->stack = NULL;
+	task->last_run = 0;
 	task->app_id = config->app_id;
 	task->total_runtime = 0;
 	task->slice_count = 0;
 	task->preemption_count = 0;
 	task->yield_count = 0;
 	task->block_reason = NULL;
+	sys_dnode_init(&task->ready_node);
 	
 	k_mutex_unlock(&sched_state.mutex);
 	
@@ -280,10 +343,22 @@ int scheduler_destroy_task(task_handle_t handle)
 		return -ENOENT;
 	}
 	
+	/* A task ends by returning from its entry function */
+	if (task == self_task()) {
+		k_mutex_unlock(&sched_state.mutex);
+		return -EDEADLK;
+	}
+	
 	remove_from_ready_queue(handle);
+	task_thread_release(task);
 	
 	if (sched_state.current_task == handle) {
+		/* Killed mid-slice: let scheduler_run() carry on, unless the
+		 * task already handed the CPU back and it is about to */
 		sched_state.current_task = -1;
+		if (!sched_state.parked) {
+			k_sem_give(&sched_state.switch_sem);
+		}
 	}
 	
 	LOG_INF("Destroyed task '%s'", task->name);
@@ -364,6 +439,10 @@ int scheduler_resume_task(task_handle_t handle)
 
 int scheduler_set_priority(task_handle_t handle, sched_priority_t priority)
 {
+	if ((unsigned int)priority >= SCHED_NUM_PRIORITIES) {
+		return -EINVAL;
+	}
+	
 	k_mutex_lock(&sched_state.mutex, K_FOREVER);
 	
 	struct task_cb *task = get_task(handle);
@@ -372,12 +451,13 @@ int scheduler_set_priority(task_handle_t handle, sched_priority_t priority)
 		return -ENOENT;
 	}
 	
-	task->priority = priority;
-	
-	/* Re-sort ready queue if task is ready */
-	if (task->state == TASK_STATE_READY) {
+	/* Move to the new priority's list if queued */
+	if (sys_dnode_is_linked(&task->ready_node)) {
 		remove_from_ready_queue(handle);
+		task->priority = priority;
 		add_to_ready_queue(handle);
+	} else {
+		task->priority = priority;
 	}
 	
 	k_mutex_unlock(&sched_state.mutex);
@@ -404,13 +484,13 @@ int scheduler_get_stats(task_handle_t handle, struct task_stats *stats)
 		return -ENOENT;
 	}
 	
-	stats->total_runtime_us = task->total_runtime;
+	stats->total_runtime_us = k_cyc_to_us_floor64(task->total_runtime);
 	stats->num_slices = task->slice_count;
 	stats->num_preemptions = task->preemption_count;
 	stats->num_yields = task->yield_count;
-	stats->last_run_us = 0;  // TODO: Track last run duration
+	stats->last_run_us = k_cyc_to_us_floor32(task->last_run);
 	stats->avg_slice_us = task->slice_count > 0 ? 
-	                      task->total_runtime / task->slice_count : 0;
+	                      k_cyc_to_us_floor64(task->total_runtime / task->slice_count) : 0;
 	
 	return 0;
 }
@@ -424,35 +504,59 @@ void scheduler_yield(void)
 	
 	k_mutex_lock(&sched_state.mutex, K_FOREVER);
 	
-	if (sched_state.current_task >= 0) {
-		struct task_cb *task = get_task(sched_state.current_task);
-		if (task && task->state == TASK_STATE_RUNNING) {
-			task->yield_count++;
-			task->state = TASK_STATE_READY;
-			
-			// Move to end of ready queue (after others of same priority)
-			remove_from_ready_queue(sched_state.current_task);
-			add_to_ready_queue(sched_state.current_task);
-			
-			LOG_DBG("Task '%s' yielded (count=%u)", task->name, task->yield_count);
-		}
+	struct task_cb *task = self_task();
+	if (task && task->state == TASK_STATE_RUNNING) {
+		task->yield_count++;
+		task->state = TASK_STATE_READY;
+		
+		// Move to end of ready queue (after others of same priority)
+		add_to_ready_queue(sched_state.current_task);
+		
+		LOG_DBG("Task '%s' yielded (count=%u)", task->name, task->yield_count);
+		task_park(task);
+		return;
 	}
 	
 	k_mutex_unlock(&sched_state.mutex);
 }
 
+void scheduler_safepoint(void)
+{
+	struct task_cb *task = self_task();
+	
+	/* Cheap enough for hot paths: one cycle counter read while fuel lasts */
+	if (!task || (task->state == TASK_STATE_RUNNING &&
+	              k_cycle_get_32() - task->slice_start < task->slice_cycles)) {
+		return;
+	}
+	
+	k_mutex_lock(&sched_state.mutex, K_FOREVER);
+	
+	if (task->state == TASK_STATE_RUNNING) {
+		/* Out of fuel */
+		task->preemption_count++;
+		task->state = TASK_STATE_READY;
+		add_to_ready_queue(sched_state.current_task);
+		
+		LOG_DBG("Task '%s' preempted (slice=%ums, preempt_count=%u)",
+		        task->name, task->time_slice_ms, task->preemption_count);
+	}
+	
+	/* Also parks a task suspended or blocked by another thread */
+	task_park(task);
+}
+
 void scheduler_block(const char *reason)
 {
 	k_mutex_lock(&sched_state.mutex, K_FOREVER);
 	
-	if (sched_state.current_task >= 0) {
-		struct task_cb *task = get_task(sched_state.current_task);
-		if (task) {
-			task->state = TASK_STATE_BLOCKED;
-			task->block_reason = reason;
-			remove_from_ready_queue(sched_state.current_task);
-			LOG_DBG("Task '%s' blocked: %s", task->name, reason ? reason : "unknown");
-		}
+	struct task_cb *task = self_task();
+	if (task) {
+		task->state = TASK_STATE_BLOCKED;
+		task->block_reason = reason;
+		LOG_DBG("Task '%s' blocked: %s", task->name, reason ? reason : "unknown");
+		task_park(task);
+		return;
 	}
 	
 	k_mutex_unlock(&sched_state.mutex);
@@ -485,48 +589,8 @@ int scheduler_unblock(task_handle_t handle)
 
 void scheduler_tick(void)
 {
+	/* Slices are enforced by scheduler_safepoint(); this only counts */
 	sched_state.tick_count++;
-	
-	// Check if current task exceeded its time slice
-	if (sched_state.current_task >= 0) {
-		struct task_cb *task = get_task(sched_state.current_task);
-		if (!task) {
-			return;
-		}
-		
-		uint64_t current_time = k_uptime_get();
-		uint64_t runtime = current_time - task->start_time;
-		
-		// Convert runtime from us to ms
-		uint32_t runtime_ms = runtime / 1000;
-		
-		if (runtime_ms >= task->time_slice_ms) {
-			// Time slice expired - preempt task
-			k_mutex_lock(&sched_state.mutex, K_FOREVER);
-			
-			if (task->state == TASK_STATE_RUNNING) {
-				task->preemption_count++;
-				task->state = TASK_STATE_READY;
-				
-				// Update runtime statistics
-				task->total_runtime += runtime;
-				
-				// Move to ready queue for rescheduling
-				remove_from_ready_queue(sched_state.current_task);
-				add_to_ready_queue(sched_state.current_task);
-				
-				LOG_DBG("Task '%s' preempted (slice=%ums, preempt_count=%u)",
-				        task->name, task->time_slice_ms, task->preemption_count);
-				
-				// Clear current task to trigger reschedule
-				sched_state.current_task = -1;
-			}
-			
-			k_mutex_unlock(&sched_state.mutex);
-		}
-	}
-	
-	// Update last tick time
 	sched_state.last_tick = k_uptime_get();
 }
 
@@ -538,10 +602,8 @@ int scheduler_run(void)
 	
 	// Main scheduling loop iteration:
 	// 1. Select next task based on priority and readiness
-	// 2. Context switch to selected task
-	// 3. Execute task entry function (WASM app execution)
-	// 4. Update runtime statistics
-	// 5. Handle task completion/blocking/yielding
+	// 2. Let its thread run until it parks, blocks or returns
+	// 3. Put it back in the ready queue if it still has work
 	
 	k_mutex_lock(&sched_state.mutex, K_FOREVER);
 	
@@ -559,42 +621,64 @@ int scheduler_run(void)
 		return -EINVAL;
 	}
 	
-	// Context switch preparation
-	task_handle_t prev = sched_state.current_task;
+	if (!task->stack && task_thread_start(task) < 0) {
+		k_mutex_unlock(&sched_state.mutex);
+		LOG_ERR("No stack for task '%s'", task->name);
+		return -ENOMEM;
+	}
+	
+	// Remove from ready queue while running
+	remove_from_ready_queue(next);
+	
 	sched_state.current_task = next;
 	task->state = TASK_STATE_RUNNING;
 	task->slice_count++;
-	task->start_time = k_uptime_get();
+	task->slice_start = k_cycle_get_32();
 	
-	// Remove from ready queue while running
-	remove_from_ready_queue(next);
+	/* Only this slice's switch may wake us */
+	sched_state.parked = false;
+	k_sem_reset(&sched_state.switch_sem);
 	
 	k_mutex_unlock(&sched_state.mutex);
 	
 	LOG_DBG("Context switch: task '%s' (priority=%d, slice=%u)",
 	        task->name, task->priority, task->slice_count);
 	
-	// Execute task entry function
-	// In real WASM implementation, this calls ocre_resume() or wasm_runtime_execute()
-	if (task->entry) {
-		task->entry(task->arg);
-	}
-	
-	// Task execution completed (returned from entry or yielded/blocked)
-	k_mutex_lock(&sched_state.mutex, K_FOREVER);
+	k_sem_give(&task->run_sem);
 	
-	// Calculate runtime for this execution slice
-	uint64_t runtime = k_uptime_get() - task->start_time;
-	task->total_runtime += runtime;
+	while (true) {
+		// Wait for the task to give the CPU back, nagging about slices it overruns
+		uint32_t timeout_ms = task->time_slice_ms * 2;
+		while (k_sem_take(&sched_state.switch_sem, K_MSEC(timeout_ms)) != 0) {
+			LOG_WRN("Task '%s' ran past its %ums slice without a safe point",
+			        task->name, task->time_slice_ms);
+			timeout_ms = MIN(timeout_ms * 2, 10000);
+		}
+		
+		k_mutex_lock(&sched_state.mutex, K_FOREVER);
+		
+		if (sched_state.current_task != next) {
+			// Destroyed while running
+			k_mutex_unlock(&sched_state.mutex);
+			return 1;
+		}
+		
+		if (task->state != TASK_STATE_RUNNING) {
+			break;
+		}
+		
+		// Woken without a switch: dispatching now would run two tasks
+		LOG_ERR("Spurious switch while task '%s' is still running", task->name);
+		k_mutex_unlock(&sched_state.mutex);
+	}
 	
 	// Handle task state after execution
-	if (task->state == TASK_STATE_RUNNING) {
-		// Task completed normally (entry function returned)
-		task->state = TASK_STATE_TERMINATED;
+	if (task->state == TASK_STATE_TERMINATED) {
+		task_thread_release(task);
 		LOG_INF("Task '%s' terminated (runtime=%lluus, slices=%u)",
-		        task->name, task->total_runtime, task->slice_count);
+		        task->name, k_cyc_to_us_floor64(task->total_runtime), task->slice_count);
 	} else if (task->state == TASK_STATE_READY) {
-		// Task yielded or was preempted - add back to ready queue
+		// Task yielded or ran out of fuel - it is already queued again
 		add_to_ready_queue(next);
 	} else if (task->state == TASK_STATE_BLOCKED) {
 		// Task blocked on I/O or event - stays out of ready queue
@@ -628,10 +712,11 @@ void scheduler_print_debug(void)
 	LOG_INF("Current task: %d", sched_state.current_task);
 	LOG_INF("Ready queue (%d tasks):", sched_state.ready_count);
 	
-	for (int i = 0; i < sched_state.ready_count; i++) {
-		struct task_cb *task = get_task(sched_state.ready_queue[i]);
-		if (task) {
-			LOG_INF("  [%d] %s (pri=%d)", i, task->name, task->priority);
+	int pos = 0;
+	for (int prio = SCHED_NUM_PRIORITIES - 1; prio >= 0; prio--) {
+		struct task_cb *task;
+		SYS_DLIST_FOR_EACH_CONTAINER(&sched_state.ready[prio], task, ready_node) {
+			LOG_INF("  [%d] %s (pri=%d)", pos++, task->name, task->priority);
 		}
 	}
 	
@@ -641,7 +726,7 @@ void scheduler_print_debug(void)
 			struct task_cb *task = &sched_state.tasks[i];
 			LOG_INF("  %s: state=%d, slices=%u, runtime=%llu us",
 			        task->name, task->state, task->slice_count,
-			        task->total_runtime);
+			        k_cyc_to_us_floor64(task->total_runtime));
 		}
 	}
 }
@@ -2,11 +2,19 @@
  * @file scheduler.h
  * @brief WASM App/Container Scheduler
  * 
- * Cooperative scheduler for WASM applications with:
+ * Scheduler for WASM applications with:
  * - Priority-based scheduling
- * - Time slicing
+ * - Time slicing, enforced at safe points
  * - Power-aware scheduling
  * - Fair share scheduling
+ *
+ * Each task runs its entry function on its own thread, one task at a
+ * time. A task that has used up its slice is suspended at its next
+ * scheduler_safepoint() and resumed from there when it is picked again,
+ * so a runaway loop that reaches safe points cannot starve the others.
+ *
+ * WASM apps started through akira_runtime still run on OCRE's container
+ * threads, which are not scheduler tasks; nothing preempts them yet.
  */
 
 #ifndef AKIRA_SCHEDULER_H
@@ -67,7 +75,7 @@ struct task_config {
 	void *arg;
 	sched_priority_t priority;
 	uint32_t time_slice_ms;     // Max execution time per slice
-	uint32_t stack_size;        // Stack size for native tasks
+	uint32_t stack_size;        // Stack size of the task thread
 	uint32_t app_id;            // Associated WASM app ID
 };
 
@@ -153,7 +161,17 @@ int scheduler_get_stats(task_handle_t handle, struct task_stats *stats);
 void scheduler_yield(void);
 
 /**
- * @brief Block current task
+ * @brief Preemption point for the running task
+ *
+ * Suspends the caller if its slice is used up (or it was suspended or
+ * blocked meanwhile) until it is scheduled again. Costs one cycle
+ * counter read otherwise, and does nothing on threads that are not
+ * scheduler tasks, so it can sit on hot paths such as WASM natives.
+ */
+void scheduler_safepoint(void);
+
+/**
+ * @brief Block current task until scheduler_unblock()
  * @param reason Block reason (for debugging)
  */
 void scheduler_block(const char *reason);
@@ -167,11 +185,18 @@ int scheduler_unblock(task_handle_t handle);
 
 /**
  * @brief Run scheduler tick (call from timer interrupt)
+ *
+ * Only counts ticks; slices are measured in cycles by
+ * scheduler_safepoint().
  */
 void scheduler_tick(void);
 
 /**
  * @brief Run one scheduling cycle
+ *
+ * Lets the best ready task run until it yields, blocks, returns or is
+ * preempted at a safe point.
+ *
  * @return Number of tasks executed
  */
 int scheduler_run(void);
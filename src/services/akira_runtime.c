@@ -8,6 +8,9 @@
 
 #include "akira_runtime.h"
 #include "../storage/fs_manager.h"
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+#include "../ipc/shared_memory.h"
+#endif
 
 #include <ocre/ocre.h>
 #include <ocre/ocre_container_runtime/ocre_container_runtime.h>
@@ -31,6 +34,33 @@ LOG_MODULE_REGISTER(akira_runtime, CONFIG_AKIRA_LOG_LEVEL);
 static ocre_cs_ctx g_ctx;
 static bool g_initialized = false;
 
+/* ===== Helpers ===== */
+
+/*
+ * Shared memory mapped into the container's instance pins the region (it
+ * cannot be destroyed while attached), and regions or rings the app
+ * opened stay allocated until closed. Drop both before OCRE tears the
+ * instance down.
+ */
+static void release_ipc_mappings(int container_id)
+{
+#ifdef CONFIG_AKIRA_SHMEM_WASM
+    extern int akira_native_release_wasm_ipc(wasm_module_inst_t module_inst);
+
+    wasm_module_inst_t inst = g_ctx.containers[container_id].ocre_runtime_arguments.module_inst;
+    if (inst)
+    {
+        int n = akira_native_release_wasm_ipc(inst);
+        if (n > 0)
+        {
+            LOG_INF("Container %d: released %d shared memory reference(s)", container_id, n);
+        }
+    }
+#else
+    ARG_UNUSED(container_id);
+#endif
+}
+
 /* ===== Initialization ===== */
 
 int akira_runtime_init(void)
@@ -303,6 +333,8 @@ int akira_runtime_stop(int container_id)
 
     LOG_INF("Stopping container %d...", container_id);
 
+    release_ipc_mappings(container_id);
+
     ocre_container_status_t status = ocre_container_runtime_stop_container(container_id, NULL);
 
     if (status == CONTAINER_STATUS_STOPPED)
@@ -331,6 +363,8 @@ int akira_runtime_destroy(int container_id)
 
     LOG_INF("Destroying container %d...", container_id);
 
+    release_ipc_mappings(container_id);
+
     ocre_container_status_t status = ocre_container_runtime_destroy_container(
         &g_ctx, container_id, NULL);
 
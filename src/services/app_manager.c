@@ -8,6 +8,8 @@
 #include "app_manager.h"
 #include "akira_runtime.h"
 #include "../storage/fs_manager.h"
+#include "akira/kernel/memory.h"
+#include "akira/kernel/trace.h"
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/fs/fs.h>
@@ -331,7 +333,7 @@ int app_manager_install_from_path(const char *path)
     }
 
     /* Allocate buffer */
-    uint8_t *buffer = k_malloc(size);
+    uint8_t *buffer = akira_malloc(size);
     if (!buffer)
     {
         LOG_ERR("Failed to allocate %zd bytes", size);
@@ -343,7 +345,7 @@ int app_manager_install_from_path(const char *path)
     if (bytes_read != size)
     {
         LOG_ERR("Read failed: %zd != %zd", bytes_read, size);
-        k_free(buffer);
+        akira_free(buffer);
         return -EIO;
     }
 
@@ -387,14 +389,14 @@ int app_manager_install_from_path(const char *path)
         if (app_manifest_parse(json, mf_size, &manifest) == 0)
         {
             int ret = app_manager_install(name, buffer, size, &manifest, source);
-            k_free(buffer);
+            akira_free(buffer);
             return ret;
         }
     }
 
     /* Install without manifest */
     int ret = app_manager_install(name, buffer, size, NULL, source);
-    k_free(buffer);
+    akira_free(buffer);
     return ret;
 }
 
@@ -491,7 +493,7 @@ int app_manager_start(const char *name)
         snprintf(path, sizeof(path), "%s/%03d_%s.wasm",
                  APPS_DIR, app->id, app->name);
 
-        uint8_t *buffer = k_malloc(app->size);
+        uint8_t *buffer = akira_malloc(app->size);
         if (!buffer)
         {
             k_mutex_unlock(&g_registry_mutex);
@@ -501,7 +503,7 @@ int app_manager_start(const char *name)
         ssize_t bytes_read = fs_manager_read_file(path, buffer, app->size);
         if (bytes_read < 0)
         {
-            k_free(buffer);
+            akira_free(buffer);
             k_mutex_unlock(&g_registry_mutex);
             LOG_ERR("Failed to read app binary: %s (err %zd)", path, bytes_read);
             return (int)bytes_read;
@@ -509,7 +511,7 @@ int app_manager_start(const char *name)
 
         if (bytes_read != app->size)
         {
-            k_free(buffer);
+            akira_free(buffer);
             k_mutex_unlock(&g_registry_mutex);
             LOG_ERR("App binary size mismatch: expected %zu, got %zd", app->size, bytes_read);
             return -EIO;
@@ -517,7 +519,7 @@ int app_manager_start(const char *name)
 
         /* Install into Akira runtime (saves binary + creates container) */
         int load_ret = akira_runtime_install(name, buffer, app->size);
-        k_free(buffer);
+        akira_free(buffer);
 
         if (load_ret < 0)
         {
@@ -1312,6 +1314,7 @@ static void set_app_state(app_entry_t *app, app_state_t new_state)
 
     app_state_t old_state = app->state;
     app->state = new_state;
+    AKIRA_TRACE(AKIRA_TRACE_APP_STATE, new_state, app->id, old_state);
 
     LOG_INF("App %s: %s -> %s", app->name,
             app_state_to_str(old_state), app_state_to_str(new_state));
@@ -1340,6 +1343,7 @@ static void set_app_state(app_entry_t *app, app_state_t new_state)
             LOG_ERR("App %s exceeded max restarts (%d), marking as FAILED",
                     app->name, app->restart.max_retries);
             app->state = APP_STATE_FAILED;
+            AKIRA_TRACE(AKIRA_TRACE_APP_STATE, APP_STATE_FAILED, app->id, new_state);
         }
     }
 }
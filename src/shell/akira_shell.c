@@ -316,7 +316,14 @@ static const char *const button_names[] = {
 /* Work queue for periodic tasks */
 static struct k_work_q shell_workq;
 static K_THREAD_STACK_DEFINE(shell_workq_stack, 1024); /* Reduced to save memory */
-static struct k_work_delayable stats_update_work;
+static struct k_work stats_update_work;
+static struct k_work status_bar_work;
+
+/* Periodic refresh; the slack lets these share wakeups with other timers */
+#define STATS_UPDATE_PERIOD_MS 30000
+#define STATS_UPDATE_SLACK_MS 5000
+#define STATUS_BAR_PERIOD_MS 1000
+#define STATUS_BAR_SLACK_MS 250
 
 /* Helper functions */
 static inline uint8_t rotation_to_index(uint16_t degrees)
@@ -450,9 +457,6 @@ static void update_system_stats(void)
 static void stats_update_work_handler(struct k_work *work)
 {
     update_system_stats();
-
-    /* Reschedule for next update */
-    k_work_reschedule_for_queue(&shell_workq, &stats_update_work, K_SECONDS(30));
 }
 
 /* Status bar update work */
@@ -461,12 +465,33 @@ static void status_bar_update_work_handler(struct k_work *work)
     if (shell_display_enabled && shell_display_is_enabled()) {
         shell_display_update_status();
     }
-    
-    /* Reschedule for next update */
-    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
-    k_work_reschedule_for_queue(&shell_workq, dwork, K_SECONDS(1));
 }
-static K_WORK_DELAYABLE_DEFINE(status_bar_work, status_bar_update_work_handler);
+
+/* Periodic timer: run the refresh on the shell work queue */
+static void shell_refresh_timer_handler(akira_timer_t *timer, void *user_data)
+{
+    k_work_submit_to_queue(&shell_workq, (struct k_work *)user_data);
+}
+
+static void shell_refresh_timer_start(const char *name, akira_duration_t initial_ms,
+                                      akira_duration_t period_ms, akira_duration_t slack_ms,
+                                      struct k_work *work)
+{
+    akira_timer_config_t config = {
+        .name = name,
+        .mode = AKIRA_TIMER_PERIODIC,
+        .period_ms = period_ms,
+        .initial_ms = initial_ms,
+        .slack_ms = slack_ms,
+        .callback = shell_refresh_timer_handler,
+        .user_data = work,
+        .start_immediately = true};
+
+    if (!akira_timer_create(&config))
+    {
+        LOG_WRN("No timer for %s refresh", name);
+    }
+}
 
 /* Public API Implementation */
 int akira_shell_init(void)
@@ -486,8 +511,11 @@ int akira_shell_init(void)
                        K_PRIO_COOP(8), NULL);
 
     /* Initialize periodic stats update */
-    k_work_init_delayable(&stats_update_work, stats_update_work_handler);
-    k_work_schedule_for_queue(&shell_workq, &stats_update_work, K_SECONDS(5));
+    akira_timer_subsystem_init();
+    k_work_init(&stats_update_work, stats_update_work_handler);
+    k_work_init(&status_bar_work, status_bar_update_work_handler);
+    shell_refresh_timer_start("shell_stats", 5000, STATS_UPDATE_PERIOD_MS,
+                              STATS_UPDATE_SLACK_MS, &stats_update_work);
 
     /* Initialize cached stats */
     update_system_stats();
@@ -500,7 +528,8 @@ int akira_shell_init(void)
             shell_display_enabled = false;
         } else {
             /* Start status bar updates */
-            k_work_schedule_for_queue(&shell_workq, &status_bar_work, K_SECONDS(1));
+            shell_refresh_timer_start("status_bar", STATUS_BAR_PERIOD_MS, STATUS_BAR_PERIOD_MS,
+                                      STATUS_BAR_SLACK_MS, &status_bar_work);
             
             /* Welcome message */
             shell_display_print("", SHELL_TEXT_NORMAL);
@@ -0,0 +1,62 @@
+/**
+ * @file baseline.h
+ * @brief Stored message bus benchmark baselines
+ *
+ * The scaling ratios are checked with CONFIG_MSG_BUS_BENCH_ENFORCE=y
+ * (the default). They compare the suite against itself within one run,
+ * so they hold on any host. They were measured over 20 runs of a host
+ * build of message_bus.c (x86-64 Linux, -O2, synchronous delivery):
+ *
+ *   deliveries/s at fan-out 16 vs fan-out 1       194% .. 327%
+ *   zero-copy msgs/s at 4096 B vs 4 B              91% .. 152%
+ *
+ * The floors below leave room for the thread switches native_sim adds
+ * to every message. A fan-out floor of 100% still fails if per-delivery
+ * cost stops being amortised across subscribers. A zero-copy floor of
+ * 75% fails if publish_buf starts copying the payload.
+ *
+ * The absolute figures are only checked with
+ * CONFIG_MSG_BUS_BENCH_ABSOLUTE=y, widened by
+ * CONFIG_MSG_BUS_BENCH_TOLERANCE_PCT. They are placeholders, not a
+ * recorded measurement. Replace them with the numbers of the machine
+ * that enforces them: run the suite a few times, copy the worst values
+ * from the "BENCH" lines, and note the host and Zephyr revision here.
+ */
+
+#ifndef MSG_BUS_BENCH_BASELINE_H
+#define MSG_BUS_BENCH_BASELINE_H
+
+/* Deliveries/s at the largest fan-out as a percentage of fan-out 1 */
+#define BASELINE_FANOUT_SCALING_PCT   100
+
+/* Zero-copy msgs/s at the largest payload as a percentage of the smallest */
+#define BASELINE_BUF_SIZE_RETAIN_PCT   75
+
+/* Deliveries per second, indexed like bench_fanouts[] (1, 2, 4, 8, 16) */
+#define BASELINE_FANOUT_COUNT 5
+static const uint32_t baseline_fanout_dps[BASELINE_FANOUT_COUNT] = {
+	150000, 250000, 350000, 400000, 450000,
+};
+
+/* Publish-to-handler latency, single subscriber (ns) */
+#define BASELINE_LATENCY_P50_NS   20000
+#define BASELINE_LATENCY_P99_NS   80000
+#define BASELINE_LATENCY_P999_NS 250000
+
+/* Messages per second, indexed like bench_payload_sizes[] */
+#define BASELINE_PAYLOAD_COUNT 5
+static const uint32_t baseline_payload_copy_mps[BASELINE_PAYLOAD_COUNT] = {
+	150000, 150000, 140000, 120000, 80000,
+};
+static const uint32_t baseline_payload_buf_mps[BASELINE_PAYLOAD_COUNT] = {
+	150000, 150000, 150000, 150000, 150000,
+};
+
+/*
+ * Queue-full behaviour is deterministic and does not depend on host
+ * speed. A burst of N messages into a lane of depth D drops at most
+ * N - D. A manually drained mailbox of depth D drops exactly N - D.
+ */
+#define BASELINE_BURST_FACTOR 4
+
+#endif /* MSG_BUS_BENCH_BASELINE_H */
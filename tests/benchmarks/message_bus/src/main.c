@@ -0,0 +1,452 @@
+/**
+ * @file main.c
+ * @brief Message bus benchmark suite
+ *
+ * Measures delivery throughput against subscriber fan-out, end-to-end
+ * latency percentiles, the cost of payload size on the copying and the
+ * zero-copy publish paths, and drop behaviour when lanes and mailboxes
+ * overflow. Results are printed as "BENCH" lines. With
+ * CONFIG_MSG_BUS_BENCH_ENFORCE=y the fan-out and payload-size scaling is
+ * checked against baseline.h, and with CONFIG_MSG_BUS_BENCH_ABSOLUTE=y
+ * so are the absolute figures. Drop counts are always checked.
+ *
+ * The test thread runs below the dispatcher and the delivery queue, so
+ * every publish is fully delivered before the next one starts and the
+ * numbers reflect per-message cost rather than queueing.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <string.h>
+
+#include "message_bus.h"
+#include "baseline.h"
+
+#define BENCH_TOPIC         "bench/data"
+#define BENCH_MESSAGES      CONFIG_MSG_BUS_BENCH_MESSAGES
+#define BENCH_WAIT_MS       5000
+
+#ifdef CONFIG_MSG_BUS_BENCH_ABSOLUTE
+#define BENCH_TOLERANCE     CONFIG_MSG_BUS_BENCH_TOLERANCE_PCT
+#endif
+
+static const int bench_fanouts[BASELINE_FANOUT_COUNT] = { 1, 2, 4, 8, 16 };
+static const size_t bench_payload_sizes[BASELINE_PAYLOAD_COUNT] = {
+	4, 64, 512, 2048, 4096,
+};
+
+/*===========================================================================*/
+/* Clock                                                                      */
+/*===========================================================================*/
+
+#ifdef CONFIG_ARCH_POSIX
+extern uint64_t bench_host_clock_ns(void);
+
+/* Overrides the weak bus clock: host nanoseconds, truncated to 32 bits */
+uint32_t msg_bus_clock(void)
+{
+	return (uint32_t)bench_host_clock_ns();
+}
+
+static inline uint64_t bench_clock_to_ns(uint32_t delta)
+{
+	return delta;
+}
+#else
+static inline uint64_t bench_clock_to_ns(uint32_t delta)
+{
+	return k_cyc_to_ns_floor64(delta);
+}
+#endif
+
+static inline uint32_t bench_now(void)
+{
+	return msg_bus_clock();
+}
+
+static inline uint64_t bench_elapsed_ns(uint32_t start)
+{
+	return bench_clock_to_ns(bench_now() - start);
+}
+
+static uint32_t bench_rate(uint32_t count, uint64_t ns)
+{
+	if (ns == 0) {
+		return UINT32_MAX;
+	}
+	return (uint32_t)(((uint64_t)count * 1000000000ULL) / ns);
+}
+
+/*===========================================================================*/
+/* Latency histogram                                                          */
+/*===========================================================================*/
+
+/*
+ * Log-linear buckets: values below 16 are exact, above that each power of
+ * two is split into eight sub-buckets, so a reported percentile is within
+ * 12.5% of the true value.
+ */
+#define HIST_SUB_BITS       3
+#define HIST_SUB_COUNT      (1U << HIST_SUB_BITS)
+#define HIST_LINEAR         16
+#define HIST_BUCKETS        (HIST_LINEAR + (32 - 4) * HIST_SUB_COUNT)
+
+struct latency_hist {
+	uint32_t buckets[HIST_BUCKETS];
+	uint32_t count;
+	uint32_t max;
+};
+
+static struct latency_hist hist;
+
+static uint32_t hist_index(uint32_t v)
+{
+	if (v < HIST_LINEAR) {
+		return v;
+	}
+
+	uint32_t msb = 31 - __builtin_clz(v);
+	uint32_t sub = (v >> (msb - HIST_SUB_BITS)) & (HIST_SUB_COUNT - 1);
+
+	return HIST_LINEAR + (msb - 4) * HIST_SUB_COUNT + sub;
+}
+
+/* Upper bound of a bucket, so percentiles never under-report */
+static uint32_t hist_bucket_max(uint32_t idx)
+{
+	if (idx < HIST_LINEAR) {
+		return idx;
+	}
+
+	uint32_t msb = (idx - HIST_LINEAR) / HIST_SUB_COUNT + 4;
+	uint32_t sub = (idx - HIST_LINEAR) % HIST_SUB_COUNT;
+	uint64_t lo = ((uint64_t)(HIST_SUB_COUNT + sub)) << (msb - HIST_SUB_BITS);
+	uint64_t hi = lo + (1ULL << (msb - HIST_SUB_BITS)) - 1;
+
+	return hi > UINT32_MAX ? UINT32_MAX : (uint32_t)hi;
+}
+
+static void hist_record(struct latency_hist *h, uint32_t v)
+{
+	h->buckets[hist_index(v)]++;
+	h->count++;
+	if (v > h->max) {
+		h->max = v;
+	}
+}
+
+/* permille: 500 = p50, 990 = p99, 999 = p99.9 */
+static uint32_t hist_percentile(const struct latency_hist *h, uint32_t permille)
+{
+	if (h->count == 0) {
+		return 0;
+	}
+
+	uint64_t rank = ((uint64_t)h->count * permille + 999) / 1000;
+	uint64_t seen = 0;
+
+	for (uint32_t i = 0; i < HIST_BUCKETS; i++) {
+		seen += h->buckets[i];
+		if (seen >= rank) {
+			uint32_t bound = hist_bucket_max(i);
+			return bound < h->max ? bound : h->max;
+		}
+	}
+	return h->max;
+}
+
+/*===========================================================================*/
+/* Helpers                                                                    */
+/*===========================================================================*/
+
+static atomic_t delivered;
+static bool record_latency;
+
+static void bench_handler(const struct akira_message *msg, void *user_data)
+{
+	ARG_UNUSED(user_data);
+
+	if (record_latency) {
+		uint32_t now = bench_now();
+		hist_record(&hist, (uint32_t)bench_clock_to_ns(now - msg->header.timestamp_hr));
+	}
+	atomic_inc(&delivered);
+}
+
+static bool wait_delivered(uint32_t target)
+{
+	int64_t deadline = k_uptime_get() + BENCH_WAIT_MS;
+
+	while ((uint32_t)atomic_get(&delivered) < target) {
+		if (k_uptime_get() > deadline) {
+			return false;
+		}
+		k_sleep(K_MSEC(1));
+	}
+	return true;
+}
+
+static void subscribe_n(int *ids, int n)
+{
+	for (int i = 0; i < n; i++) {
+		ids[i] = msg_bus_subscribe(BENCH_TOPIC, bench_handler, NULL);
+		zassert_true(ids[i] >= 0, "subscribe %d failed: %d", i, ids[i]);
+	}
+}
+
+static void unsubscribe_n(const int *ids, int n)
+{
+	for (int i = 0; i < n; i++) {
+		msg_bus_unsubscribe(ids[i]);
+	}
+}
+
+static void check_floor(const char *what, uint32_t measured, uint32_t baseline)
+{
+#ifdef CONFIG_MSG_BUS_BENCH_ABSOLUTE
+	uint64_t floor = (uint64_t)baseline * (100 - BENCH_TOLERANCE) / 100;
+
+	zassert_true(measured >= floor,
+	             "%s regressed: %u < %u (baseline %u)",
+	             what, measured, (uint32_t)floor, baseline);
+#else
+	ARG_UNUSED(what);
+	ARG_UNUSED(measured);
+	ARG_UNUSED(baseline);
+#endif
+}
+
+static void check_ceiling(const char *what, uint32_t measured, uint32_t baseline)
+{
+#ifdef CONFIG_MSG_BUS_BENCH_ABSOLUTE
+	uint64_t ceiling = (uint64_t)baseline * (100 + BENCH_TOLERANCE) / 100;
+
+	zassert_true(measured <= ceiling,
+	             "%s regressed: %u > %u (baseline %u)",
+	             what, measured, (uint32_t)ceiling, baseline);
+#else
+	ARG_UNUSED(what);
+	ARG_UNUSED(measured);
+	ARG_UNUSED(baseline);
+#endif
+}
+
+/* Fails if large is below pct percent of small, measured in the same run */
+static void check_scaling(const char *what, uint32_t large, uint32_t small,
+                          uint32_t pct)
+{
+	uint32_t ratio = small ? (uint32_t)((uint64_t)large * 100 / small) : 0;
+
+	TC_PRINT("BENCH %s_pct=%u\n", what, ratio);
+#ifdef CONFIG_MSG_BUS_BENCH_ENFORCE
+	zassert_true(ratio >= pct, "%s regressed: %u%% < %u%%", what, ratio, pct);
+#else
+	ARG_UNUSED(pct);
+#endif
+}
+
+/*===========================================================================*/
+/* Tests                                                                      */
+/*===========================================================================*/
+
+ZTEST(msg_bus_bench, test_throughput_fanout)
+{
+	static uint8_t payload[16];
+	uint32_t dps[BASELINE_FANOUT_COUNT];
+	int ids[16];
+
+	for (int f = 0; f < BASELINE_FANOUT_COUNT; f++) {
+		int n = bench_fanouts[f];
+
+		subscribe_n(ids, n);
+		atomic_set(&delivered, 0);
+
+		uint32_t start = bench_now();
+		for (int i = 0; i < BENCH_MESSAGES; i++) {
+			int ret = msg_bus_publish(BENCH_TOPIC, payload, sizeof(payload),
+			                          MSG_PRIORITY_NORMAL);
+			zassert_true(ret >= 0, "publish failed: %d", ret);
+		}
+		bool done = wait_delivered(BENCH_MESSAGES * n);
+		uint64_t ns = bench_elapsed_ns(start);
+
+		unsubscribe_n(ids, n);
+		zassert_true(done, "fanout %d: only %d of %d delivered", n,
+		             (int)atomic_get(&delivered), BENCH_MESSAGES * n);
+
+		uint32_t mps = bench_rate(BENCH_MESSAGES, ns);
+		dps[f] = bench_rate(BENCH_MESSAGES * n, ns);
+
+		TC_PRINT("BENCH fanout=%d msgs_per_s=%u deliveries_per_s=%u\n",
+		         n, mps, dps[f]);
+		check_floor("fanout deliveries/s", dps[f], baseline_fanout_dps[f]);
+	}
+
+	check_scaling("fanout_scaling", dps[BASELINE_FANOUT_COUNT - 1], dps[0],
+	              BASELINE_FANOUT_SCALING_PCT);
+}
+
+ZTEST(msg_bus_bench, test_latency_percentiles)
+{
+	static uint8_t payload[16];
+	int id;
+
+	memset(&hist, 0, sizeof(hist));
+	subscribe_n(&id, 1);
+	atomic_set(&delivered, 0);
+	record_latency = true;
+
+	for (int i = 0; i < BENCH_MESSAGES; i++) {
+		int ret = msg_bus_publish(BENCH_TOPIC, payload, sizeof(payload),
+		                          MSG_PRIORITY_NORMAL);
+		zassert_true(ret >= 0, "publish failed: %d", ret);
+	}
+	bool done = wait_delivered(BENCH_MESSAGES);
+
+	record_latency = false;
+	unsubscribe_n(&id, 1);
+	zassert_true(done, "only %d of %d delivered",
+	             (int)atomic_get(&delivered), BENCH_MESSAGES);
+
+	uint32_t p50 = hist_percentile(&hist, 500);
+	uint32_t p99 = hist_percentile(&hist, 990);
+	uint32_t p999 = hist_percentile(&hist, 999);
+
+	TC_PRINT("BENCH latency_ns samples=%u p50=%u p99=%u p999=%u max=%u\n",
+	         hist.count, p50, p99, p999, hist.max);
+	check_ceiling("latency p50", p50, BASELINE_LATENCY_P50_NS);
+	check_ceiling("latency p99", p99, BASELINE_LATENCY_P99_NS);
+	check_ceiling("latency p999", p999, BASELINE_LATENCY_P999_NS);
+}
+
+ZTEST(msg_bus_bench, test_payload_size)
+{
+	static uint8_t payload[MSG_MAX_PAYLOAD_SIZE];
+	uint32_t buf_mps[BASELINE_PAYLOAD_COUNT];
+	int id;
+
+	subscribe_n(&id, 1);
+
+	for (int s = 0; s < BASELINE_PAYLOAD_COUNT; s++) {
+		size_t len = bench_payload_sizes[s];
+
+		/* Copying path: msg_bus_publish() allocates and fills a buffer */
+		atomic_set(&delivered, 0);
+		uint32_t start = bench_now();
+		for (int i = 0; i < BENCH_MESSAGES; i++) {
+			int ret = msg_bus_publish(BENCH_TOPIC, payload, len,
+			                          MSG_PRIORITY_NORMAL);
+			zassert_true(ret >= 0, "publish %zu failed: %d", len, ret);
+		}
+		zassert_true(wait_delivered(BENCH_MESSAGES), "copy %zu stalled", len);
+		uint32_t copy_mps = bench_rate(BENCH_MESSAGES, bench_elapsed_ns(start));
+
+		/* Zero-copy path: one buffer shared by every publish */
+		struct msg_buf *buf = msg_buf_alloc(len, K_NO_WAIT);
+		zassert_not_null(buf, "msg_buf_alloc(%zu) failed", len);
+		buf->len = len;
+
+		atomic_set(&delivered, 0);
+		start = bench_now();
+		for (int i = 0; i < BENCH_MESSAGES; i++) {
+			int ret = msg_bus_publish_buf(BENCH_TOPIC, msg_buf_ref(buf),
+			                              MSG_PRIORITY_NORMAL);
+			zassert_true(ret >= 0, "publish_buf %zu failed: %d", len, ret);
+		}
+		zassert_true(wait_delivered(BENCH_MESSAGES), "buf %zu stalled", len);
+		buf_mps[s] = bench_rate(BENCH_MESSAGES, bench_elapsed_ns(start));
+		msg_buf_unref(buf);
+
+		TC_PRINT("BENCH payload=%zu copy_msgs_per_s=%u buf_msgs_per_s=%u\n",
+		         len, copy_mps, buf_mps[s]);
+		check_floor("copy publish msgs/s", copy_mps,
+		            baseline_payload_copy_mps[s]);
+		check_floor("zero-copy publish msgs/s", buf_mps[s],
+		            baseline_payload_buf_mps[s]);
+	}
+
+	unsubscribe_n(&id, 1);
+	check_scaling("buf_size_retain", buf_mps[BASELINE_PAYLOAD_COUNT - 1],
+	              buf_mps[0], BASELINE_BUF_SIZE_RETAIN_PCT);
+}
+
+ZTEST(msg_bus_bench, test_lane_full_drops)
+{
+	static uint8_t payload[16];
+	const uint32_t depth = CONFIG_AKIRA_MSG_BUS_LANE_DEPTH_NORMAL;
+	const uint32_t burst = depth * BASELINE_BURST_FACTOR;
+	uint32_t before, after, pending;
+	int id;
+
+	subscribe_n(&id, 1);
+	atomic_set(&delivered, 0);
+	msg_bus_lane_stats(MSG_PRIORITY_NORMAL, &pending, &before);
+
+	/* Keep the dispatcher off the CPU so the lane really fills up */
+	k_sched_lock();
+	for (uint32_t i = 0; i < burst; i++) {
+		msg_bus_publish(BENCH_TOPIC, payload, sizeof(payload),
+		                MSG_PRIORITY_NORMAL);
+	}
+	k_sched_unlock();
+
+	msg_bus_lane_stats(MSG_PRIORITY_NORMAL, &pending, &after);
+	bool done = wait_delivered(burst - (after - before));
+	unsubscribe_n(&id, 1);
+
+	uint32_t dropped = after - before;
+
+	TC_PRINT("BENCH lane_full burst=%u depth=%u dropped=%u drop_pct=%u\n",
+	         burst, depth, dropped, dropped * 100 / burst);
+	zassert_true(done, "survivors were not delivered");
+	zassert_true(dropped <= burst - depth,
+	             "lane dropped %u of %u, expected at most %u",
+	             dropped, burst, burst - depth);
+}
+
+ZTEST(msg_bus_bench, test_mailbox_full_drops)
+{
+	static uint8_t payload[16];
+	const struct msg_mailbox_config cfg = {
+		.depth = CONFIG_AKIRA_MSG_BUS_MAILBOX_DEPTH,
+		.overflow = MSG_OVERFLOW_DROP_NEWEST,
+		.manual = true,
+	};
+	const uint32_t burst = cfg.depth * BASELINE_BURST_FACTOR;
+	struct msg_sub_stats stats;
+
+	int id = msg_bus_subscribe_mailbox(BENCH_TOPIC, bench_handler, NULL, &cfg);
+	zassert_true(id >= 0, "subscribe failed: %d", id);
+	atomic_set(&delivered, 0);
+
+	/* Nobody drains the mailbox until the burst is over */
+	for (uint32_t i = 0; i < burst; i++) {
+		int ret = msg_bus_publish(BENCH_TOPIC, payload, sizeof(payload),
+		                          MSG_PRIORITY_NORMAL);
+		zassert_true(ret >= 0, "publish failed: %d", ret);
+	}
+
+	zassert_ok(msg_bus_subscriber_stats(id, &stats));
+	int drained = msg_bus_mailbox_process(id, K_NO_WAIT);
+	msg_bus_unsubscribe(id);
+
+	uint32_t got = (uint32_t)atomic_get(&delivered);
+
+	TC_PRINT("BENCH mailbox_full burst=%u depth=%u dropped=%u drop_pct=%u\n",
+	         burst, cfg.depth, stats.dropped, stats.dropped * 100 / burst);
+	zassert_equal(drained, cfg.depth, "drained %d, expected %u",
+	              drained, cfg.depth);
+	zassert_equal(got, cfg.depth, "delivered %u, expected %u",
+	              got, cfg.depth);
+	zassert_equal(stats.dropped, burst - cfg.depth,
+	              "mailbox dropped %u of %u, expected %u",
+	              stats.dropped, burst, burst - cfg.depth);
+}
+
+static void *bench_setup(void)
+{
+	zassert_ok(msg_bus_init());
+	return NULL;
+}
+
+ZTEST_SUITE(msg_bus_bench, NULL, bench_setup, NULL, NULL, NULL);
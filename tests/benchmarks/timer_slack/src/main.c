@@ -0,0 +1,138 @@
+/**
+ * @file main.c
+ * @brief Timer slack wakeup benchmark
+ *
+ * Runs one set of periodic timers twice, exact and with a quarter period
+ * of slack, and reports how often the timer subsystem had to wake up.
+ * Results are printed as "BENCH" lines. The only checks are relative to
+ * the same run: every expiry must stay inside its window and slack must
+ * save wakeups.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "timer.h"
+#include "memory.h"
+
+#define BENCH_TIMERS        CONFIG_TIMER_SLACK_BENCH_TIMERS
+#define BENCH_DURATION_MS   (CONFIG_TIMER_SLACK_BENCH_DURATION_S * 1000)
+#define BENCH_PERIOD_MIN_MS 100
+#define BENCH_PERIOD_SPAN   2000
+#define BENCH_SLACK_DIV     4
+#define BENCH_SEED          3
+
+/* Kernel timeouts round up to a whole tick and add one more */
+#define BENCH_ROUNDING_MS   k_ticks_to_ms_ceil32(2)
+
+struct bench_timer {
+	akira_timer_t *timer;
+	int64_t nominal;
+	uint32_t period;
+	uint32_t slack;
+};
+
+static struct bench_timer timers[BENCH_TIMERS];
+static atomic_t violations;
+
+/* timer.c allocates through the Akira heap; k_malloc stands in for it */
+void *akira_malloc(size_t size)
+{
+	return k_malloc(size);
+}
+
+void akira_free(void *ptr)
+{
+	k_free(ptr);
+}
+
+static void bench_callback(akira_timer_t *timer, void *user_data)
+{
+	struct bench_timer *bt = user_data;
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(timer);
+
+	if (now < bt->nominal ||
+	    now > bt->nominal + bt->slack + BENCH_ROUNDING_MS) {
+		if (atomic_inc(&violations) == 0) {
+			TC_PRINT("expiry at %lld outside [%lld, +%u]\n", now,
+			         bt->nominal, bt->slack);
+		}
+	}
+	bt->nominal += bt->period;
+}
+
+/**
+ * @brief Run all timers for BENCH_DURATION_MS
+ * @return Wakeups the run needed
+ */
+static uint32_t bench_run(const char *label, uint32_t slack_div)
+{
+	akira_timer_stats_t before, after;
+	uint32_t seed = BENCH_SEED;
+
+	atomic_set(&violations, 0);
+	zassert_ok(akira_timer_get_stats(&before));
+
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		struct bench_timer *bt = &timers[i];
+
+		seed = seed * 1103515245u + 12345u;
+		bt->period = BENCH_PERIOD_MIN_MS + (seed >> 16) % BENCH_PERIOD_SPAN;
+		bt->slack = slack_div ? bt->period / slack_div : 0;
+		bt->nominal = k_uptime_get() + bt->period;
+
+		akira_timer_config_t config = {
+			.name = "bench",
+			.mode = AKIRA_TIMER_PERIODIC,
+			.period_ms = bt->period,
+			.slack_ms = bt->slack,
+			.callback = bench_callback,
+			.user_data = bt,
+			.start_immediately = true,
+		};
+
+		bt->timer = akira_timer_create(&config);
+		zassert_not_null(bt->timer, "timer %d not created", i);
+	}
+
+	k_sleep(K_MSEC(BENCH_DURATION_MS));
+
+	for (int i = 0; i < BENCH_TIMERS; i++) {
+		akira_timer_destroy(timers[i].timer);
+	}
+
+	zassert_ok(akira_timer_get_stats(&after));
+
+	uint32_t wakeups = after.wakeups - before.wakeups;
+	uint32_t expirations = after.expirations - before.expirations;
+
+	TC_PRINT("BENCH %s timers=%d duration_ms=%d wakeups=%u expirations=%u "
+	         "deferred=%u\n", label, BENCH_TIMERS, BENCH_DURATION_MS,
+	         wakeups, expirations, after.deferred - before.deferred);
+	zassert_equal(atomic_get(&violations), 0,
+	              "%s: %d expiries outside their window", label,
+	              (int)atomic_get(&violations));
+
+	return wakeups;
+}
+
+ZTEST(timer_slack_bench, test_slack_saves_wakeups)
+{
+	uint32_t exact = bench_run("exact", 0);
+	uint32_t slack = bench_run("slack", BENCH_SLACK_DIV);
+
+	TC_PRINT("BENCH wakeups exact=%u slack=%u saved_pct=%u\n", exact, slack,
+	         exact ? (exact - MIN(slack, exact)) * 100 / exact : 0);
+	zassert_true(slack < exact, "slack did not save wakeups (%u vs %u)",
+	             slack, exact);
+}
+
+static void *bench_setup(void)
+{
+	zassert_ok(akira_timer_subsystem_init());
+	return NULL;
+}
+
+ZTEST_SUITE(timer_slack_bench, NULL, bench_setup, NULL, NULL, NULL);
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Decode AkiraOS allocation-profiler dumps.
+
+Reads either a raw dump saved on native_sim with `akira memprof dump <file>`
+or a console log containing the `AMPF:<hex>` lines printed by
+`akira memprof dump` on hardware, and prints the sites holding the most
+live bytes. With --elf, site addresses are resolved to function and line
+through addr2line.
+
+    tools/akira_memprof.py dump.bin --elf build/zephyr/zephyr.exe
+    tools/akira_memprof.py console.log --elf build/zephyr/zephyr.elf \
+        --addr2line xtensa-esp32s3_zephyr-elf-addr2line
+"""
+
+import argparse
+import struct
+import subprocess
+import sys
+
+MAGIC = b"AMPF"
+HDR = struct.Struct("<4sHHIB3x")
+REC = struct.Struct("<QIIIIIB3x")
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(MAGIC):
+        return data
+
+    # Console capture: concatenate the hex payload of every AMPF: line
+    chunks = []
+    for line in data.decode(errors="replace").splitlines():
+        idx = line.find("AMPF:")
+        if idx >= 0:
+            chunks.append(bytes.fromhex(line[idx + 5:].strip()))
+    return b"".join(chunks)
+
+
+def parse(data):
+    if len(data) < HDR.size:
+        sys.exit("dump too short")
+    magic, version, count, elapsed_ms, ptr_size = HDR.unpack_from(data)
+    if magic != MAGIC or version != 1:
+        sys.exit("not an AkiraOS memprof dump (v1)")
+
+    sites = []
+    for i in range(count):
+        off = HDR.size + i * REC.size
+        if off + REC.size > len(data):
+            sys.exit("dump truncated at site %d of %d" % (i, count))
+        site, live, live_n, peak, allocs, alloc_bytes, tag = REC.unpack_from(data, off)
+        sites.append(dict(site=site, tag=tag, live=live, live_n=live_n,
+                          peak=peak, allocs=allocs, alloc_bytes=alloc_bytes))
+    return elapsed_ms, ptr_size, sites
+
+
+def resolve(addrs, elf, addr2line, bias):
+    if not elf or not addrs:
+        return {}
+    # Return addresses point after the call; look up the call itself
+    args = [addr2line, "-f", "-C", "-s", "-e", elf] + ["0x%x" % (a - bias - 1) for a in addrs]
+    try:
+        out = subprocess.run(args, capture_output=True, text=True, check=True).stdout.splitlines()
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("addr2line failed: %s" % e, file=sys.stderr)
+        return {}
+    return {a: "%s %s" % (out[2 * i], out[2 * i + 1]) for i, a in enumerate(addrs)}
+
+
+def tag_name(tag):
+    if tag == 0:
+        return "heap"
+    if tag == 1:
+        return "ext"
+    return "pool%d" % (tag - 2)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("dump", help="raw dump or console log")
+    ap.add_argument("--elf", help="zephyr.elf / zephyr.exe to resolve sites")
+    ap.add_argument("--addr2line", default="addr2line", help="addr2line for the target")
+    ap.add_argument("--bias", type=lambda x: int(x, 0), default=0,
+                    help="load address to subtract (PIE native_sim builds)")
+    ap.add_argument("-n", "--top", type=int, default=20, help="sites to show")
+    ap.add_argument("--sort", choices=["live", "peak", "rate"], default="live")
+    args = ap.parse_args()
+
+    elapsed_ms, ptr_size, sites = parse(load(args.dump))
+    sites = [s for s in sites if s["allocs"] or s["live"]]
+
+    key = {"live": lambda s: s["live"], "peak": lambda s: s["peak"],
+           "rate": lambda s: s["allocs"]}[args.sort]
+    sites.sort(key=key, reverse=True)
+    sites = sites[:args.top]
+
+    names = resolve([s["site"] for s in sites if s["site"]], args.elf, args.addr2line, args.bias)
+    total = sum(s["live"] for s in sites)
+    secs = max(elapsed_ms, 1) / 1000.0
+    width = 2 * ptr_size + 2
+
+    print("%d sites shown, %d live bytes, %.1f s of rate counters" % (len(sites), total, secs))
+    print("%-*s %-6s %9s %7s %9s %7s %9s  %s" % (width, "site", "tag", "live", "blocks",
+                                                  "peak", "pk/live", "alloc/s", "location"))
+    for s in sites:
+        ratio = "%.2f" % (s["peak"] / s["live"]) if s["live"] else "-"
+        where = names.get(s["site"], "<table overflow>" if s["site"] == 0 else "")
+        print("0x%0*x %-6s %9d %7d %9d %7s %9.1f  %s" % (
+            width - 2, s["site"], tag_name(s["tag"]), s["live"], s["live_n"], s["peak"],
+            ratio, s["allocs"] / secs, where))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""Decode AkiraOS binary event traces.
+
+Reads either a raw dump saved on native_sim with `akira trace dump <file>`
+or fetched from GET /api/trace, or a console log containing the
+`AETR:<hex>` lines printed by `akira trace dump` on hardware. Prints
+per-event-type queue latency (post to delivery) and handler time, and
+with --timeline every record in order.
+
+    tools/akira_trace.py trace.bin
+    curl -o trace.bin http://<device>/api/trace && tools/akira_trace.py trace.bin -t
+    tools/akira_trace.py console.log --type 300
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"AETR"
+HDR = struct.Struct("<4sHHII")
+REC = struct.Struct("<IBxHII")
+FLAG_WRAPPED = 1
+
+KINDS = {
+    1: "post", 2: "coalesce", 3: "drop", 4: "publish", 5: "deliver", 6: "done",
+    7: "msg-send", 8: "msg-dispatch", 9: "timer", 10: "app-state",
+}
+POST, COALESCE, DROP, PUBLISH, DELIVER, DONE, MSG_SEND, MSG_DISPATCH = range(1, 9)
+NO_POS = 0xFFFFFFFF
+
+# From src/akira/kernel/event.h
+EVENT_NAMES = {
+    1: "SYSTEM_READY", 2: "SYSTEM_SHUTDOWN", 3: "LOW_MEMORY", 4: "LOW_BATTERY",
+    100: "SERVICE_STARTED", 101: "SERVICE_STOPPED", 102: "SERVICE_ERROR",
+    200: "PROCESS_STARTED", 201: "PROCESS_STOPPED", 202: "PROCESS_CRASHED",
+    300: "BUTTON_PRESS", 301: "BUTTON_RELEASE", 302: "BUTTON_LONG_PRESS",
+    303: "TOUCH_DOWN", 304: "TOUCH_UP", 305: "TOUCH_MOVE",
+    400: "WIFI_CONNECTED", 401: "WIFI_DISCONNECTED", 402: "WIFI_SCAN_DONE",
+    403: "BLE_CONNECTED", 404: "BLE_DISCONNECTED", 405: "RF_MESSAGE",
+    500: "SD_INSERTED", 501: "SD_REMOVED", 502: "FILE_CHANGED",
+    600: "OTA_STARTED", 601: "OTA_PROGRESS", 602: "OTA_COMPLETE", 603: "OTA_FAILED",
+    700: "APP_INSTALLED", 701: "APP_UNINSTALLED", 702: "APP_STARTED",
+    703: "APP_STOPPED", 704: "WASM_LOADED",
+    800: "DISPLAY_ON", 801: "DISPLAY_OFF", 802: "DISPLAY_BRIGHTNESS",
+    900: "TIMER_EXPIRED",
+}
+
+
+def load(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data.startswith(MAGIC):
+        return data
+
+    # Console capture: concatenate the hex payload of every AETR: line
+    chunks = []
+    for line in data.decode(errors="replace").splitlines():
+        idx = line.find("AETR:")
+        if idx >= 0:
+            chunks.append(bytes.fromhex(line[idx + 5:].strip()))
+    return b"".join(chunks)
+
+
+def parse(data):
+    if len(data) < HDR.size:
+        sys.exit("dump too short")
+    magic, version, flags, hz, count = HDR.unpack_from(data)
+    if magic != MAGIC or version != 1:
+        sys.exit("not an AkiraOS event trace (v1)")
+
+    recs = []
+    wraps = 0
+    last = None
+    for i in range(count):
+        off = HDR.size + i * REC.size
+        if off + REC.size > len(data):
+            sys.exit("dump truncated at record %d of %d" % (i, count))
+        cycles, kind, etype, source, arg = REC.unpack_from(data, off)
+        # 32-bit cycle counter: unwrap on a large backwards step (small ones
+        # are writers interrupted between claiming a record and stamping it)
+        if last is not None and last - cycles > 1 << 31:
+            wraps += 1
+        last = cycles
+        recs.append(dict(t=((wraps << 32) + cycles) * 1e6 / max(hz, 1), kind=kind,
+                         type=etype, source=source, arg=arg))
+    return flags, hz, recs
+
+
+def event_name(etype):
+    if etype >= 1000:
+        return "CUSTOM+%d" % (etype - 1000)
+    return EVENT_NAMES.get(etype, str(etype))
+
+
+def stats(samples):
+    if not samples:
+        return "%8s %8s %8s %8s" % ("-", "-", "-", "-")
+    s = sorted(samples)
+    return "%8.1f %8.1f %8.1f %8.1f" % (s[0], sum(s) / len(s), s[len(s) // 2], s[-1])
+
+
+def latencies(recs):
+    posted = {}    # queue position -> post time
+    sent = {}      # msg id -> send time
+    stack = []     # open deliveries (publish can nest inside a handler)
+    queue = {}     # type -> [us]
+    handler = {}   # type -> [us]
+    msg = []
+    counts = {}
+
+    for r in recs:
+        k = r["kind"]
+        if k in (POST, COALESCE, DROP):
+            counts.setdefault(r["type"], [0, 0, 0])[k - POST] += 1
+        if k == POST:
+            posted[r["arg"]] = r["t"]
+        elif k == DELIVER:
+            if r["arg"] != NO_POS and r["arg"] in posted:
+                queue.setdefault(r["type"], []).append(r["t"] - posted.pop(r["arg"]))
+            stack.append(r)
+        elif k == DONE and stack:
+            start = stack.pop()
+            handler.setdefault(start["type"], []).append(r["t"] - start["t"])
+        elif k == MSG_SEND:
+            sent[r["arg"]] = r["t"]
+        elif k == MSG_DISPATCH and r["arg"] in sent:
+            msg.append(r["t"] - sent.pop(r["arg"]))
+    return queue, handler, msg, counts
+
+
+def describe(r):
+    k = r["kind"]
+    if k in (POST, DELIVER):
+        pos = "-" if r["arg"] == NO_POS else str(r["arg"])
+        return "%-20s src %-6u pos %s" % (event_name(r["type"]), r["source"], pos)
+    if k == DONE:
+        return "%-20s src %-6u %u handler(s)" % (event_name(r["type"]), r["source"], r["arg"])
+    if k in (COALESCE, DROP, PUBLISH):
+        return "%-20s src %u" % (event_name(r["type"]), r["source"])
+    if k in (MSG_SEND, MSG_DISPATCH):
+        return "msg %-8u prio %u sender %u" % (r["arg"], r["type"], r["source"])
+    if k == 9:
+        return "timer %u fired %u time(s)" % (r["source"], r["arg"])
+    if k == 10:
+        return "app %u state %u -> %u" % (r["source"], r["arg"], r["type"])
+    return "type %u src %u arg %u" % (r["type"], r["source"], r["arg"])
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("dump", help="raw dump or console log")
+    ap.add_argument("-t", "--timeline", action="store_true", help="print every record")
+    ap.add_argument("--type", type=lambda x: int(x, 0), help="only this event type")
+    args = ap.parse_args()
+
+    flags, hz, recs = parse(load(args.dump))
+    if not recs:
+        print("no records")
+        return
+
+    t0 = recs[0]["t"]
+    span = recs[-1]["t"] - t0
+    print("%d records over %.3f ms at %d Hz%s" % (
+        len(recs), span / 1000.0, hz, " (ring wrapped, oldest records lost)"
+        if flags & FLAG_WRAPPED else ""))
+
+    queue, handler, msg, counts = latencies(recs)
+    types = sorted(set(queue) | set(handler) | set(counts))
+    if args.type is not None:
+        types = [t for t in types if t == args.type]
+
+    print()
+    print("%-20s %6s %6s %5s  %-35s  %-35s" % ("event", "posted", "merged", "drop",
+                                             "queue us (min avg p50 max)",
+                                             "handler us (min avg p50 max)"))
+    for t in types:
+        c = counts.get(t, [0, 0, 0])
+        print("%-20s %6d %6d %5d  %-35s  %-35s" % (event_name(t), c[0], c[1], c[2],
+                                                  stats(queue.get(t, [])),
+                                                  stats(handler.get(t, []))))
+    if msg:
+        print()
+        print("message bus send->dispatch us (min avg p50 max): %s (%d messages)" % (
+            stats(msg), len(msg)))
+
+    if args.timeline:
+        print()
+        print("%12s %12s  %-12s %s" % ("time us", "delta us", "kind", "detail"))
+        prev = t0
+        for r in recs:
+            if args.type is not None and r["kind"] <= DONE and r["type"] != args.type:
+                continue
+            print("%12.1f %12.1f  %-12s %s" % (r["t"] - t0, r["t"] - prev,
+                                               KINDS.get(r["kind"], "?%d" % r["kind"]),
+                                               describe(r)))
+            prev = r["t"]
+
+
+if __name__ == "__main__":
+    main()